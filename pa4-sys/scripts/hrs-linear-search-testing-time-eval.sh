@@ -5,5 +5,5 @@ rm -f hrs-linear-search-testing-time-eval.txt
 # Run the evaluation
 
 for i in {6000,7000,8000,9000,10000}; do
-  ./hrs-linear-search-eval 60000 10000 | tee -a hrs-linear-search-testing-time-eval.txt;
+  ./hrs-linear-search-eval 60000 $i | tee -a hrs-linear-search-testing-time-eval.txt;
 done
\ No newline at end of file
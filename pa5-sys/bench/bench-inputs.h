@@ -0,0 +1,71 @@
+//========================================================================
+// bench-inputs.h
+//========================================================================
+// Deterministic inputs shared by the microbenchmarks. The MNIST data set
+// is not needed, so the benchmarks run anywhere.
+
+#ifndef BENCH_INPUTS_H
+#define BENCH_INPUTS_H
+
+#include "Distance.h"
+#include "Image.h"
+#include "Vector.h"
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// random_image
+//------------------------------------------------------------------------
+// A 28x28 image where roughly one pixel in five is lit, which is about
+// as sparse as an MNIST digit.
+
+inline Image random_image()
+{
+  const int size = 28 * 28;
+  int       pixels[size];
+  for ( int i = 0; i < size; i++ )
+    pixels[i] = ( std::rand() % 5 == 0 ) ? std::rand() % 256 : 0;
+
+  Image img( Vector<int>( pixels, size ), 28, 28 );
+  img.set_label( (char) ( '0' + std::rand() % 10 ) );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// random_images / random_ints
+//------------------------------------------------------------------------
+
+inline Vector<Image> random_images( int size )
+{
+  std::srand( 0x2400 );
+  Vector<Image> vec;
+  vec.reserve( size );
+  for ( int i = 0; i < size; i++ )
+    vec.push_back( random_image() );
+  return vec;
+}
+
+inline Vector<int> random_ints( int size )
+{
+  std::srand( 0x2400 );
+  Vector<int> vec;
+  vec.reserve( size );
+  for ( int i = 0; i < size; i++ )
+    vec.push_back( std::rand() );
+  return vec;
+}
+
+//------------------------------------------------------------------------
+// Comparison functions
+//------------------------------------------------------------------------
+
+inline bool less_int( int a, int b )
+{
+  return a < b;
+}
+
+inline bool less_intensity( const Image& a, const Image& b )
+{
+  return a.get_intensity() < b.get_intensity();
+}
+
+#endif  // BENCH_INPUTS_H
@@ -0,0 +1,387 @@
+//========================================================================
+// bench.cc
+//========================================================================
+// Implementation of the microbenchmark harness.
+
+#include "bench.h"
+#include "ece2400-stdlib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace bench {
+
+//------------------------------------------------------------------------
+// State
+//------------------------------------------------------------------------
+// Samples are timed with ece2400::timer_now_ns, a monotonic clock, so
+// they are not disturbed by the wall clock being adjusted while a
+// benchmark runs.
+
+State::State( long long iterations, int arg )
+{
+  m_iterations = iterations;
+  m_remaining  = iterations;
+  m_arg        = arg;
+  m_items      = 0;
+  m_start_ns   = 0;
+  m_elapsed_ns = 0;
+  m_started    = false;
+}
+
+// The clock starts on the first call and stops on the last one, so any
+// setup before the loop is not measured.
+bool State::keep_running()
+{
+  if ( !m_started ) {
+    m_started  = true;
+    m_start_ns = ece2400::timer_now_ns();
+  }
+  if ( m_remaining > 0 ) {
+    m_remaining--;
+    return true;
+  }
+  m_elapsed_ns += ece2400::timer_now_ns() - m_start_ns;
+  return false;
+}
+
+void State::pause()
+{
+  m_elapsed_ns += ece2400::timer_now_ns() - m_start_ns;
+}
+
+void State::resume()
+{
+  m_start_ns = ece2400::timer_now_ns();
+}
+
+int State::arg() const
+{
+  return m_arg;
+}
+
+long long State::iterations() const
+{
+  return m_iterations;
+}
+
+void State::set_items( long long items_per_iteration )
+{
+  m_items = items_per_iteration;
+}
+
+long long State::items() const
+{
+  return m_items;
+}
+
+double State::elapsed_ns() const
+{
+  return (double) m_elapsed_ns;
+}
+
+//------------------------------------------------------------------------
+// Registry
+//------------------------------------------------------------------------
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+// Fewest samples whose p99 is not simply the slowest one
+const int min_p99_repeats = 100;
+
+struct Benchmark {
+  std::string name;
+  BenchFunc   func;
+  int         arg;
+};
+
+struct Result {
+  std::string name;
+  int         arg;
+  long long   iterations;
+  int         repeats;
+  double      median_ns;
+  double      p99_ns;  // NaN with fewer than min_p99_repeats samples
+  double      max_ns;
+  double      min_ns;
+  double      mean_ns;
+  double      items_per_sec;
+};
+
+static std::vector<Benchmark>& registry()
+{
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+void add( const std::string& name, BenchFunc func,
+          const std::vector<int>& args )
+{
+  for ( size_t i = 0; i < args.size(); i++ ) {
+    Benchmark b;
+    b.name = name;
+    b.func = func;
+    b.arg  = args[i];
+    registry().push_back( b );
+  }
+}
+
+//------------------------------------------------------------------------
+// run_sample
+//------------------------------------------------------------------------
+// Runs the benchmark for the given number of iterations and returns the
+// measured time in nanoseconds.
+
+static double run_sample( const Benchmark& b, long long iterations,
+                          long long* items )
+{
+  State state( iterations, b.arg );
+  b.func( state );
+  if ( items != nullptr )
+    *items = state.items();
+  return state.elapsed_ns();
+}
+
+//------------------------------------------------------------------------
+// calibrate
+//------------------------------------------------------------------------
+// Grows the iteration count geometrically until one sample lasts at
+// least min_ns. Short benchmarks such as a single distance would
+// otherwise be dominated by the resolution of the clock.
+
+static long long calibrate( const Benchmark& b, double min_ns )
+{
+  const long long max_iterations = 1000000000LL;
+
+  long long iterations = 1;
+  while ( iterations < max_iterations ) {
+    double elapsed = run_sample( b, iterations, nullptr );
+    if ( elapsed >= min_ns )
+      break;
+    double scale = ( elapsed > 0.0 ) ? 1.4 * min_ns / elapsed : 10.0;
+    scale        = std::min( 10.0, std::max( 2.0, scale ) );
+    iterations   = (long long) std::ceil( (double) iterations * scale );
+  }
+  return std::min( iterations, max_iterations );
+}
+
+//------------------------------------------------------------------------
+// percentile
+//------------------------------------------------------------------------
+// Nearest-rank percentile of sorted samples
+
+static double percentile( const std::vector<double>& sorted, double p )
+{
+  int rank = (int) std::ceil( p / 100.0 * (double) sorted.size() );
+  rank     = std::max( 1, std::min( rank, (int) sorted.size() ) );
+  return sorted[(size_t) ( rank - 1 )];
+}
+
+//------------------------------------------------------------------------
+// measure
+//------------------------------------------------------------------------
+
+static Result measure( const Benchmark& b, int repeats, int warmup,
+                       double min_ns )
+{
+  long long iterations = calibrate( b, min_ns );
+
+  for ( int i = 0; i < warmup; i++ )
+    run_sample( b, iterations, nullptr );
+
+  std::vector<double> samples;
+  long long           items = 0;
+  for ( int i = 0; i < repeats; i++ ) {
+    double elapsed = run_sample( b, iterations, &items );
+    samples.push_back( elapsed / (double) iterations );
+  }
+  std::sort( samples.begin(), samples.end() );
+
+  double sum = 0.0;
+  for ( size_t i = 0; i < samples.size(); i++ )
+    sum += samples[i];
+
+  Result r;
+  r.name          = b.name;
+  r.arg           = b.arg;
+  r.iterations    = iterations;
+  r.repeats       = repeats;
+  r.median_ns     = percentile( samples, 50.0 );
+  r.p99_ns        = ( repeats >= min_p99_repeats )
+                        ? percentile( samples, 99.0 )
+                        : std::numeric_limits<double>::quiet_NaN();
+  r.min_ns        = samples[0];
+  r.max_ns        = samples.back();
+  r.mean_ns       = sum / (double) samples.size();
+  r.items_per_sec = ( items > 0 && r.median_ns > 0.0 )
+                        ? (double) items * 1e9 / r.median_ns
+                        : 0.0;
+  return r;
+}
+
+//------------------------------------------------------------------------
+// write_json
+//------------------------------------------------------------------------
+
+static bool write_json( const std::string& path,
+                        const std::vector<Result>& results, int repeats,
+                        int warmup, double min_ns )
+{
+  std::ofstream out( path.c_str() );
+  if ( !out )
+    return false;
+
+#ifdef EVAL
+  const char* optimized = "true";
+#else
+  const char* optimized = "false";
+#endif
+
+  out << std::setprecision( 10 );
+  out << "{\n";
+  out << "  \"context\": {\n";
+  out << "    \"date\": " << (long long) std::time( nullptr ) << ",\n";
+  out << "    \"optimized\": " << optimized << ",\n";
+  out << "    \"repeats\": " << repeats << ",\n";
+  out << "    \"warmup\": " << warmup << ",\n";
+  out << "    \"min_time_ns\": " << min_ns << "\n";
+  out << "  },\n";
+  out << "  \"benchmarks\": [";
+  for ( size_t i = 0; i < results.size(); i++ ) {
+    const Result& r = results[i];
+    out << ( i == 0 ? "\n" : ",\n" );
+    out << "    {\"name\": \"" << r.name << "/" << r.arg << "\", "
+        << "\"arg\": " << r.arg << ", "
+        << "\"iterations\": " << r.iterations << ", "
+        << "\"repeats\": " << r.repeats << ", "
+        << "\"median_ns\": " << r.median_ns << ", "
+        << "\"p99_ns\": ";
+    if ( std::isnan( r.p99_ns ) )
+      out << "null";
+    else
+      out << r.p99_ns;
+    out << ", "
+        << "\"min_ns\": " << r.min_ns << ", "
+        << "\"max_ns\": " << r.max_ns << ", "
+        << "\"mean_ns\": " << r.mean_ns << ", "
+        << "\"items_per_second\": " << r.items_per_sec << "}";
+  }
+  out << "\n  ]\n";
+  out << "}\n";
+  return true;
+}
+
+//------------------------------------------------------------------------
+// parse_option
+//------------------------------------------------------------------------
+// Returns the value of an option of the form --<name>=<value>, or null
+// if the argument is a different option.
+
+static const char* parse_option( const char* arg, const char* name )
+{
+  size_t len = std::strlen( name );
+  if ( std::strncmp( arg, name, len ) == 0 && arg[len] == '=' )
+    return arg + len + 1;
+  return nullptr;
+}
+
+//------------------------------------------------------------------------
+// run
+//------------------------------------------------------------------------
+
+int run( int argc, char** argv )
+{
+  std::string filter;
+  std::string json_path;
+  int         repeats = 20;
+  int         warmup  = 3;
+  double      min_ms  = 5.0;
+
+  for ( int i = 1; i < argc; i++ ) {
+    const char* value;
+    if ( ( value = parse_option( argv[i], "--filter" ) ) != nullptr )
+      filter = value;
+    else if ( ( value = parse_option( argv[i], "--repeats" ) ) != nullptr )
+      repeats = std::atoi( value );
+    else if ( ( value = parse_option( argv[i], "--warmup" ) ) != nullptr )
+      warmup = std::atoi( value );
+    else if ( ( value = parse_option( argv[i], "--min-time-ms" ) ) != nullptr )
+      min_ms = std::atof( value );
+    else if ( ( value = parse_option( argv[i], "--json" ) ) != nullptr )
+      json_path = value;
+    else {
+      std::cerr << "unknown option: " << argv[i] << std::endl
+                << "usage: " << argv[0] << " [--filter=<str>] "
+                << "[--repeats=<n>] [--warmup=<n>] [--min-time-ms=<n>] "
+                << "[--json=<path>]" << std::endl;
+      return 1;
+    }
+  }
+
+  if ( repeats < 1 || warmup < 0 || min_ms < 0.0 ) {
+    std::cerr << "repeats must be positive and warmup and min-time-ms "
+              << "must not be negative" << std::endl;
+    return 1;
+  }
+
+#ifndef EVAL
+  std::cerr << "warning: benchmarks were built without optimizations, "
+            << "configure with -DCMAKE_BUILD_TYPE=eval" << std::endl;
+#endif
+
+  double              min_ns = min_ms * 1e6;
+  std::vector<Result> results;
+
+  std::cout << std::left << std::setw( 36 ) << "benchmark" << std::right
+            << std::setw( 14 ) << "median ns" << std::setw( 14 )
+            << "p99 ns" << std::setw( 14 ) << "max ns" << std::setw( 14 )
+            << "iterations"
+            << std::setw( 16 ) << "items/s" << std::endl;
+
+  const std::vector<Benchmark>& benchmarks = registry();
+  for ( size_t i = 0; i < benchmarks.size(); i++ ) {
+    std::ostringstream name;
+    name << benchmarks[i].name << "/" << benchmarks[i].arg;
+    if ( name.str().find( filter ) == std::string::npos )
+      continue;
+
+    Result r = measure( benchmarks[i], repeats, warmup, min_ns );
+    results.push_back( r );
+
+    std::ostringstream p99;
+    if ( std::isnan( r.p99_ns ) )
+      p99 << "-";
+    else
+      p99 << std::fixed << std::setprecision( 1 ) << r.p99_ns;
+
+    std::cout << std::left << std::setw( 36 ) << name.str() << std::right
+              << std::fixed << std::setprecision( 1 ) << std::setw( 14 )
+              << r.median_ns << std::setw( 14 ) << p99.str()
+              << std::setw( 14 ) << r.max_ns
+              << std::setw( 14 ) << r.iterations << std::scientific
+              << std::setprecision( 3 ) << std::setw( 16 )
+              << r.items_per_sec << std::endl;
+    std::cout.unsetf( std::ios::floatfield );
+  }
+
+  if ( !json_path.empty() &&
+       !write_json( json_path, results, repeats, warmup, min_ns ) ) {
+    std::cerr << "could not write " << json_path << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+}  // namespace bench
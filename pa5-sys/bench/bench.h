@@ -0,0 +1,105 @@
+//========================================================================
+// bench.h
+//========================================================================
+// A small microbenchmark harness.
+//
+// A benchmark is a function that does its setup, then repeats the code
+// under test for as long as State::keep_running() returns true:
+//
+//   void bench_foo( bench::State& state )
+//   {
+//     Vector<int> vec = make_input( state.arg() );
+//     while ( state.keep_running() )
+//       bench::do_not_optimize( foo( vec ) );
+//     state.set_items( state.arg() );
+//   }
+//
+// Only the time spent inside the loop is measured. The harness first
+// picks an iteration count that makes one sample last at least the
+// minimum sample time, runs a few warmup samples that are thrown away,
+// and then reports the median, the p99 and the maximum of the time per
+// iteration over the remaining samples. With fewer than 100 samples the
+// p99 would just be the maximum, so it is only reported from 100
+// samples on (e.g., --repeats=100) and shown as "-" otherwise. Results
+// can also be written as JSON so that runs can be compared over time.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <vector>
+
+namespace bench {
+
+//------------------------------------------------------------------------
+// State
+//------------------------------------------------------------------------
+// Handed to a benchmark function for one sample. pause() and resume()
+// exclude per-iteration setup (e.g., copying an unsorted input before
+// sorting it) from the measurement.
+
+class State {
+ public:
+  State( long long iterations, int arg );
+
+  bool      keep_running();
+  void      pause();
+  void      resume();
+  int       arg() const;
+  long long iterations() const;
+  void      set_items( long long items_per_iteration );
+
+  long long items() const;
+  double    elapsed_ns() const;
+
+ private:
+  long long m_iterations;
+  long long m_remaining;
+  int       m_arg;
+  long long m_items;
+  long long m_start_ns;
+  long long m_elapsed_ns;
+  bool      m_started;
+};
+
+//------------------------------------------------------------------------
+// do_not_optimize
+//------------------------------------------------------------------------
+// Keeps the compiler from optimizing away a computation whose result is
+// otherwise unused.
+
+template <typename T>
+inline void do_not_optimize( const T& value )
+{
+  asm volatile( "" : : "g"( &value ) : "memory" );
+}
+
+//------------------------------------------------------------------------
+// add
+//------------------------------------------------------------------------
+// Registers a benchmark once for every given argument. The argument is
+// usually the input size and is available through State::arg().
+
+typedef void ( *BenchFunc )( State& state );
+
+void add( const std::string& name, BenchFunc func,
+          const std::vector<int>& args );
+
+//------------------------------------------------------------------------
+// run
+//------------------------------------------------------------------------
+// Runs all registered benchmarks and returns the exit status for main.
+// Recognizes the command line options
+//
+//   --filter=<str>      only run benchmarks whose name contains <str>
+//   --repeats=<n>       number of measured samples (default 20, at
+//                       least 100 for a p99)
+//   --warmup=<n>        number of discarded samples (default 3)
+//   --min-time-ms=<n>   minimum length of one sample (default 5)
+//   --json=<path>       also write the results to <path> as JSON
+
+int run( int argc, char** argv );
+
+}  // namespace bench
+
+#endif  // BENCH_H
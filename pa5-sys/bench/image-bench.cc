@@ -0,0 +1,103 @@
+//========================================================================
+// image-bench.cc
+//========================================================================
+// Microbenchmarks for Image.
+
+#include "bench-inputs.h"
+#include "bench.h"
+
+//------------------------------------------------------------------------
+// bench_image_distance
+//------------------------------------------------------------------------
+// Distance from one image to each of arg others. Every classifier spends
+// most of its time here.
+
+void bench_image_distance( bench::State& state )
+{
+  Vector<Image> vec   = random_images( state.arg() + 1 );
+  Image         query = vec[state.arg()];
+
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ )
+      bench::do_not_optimize( query.distance( vec[i] ) );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_image_distance_sparse
+//------------------------------------------------------------------------
+// The same distances with the sparse kernel. The inputs are about as
+// sparse as MNIST digits, so comparing this with image_distance shows
+// which kernel choose_distance_kernel should pick for MNIST.
+
+void bench_image_distance_sparse( bench::State& state )
+{
+  Vector<Image> vec   = random_images( state.arg() + 1 );
+  Image         query = vec[state.arg()];
+
+  Image::set_distance_kernel( Image::SPARSE );
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ )
+      bench::do_not_optimize( query.distance( vec[i] ) );
+  }
+  Image::set_distance_kernel( Image::DENSE );
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_metric
+//------------------------------------------------------------------------
+// A linear search over arg images with each of the metrics in
+// Distance.h, which shows what a metric costs per distance once it is
+// compiled into a search.
+
+template <typename DistFunc>
+void bench_metric( bench::State& state )
+{
+  Vector<Image> vec   = random_images( state.arg() );
+  Image         query = random_image();
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( vec.find_closest_linear( query, DistFunc() ) );
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_image_copy
+//------------------------------------------------------------------------
+// Copying images is what every Vector<Image> and Tree<Image> operation
+// that moves values around pays for.
+
+void bench_image_copy( bench::State& state )
+{
+  Vector<Image> vec = random_images( state.arg() );
+  Image         img;
+
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ ) {
+      img = vec[i];
+      bench::do_not_optimize( img );
+    }
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  bench::add( "image_distance", bench_image_distance, { 1, 64, 1024 } );
+  bench::add( "image_distance_sparse", bench_image_distance_sparse,
+              { 1, 64, 1024 } );
+  bench::add( "metric_l2", bench_metric<L2Distance>, { 1024 } );
+  bench::add( "metric_cascade", bench_metric<CascadeDistance>, { 1024 } );
+  bench::add( "metric_l1", bench_metric<L1Distance>, { 1024 } );
+  bench::add( "metric_chebyshev", bench_metric<ChebyshevDistance>, { 1024 } );
+  bench::add( "metric_cosine", bench_metric<CosineDistance>, { 1024 } );
+  bench::add( "metric_tangent", bench_metric<TangentDistance>, { 1024 } );
+  bench::add( "image_copy", bench_image_copy, { 1, 64, 1024 } );
+  return bench::run( argc, argv );
+}
@@ -0,0 +1,149 @@
+//========================================================================
+// numa-bench.cc
+//========================================================================
+// Memory bandwidth of threads that scan their own slice of a buffer,
+// depending on where the slices are placed.
+//
+// Every benchmark starts arg threads, placed on CPUs as numa_worker_cpus
+// places the workers of HRSAlternative, and each of them sums its own
+// slice_bytes slice; items are bytes, so items/s is the bandwidth of all
+// threads together. The slices are
+//
+// - local:    allocated and first touched by their pinned thread, so
+//             they are on the node that reads them,
+// - remote:   allocated and first touched by the main thread, so they
+//             are all on its node, and
+// - unpinned: like remote, and read by threads that are not pinned.
+//
+// On a machine with several nodes, local should scale with the number of
+// nodes its threads are spread over, while the others stay limited by
+// the memory of one node. Thread start-up is included, but is small
+// next to scanning a slice.
+
+#include "Numa.h"
+#include "bench.h"
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const size_t slice_bytes = 16 << 20;
+const size_t slice_words = slice_bytes / sizeof( unsigned long long );
+
+typedef std::vector<unsigned long long> Slice;
+
+//------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------
+
+void fill_slice( int cpu, Slice** slice )
+{
+  pin_thread( cpu );
+  *slice = new Slice( slice_words, (unsigned long long) cpu );
+}
+
+void sum_slice( int cpu, const Slice* slice, unsigned long long* sum )
+{
+  if ( cpu >= 0 )
+    pin_thread( cpu );
+  unsigned long long total = 0;
+  for ( size_t i = 0; i < slice->size(); i++ )
+    total += ( *slice )[i];
+  *sum = total;
+}
+
+// Runs one thread per slice until the state stops, pinning thread k to
+// cpus[k] unless pin is false
+
+void scan_slices( bench::State& state, const std::vector<int>& cpus,
+                  const std::vector<Slice*>& slices, bool pin )
+{
+  std::vector<unsigned long long> sums( slices.size() );
+  while ( state.keep_running() ) {
+    std::vector<std::thread> threads;
+    for ( size_t k = 0; k < slices.size(); k++ )
+      threads.push_back( std::thread( sum_slice, pin ? cpus[k] : -1,
+                                      slices[k], &sums[k] ) );
+    for ( size_t k = 0; k < threads.size(); k++ )
+      threads[k].join();
+    bench::do_not_optimize( sums );
+  }
+  state.set_items( (long long) ( slices.size() * slice_bytes ) );
+
+  for ( size_t k = 0; k < slices.size(); k++ )
+    delete slices[k];
+}
+
+//------------------------------------------------------------------------
+// bench_scan_local / bench_scan_remote / bench_scan_unpinned
+//------------------------------------------------------------------------
+
+void bench_scan_local( bench::State& state )
+{
+  std::vector<int>    cpus = numa_worker_cpus( state.arg() );
+  std::vector<Slice*> slices( cpus.size() );
+
+  std::vector<std::thread> threads;
+  for ( size_t k = 0; k < cpus.size(); k++ )
+    threads.push_back( std::thread( fill_slice, cpus[k], &slices[k] ) );
+  for ( size_t k = 0; k < threads.size(); k++ )
+    threads[k].join();
+
+  scan_slices( state, cpus, slices, true );
+}
+
+void bench_scan_remote( bench::State& state )
+{
+  std::vector<int>    cpus = numa_worker_cpus( state.arg() );
+  std::vector<Slice*> slices( cpus.size() );
+
+  // Fill every slice from the first worker's CPU
+  std::thread filler( [&]() {
+    for ( size_t k = 0; k < cpus.size(); k++ )
+      fill_slice( cpus[0], &slices[k] );
+  } );
+  filler.join();
+
+  scan_slices( state, cpus, slices, true );
+}
+
+void bench_scan_unpinned( bench::State& state )
+{
+  std::vector<int>    cpus = numa_worker_cpus( state.arg() );
+  std::vector<Slice*> slices( cpus.size() );
+  for ( size_t k = 0; k < cpus.size(); k++ )
+    slices[k] = new Slice( slice_words, (unsigned long long) k );
+
+  scan_slices( state, cpus, slices, false );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+// Runs 1, 2, 4, ... threads up to one per usable CPU.
+
+int main( int argc, char** argv )
+{
+  std::vector<std::vector<int>> nodes = numa_node_cpus();
+
+  int ncpus = 0;
+  for ( size_t i = 0; i < nodes.size(); i++ ) {
+    std::cout << "node " << i << ": " << nodes[i].size() << " cpus"
+              << std::endl;
+    ncpus += (int) nodes[i].size();
+  }
+
+  std::vector<int> args;
+  for ( int n = 1; n < ncpus; n *= 2 )
+    args.push_back( n );
+  args.push_back( ncpus > 0 ? ncpus : 1 );
+
+  bench::add( "scan_local", bench_scan_local, args );
+  bench::add( "scan_remote", bench_scan_remote, args );
+  bench::add( "scan_unpinned", bench_scan_unpinned, args );
+  return bench::run( argc, argv );
+}
@@ -0,0 +1,73 @@
+//========================================================================
+// preprocess-bench.cc
+//========================================================================
+// Throughput of ImagePreprocessor, which every training image and every
+// query goes through when a system is wrapped in HRSPreprocessed.
+
+#include "ImagePreprocessor.h"
+#include "bench-inputs.h"
+#include "bench.h"
+
+//------------------------------------------------------------------------
+// bench_preprocess
+//------------------------------------------------------------------------
+// Preprocesses arg images one at a time, as queries are.
+
+void bench_preprocess( bench::State& state )
+{
+  Vector<Image>     vec = random_images( state.arg() );
+  ImagePreprocessor pre;
+
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ )
+      bench::do_not_optimize( pre.apply( vec[i] ) );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_preprocess_batch
+//------------------------------------------------------------------------
+// Preprocesses arg images with one call, as training sets are, which
+// reuses the buffers between images.
+
+void bench_preprocess_batch( bench::State& state )
+{
+  Vector<Image>     vec = random_images( state.arg() );
+  ImagePreprocessor pre;
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( pre.apply( vec ) );
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_preprocess_stages
+//------------------------------------------------------------------------
+// One stage at a time over a batch: arg 0 crops, 1 centers and 2 centers
+// and deskews.
+
+void bench_preprocess_stages( bench::State& state )
+{
+  Vector<Image>     vec = random_images( 1024 );
+  ImagePreprocessor pre;
+  pre.set_crop( state.arg() == 0 ? 20 : 0 );
+  pre.set_center( state.arg() > 0 );
+  pre.set_deskew( state.arg() == 2 );
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( pre.apply( vec ) );
+  state.set_items( vec.size() );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  bench::add( "preprocess", bench_preprocess, { 1, 64, 1024 } );
+  bench::add( "preprocess_batch", bench_preprocess_batch, { 64, 1024 } );
+  bench::add( "preprocess_stages", bench_preprocess_stages, { 0, 1, 2 } );
+  return bench::run( argc, argv );
+}
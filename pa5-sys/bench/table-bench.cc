@@ -0,0 +1,93 @@
+//========================================================================
+// table-bench.cc
+//========================================================================
+// Microbenchmarks for Table. Table is still an assignment stub, so this
+// file is commented out of BENCH_FILES until it is implemented.
+
+#include "Table.h"
+#include "bench-inputs.h"
+#include "bench.h"
+
+typedef Table<int, int ( * )( int )>              IntTable;
+typedef Table<Image, int ( * )( const Image& )> ImageTable;
+
+//------------------------------------------------------------------------
+// Hash functions
+//------------------------------------------------------------------------
+
+int hash_int( int a )
+{
+  return a;
+}
+
+int hash_intensity( const Image& img )
+{
+  return img.get_intensity();
+}
+
+//------------------------------------------------------------------------
+// bench_table_add
+//------------------------------------------------------------------------
+
+void bench_table_add( bench::State& state )
+{
+  Vector<int> keys = random_ints( state.arg() );
+
+  while ( state.keep_running() ) {
+    IntTable table( 15, hash_int );
+    for ( int i = 0; i < state.arg(); i++ )
+      table.add( keys[i] );
+    bench::do_not_optimize( table );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_table_contains
+//------------------------------------------------------------------------
+
+void bench_table_contains( bench::State& state )
+{
+  Vector<int> keys = random_ints( state.arg() );
+  IntTable    table( 15, hash_int );
+  for ( int i = 0; i < state.arg(); i++ )
+    table.add( keys[i] );
+
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ )
+      bench::do_not_optimize( table.contains( keys[i] ) );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_table_find_closest
+//------------------------------------------------------------------------
+// One nearest neighbor query against arg training images, which is the
+// cost of classifying a single image with HRSTableSearch (K = 15).
+
+void bench_table_find_closest( bench::State& state )
+{
+  Vector<Image> images = random_images( state.arg() );
+  ImageTable    table( 15, hash_intensity );
+  for ( int i = 0; i < state.arg(); i++ )
+    table.add( images[i] );
+  Image query = random_image();
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( table.find_closest( query, L2Distance() ) );
+  state.set_items( 1 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  bench::add( "table_add", bench_table_add, { 16, 1024, 65536 } );
+  bench::add( "table_contains", bench_table_contains, { 16, 1024, 65536 } );
+  bench::add( "table_find_closest", bench_table_find_closest,
+              { 100, 1000, 10000 } );
+  return bench::run( argc, argv );
+}
@@ -0,0 +1,79 @@
+//========================================================================
+// tree-bench.cc
+//========================================================================
+// Microbenchmarks for Tree.
+
+#include "Tree.h"
+#include "bench-inputs.h"
+#include "bench.h"
+
+typedef Tree<int, bool ( * )( int, int )>                        IntTree;
+typedef Tree<Image, bool ( * )( const Image&, const Image& )> ImageTree;
+
+//------------------------------------------------------------------------
+// bench_tree_add
+//------------------------------------------------------------------------
+// Builds a tree from arg random keys, including every rebalance.
+
+void bench_tree_add( bench::State& state )
+{
+  Vector<int> keys = random_ints( state.arg() );
+
+  while ( state.keep_running() ) {
+    IntTree tree( 15, less_int );
+    for ( int i = 0; i < state.arg(); i++ )
+      tree.add( keys[i] );
+    bench::do_not_optimize( tree );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_tree_contains
+//------------------------------------------------------------------------
+
+void bench_tree_contains( bench::State& state )
+{
+  Vector<int> keys = random_ints( state.arg() );
+  IntTree     tree( 15, less_int );
+  for ( int i = 0; i < state.arg(); i++ )
+    tree.add( keys[i] );
+
+  while ( state.keep_running() ) {
+    for ( int i = 0; i < state.arg(); i++ )
+      bench::do_not_optimize( tree.contains( keys[i] ) );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_tree_find_closest
+//------------------------------------------------------------------------
+// One nearest neighbor query against arg training images, which is the
+// cost of classifying a single image with HRSTreeSearch (K = 15).
+
+void bench_tree_find_closest( bench::State& state )
+{
+  Vector<Image> images = random_images( state.arg() );
+  ImageTree     tree( 15, less_intensity );
+  for ( int i = 0; i < state.arg(); i++ )
+    tree.add( images[i] );
+  Image query = random_image();
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( tree.find_closest( query, L2Distance() ) );
+  state.set_items( 1 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  bench::add( "tree_add", bench_tree_add, { 16, 1024, 65536 } );
+  bench::add( "tree_contains", bench_tree_contains, { 16, 1024, 65536 } );
+  bench::add( "tree_find_closest", bench_tree_find_closest,
+              { 100, 1000, 10000 } );
+  return bench::run( argc, argv );
+}
@@ -0,0 +1,118 @@
+//========================================================================
+// vector-bench.cc
+//========================================================================
+// Microbenchmarks for Vector and sort.
+
+#include "bench-inputs.h"
+#include "bench.h"
+#include "sort.h"
+
+//------------------------------------------------------------------------
+// bench_push_back_int / bench_push_back_image
+//------------------------------------------------------------------------
+// Fills an empty vector with arg values, including every reallocation
+// along the way.
+
+void bench_push_back_int( bench::State& state )
+{
+  while ( state.keep_running() ) {
+    Vector<int> vec;
+    for ( int i = 0; i < state.arg(); i++ )
+      vec.push_back( i );
+    bench::do_not_optimize( vec );
+  }
+  state.set_items( state.arg() );
+}
+
+void bench_push_back_image( bench::State& state )
+{
+  Vector<Image> images = random_images( state.arg() );
+
+  while ( state.keep_running() ) {
+    Vector<Image> vec;
+    for ( int i = 0; i < state.arg(); i++ )
+      vec.push_back( images[i] );
+    bench::do_not_optimize( vec );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_sort_int / bench_sort_image
+//------------------------------------------------------------------------
+// Sorts a fresh copy of the same random input on every iteration. The
+// copy itself is not measured.
+
+void bench_sort_int( bench::State& state )
+{
+  Vector<int> input = random_ints( state.arg() );
+
+  while ( state.keep_running() ) {
+    state.pause();
+    Vector<int> vec = input;
+    state.resume();
+    vec.sort( less_int );
+    bench::do_not_optimize( vec );
+  }
+  state.set_items( state.arg() );
+}
+
+void bench_sort_image( bench::State& state )
+{
+  Vector<Image> input = random_images( state.arg() );
+
+  while ( state.keep_running() ) {
+    state.pause();
+    Vector<Image> vec = input;
+    state.resume();
+    vec.sort( less_intensity );
+    bench::do_not_optimize( vec );
+  }
+  state.set_items( state.arg() );
+}
+
+//------------------------------------------------------------------------
+// bench_find_closest_linear / bench_find_closest_binary
+//------------------------------------------------------------------------
+// One nearest neighbor query against arg training images, which is the
+// cost of classifying a single image with HRSLinearSearch and
+// HRSBinarySearch (K = 15).
+
+void bench_find_closest_linear( bench::State& state )
+{
+  Vector<Image> vec   = random_images( state.arg() );
+  Image         query = random_image();
+
+  while ( state.keep_running() )
+    bench::do_not_optimize( vec.find_closest_linear( query, L2Distance() ) );
+  state.set_items( 1 );
+}
+
+void bench_find_closest_binary( bench::State& state )
+{
+  Vector<Image> vec = random_images( state.arg() );
+  vec.sort( less_intensity );
+  Image query = random_image();
+
+  while ( state.keep_running() )
+    bench::do_not_optimize(
+        vec.find_closest_binary( query, 15, L2Distance(), less_intensity ) );
+  state.set_items( 1 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  bench::add( "push_back_int", bench_push_back_int, { 16, 1024, 65536 } );
+  bench::add( "push_back_image", bench_push_back_image, { 16, 1024 } );
+  bench::add( "sort_int", bench_sort_int, { 16, 1024, 65536 } );
+  bench::add( "sort_image", bench_sort_image, { 16, 1024 } );
+  bench::add( "find_closest_linear", bench_find_closest_linear,
+              { 100, 1000, 10000 } );
+  bench::add( "find_closest_binary", bench_find_closest_binary,
+              { 100, 1000, 10000 } );
+  return bench::run( argc, argv );
+}
@@ -5,18 +5,59 @@
 //
 // Author : Kaishuo Cheng, Yanghui Ou
 //   Date : Summer 2019
+//
+// Given a raw image file, trains the given system, classifies the image
+// and prints the result for the frontend. With --serve=<path>, it instead
+// trains once and serves classification requests from any number of
+// clients on a Unix domain socket at <path>. Requests from all clients
+// go into one bounded queue that a fixed pool of workers serves in
+// batches (see BatchingClassifier.h); when the queue is full, a request
+// is answered with status busy right away.
+//
+// Images are exchanged in binary, as the 28x28 pixels row by row with
+// one byte per pixel (the same layout as an image in the MNIST files).
+// A request is exactly one such image. The response is a fixed 12 bytes:
+//
+//   byte  0     status: 0 ok, 1 busy, 2 error
+//   byte  1     predicted label (an ASCII digit)
+//   bytes 2-3   zero
+//   bytes 4-7   distance to the closest training image
+//   bytes 8-11  index of the closest image in the training file, or -1
+//               if it is not known
+//
+// with both numbers as little-endian 32-bit signed integers. So neither
+// end has to format or parse any text, and the closest image can be read
+// straight out of the training file by its index.
+//
+// With --preprocess, the training images and every query are cropped,
+// centered and deskewed (see ImagePreprocessor.h) before they reach the
+// system, which makes drawings from the canvas look like MNIST digits.
+// Distances are then between preprocessed images.
+//
+// The distance kernel is chosen for the training set once it is loaded
+// (see Image::choose_distance_kernel).
 
 #include <iostream>
 #include <fstream>
-#include <assert.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "ece2400-stdlib.h"
 #include "mnist-utils.h"
 #include "Vector.h"
 #include "Image.h"
+#include "BatchingClassifier.h"
+#include "ImagePreprocessor.h"
 #include "HRSLinearSearch.h"
 #include "HRSBinarySearch.h"
 #include "HRSTreeSearch.h"
-#include "HRSTableSearch.h"
+#include "HRSVPTreeSearch.h"
 #include "HRSAlternative.h"
 
 using namespace std;
@@ -29,159 +70,408 @@ const std::string  mnsit_dir     = "/classes/ece2400/mnist/";
 const int training_size = 60000;
 const int ncols         = 28;
 const int nrows         = 28;
+const int image_bytes   = ncols * nrows;
+const int reply_bytes   = 12;
+
+const unsigned char status_ok    = 0;
+const unsigned char status_busy  = 1;
+const unsigned char status_error = 2;
 
 //------------------------------------------------------------------------
 // read_image
 //------------------------------------------------------------------------
+// Reads a raw image file. Returns false unless it holds exactly
+// ncols * nrows bytes.
 
-void read_image( const char* file_name, Vector<int>& vec )
+bool read_image( const char* file_name, unsigned char* bytes )
 {
-  ifstream img_file( file_name );
+  ifstream img_file( file_name, std::ios::binary );
+  if ( !img_file )
+    return false;
 
-  // Abort if file does not exists
-  if ( !img_file ) {
-    std::cout << file_name << " does not exists!" << std::endl;
-    assert( false );
-  }
+  img_file.read( (char*) bytes, image_bytes );
+  return img_file.gcount() == image_bytes && img_file.get() == EOF;
+}
+
+//------------------------------------------------------------------------
+// make_hrs
+//------------------------------------------------------------------------
+// Returns a new system for the given method, or nullptr if there is no
+// such method.
 
-  std::string line;
+IHandwritingRecSys* make_hrs( const std::string& method )
+{
+  if ( method == "LinearSearch" )
+    return new HRSLinearSearch();
+  if ( method == "BinarySearch" )
+    return new HRSBinarySearch();
+  if ( method == "TreeSearch" )
+    return new HRSTreeSearch();
+  if ( method == "VPTreeSearch" )
+    return new HRSVPTreeSearch();
+  if ( method == "Alternative" )
+    return new HRSAlternative();
+  return nullptr;
+}
+
+//------------------------------------------------------------------------
+// parse_image
+//------------------------------------------------------------------------
+// Turns the raw bytes of a request into an image. The only allocation is
+// the pixels of the image itself.
+
+Image parse_image( const unsigned char* bytes )
+{
+  int pixels[image_bytes];
+  for ( int i = 0; i < image_bytes; i++ )
+    pixels[i] = bytes[i];
+  return Image( Vector<int>( pixels, image_bytes ), ncols, nrows );
+}
+
+//------------------------------------------------------------------------
+// encode_reply
+//------------------------------------------------------------------------
 
-  // Parse data line by line
-  while( getline( img_file, line ) ) {
-    long unsigned int pos;
-    std::string token;
-    while( ( pos = line.find( ' ' ) ) != std::string::npos ) {
-      token = line.substr( 0, pos );
-      vec.push_back( std::stoi( token ) );
-      line.erase( 0, pos + 1 );
+void put_int32( unsigned char* out, int value )
+{
+  unsigned int bits = (unsigned int) value;
+  for ( int i = 0; i < 4; i++ )
+    out[i] = (unsigned char) ( bits >> ( 8 * i ) );
+}
+
+void encode_reply( unsigned char* out, unsigned char status, char label,
+                   int distance, int index )
+{
+  out[0] = status;
+  out[1] = (unsigned char) label;
+  out[2] = 0;
+  out[3] = 0;
+  put_int32( out + 4, distance );
+  put_int32( out + 8, index );
+}
+
+//------------------------------------------------------------------------
+// TrainingIndex
+//------------------------------------------------------------------------
+// The systems return a copy of the closest training image rather than
+// its position, so the position is looked up by the hash of its pixels.
+// Duplicates collapsed at train time map to their first occurrence.
+
+class TrainingIndex {
+ public:
+  TrainingIndex() : m_training( nullptr ) {}
+
+  void build( const Vector<Image>& training )
+  {
+    m_training = &training;
+    m_positions.clear();
+    m_positions.reserve( (size_t) training.size() );
+    for ( int i = 0; i < training.size(); i++ )
+      m_positions.insert( std::make_pair( training[i].hash(), i ) );
+  }
+
+  int find( const Image& img ) const
+  {
+    if ( m_training == nullptr )
+      return -1;
+
+    int  first = -1;
+    auto range = m_positions.equal_range( img.hash() );
+    for ( auto it = range.first; it != range.second; ++it ) {
+      const Image& candidate = ( *m_training )[it->second];
+      if ( !( candidate == img ) )
+        continue;
+      if ( candidate.get_label() == img.get_label() &&
+           ( first < 0 || it->second < first ) )
+        first = it->second;
     }
+    return first;
+  }
+
+ private:
+  const Vector<Image>*                      m_training;
+  std::unordered_multimap<unsigned int, int> m_positions;
+};
 
-    // If there is a remaining token
-    if ( line.length() > 0 )
-      vec.push_back( std::stoi( line ) );
+//------------------------------------------------------------------------
+// send_all / recv_all
+//------------------------------------------------------------------------
+// Send or receive exactly len bytes. Return false if the client has gone
+// away.
+
+bool send_all( int fd, const void* buf, size_t len )
+{
+  const char* p = (const char*) buf;
+  while ( len > 0 ) {
+    ssize_t n = send( fd, p, len, MSG_NOSIGNAL );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return false;
+    p += n;
+    len -= (size_t) n;
   }
+  return true;
+}
+
+bool recv_all( int fd, void* buf, size_t len )
+{
+  char* p = (char*) buf;
+  while ( len > 0 ) {
+    ssize_t n = recv( fd, p, len, 0 );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return false;
+    p += n;
+    len -= (size_t) n;
+  }
+  return true;
 }
 
 //------------------------------------------------------------------------
-// main
+// serve_client
 //------------------------------------------------------------------------
+// Answers the requests of one client in order until it disconnects.
 
-int main( int argc, char** argv ) {
+void serve_client( int fd, BatchingClassifier* server,
+                   const TrainingIndex* index, const ImagePreprocessor* pre )
+{
+  unsigned char request[image_bytes];
+  unsigned char reply[reply_bytes];
+
+  while ( recv_all( fd, request, image_bytes ) ) {
+    Image              img = parse_image( request );
+    if ( pre != nullptr )
+      img = pre->apply( img );
+    std::future<Image> result;
+    int                neighbor = -1;
+
+    encode_reply( reply, status_error, '?', -1, -1 );
+    if ( !server->try_submit( img, result, &neighbor ) ) {
+      encode_reply( reply, status_busy, '?', -1, -1 );
+    }
+    else {
+      try {
+        Image closest = result.get();
+        if ( neighbor < 0 )
+          neighbor = index->find( closest );
+        encode_reply( reply, status_ok, closest.get_label(),
+                      closest.distance( img ), neighbor );
+      }
+      catch ( ... ) {
+      }
+    }
 
-  // Read the image to classify from the txt file
-  Vector<int> v_img;
-  read_image( argv[1], v_img );
+    if ( !send_all( fd, reply, reply_bytes ) )
+      break;
+  }
+  close( fd );
+}
 
-  assert( v_img.size() == ncols * nrows );
+//------------------------------------------------------------------------
+// serve
+//------------------------------------------------------------------------
+// Listens on a Unix domain socket and serves every client that connects
+// on its own thread. Runs until it is killed.
 
-  Image img = Image( v_img, ncols, nrows );
+int serve( const std::string& socket_path, BatchingClassifier& server,
+           const TrainingIndex& index, const ImagePreprocessor* pre )
+{
+  sockaddr_un addr;
+  std::memset( &addr, 0, sizeof( addr ) );
+  addr.sun_family = AF_UNIX;
+  if ( socket_path.size() >= sizeof( addr.sun_path ) ) {
+    std::cout << "Socket path is too long: " << socket_path << std::endl;
+    return 1;
+  }
+  std::strcpy( addr.sun_path, socket_path.c_str() );
+  unlink( socket_path.c_str() );
+
+  int listener = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if ( listener < 0 || bind( listener, (sockaddr*) &addr, sizeof( addr ) ) ||
+       listen( listener, 64 ) ) {
+    std::cout << "Could not listen on " << socket_path << ": "
+              << std::strerror( errno ) << std::endl;
+    return 1;
+  }
 
-  Vector<Image> v_training;
+  std::cout << "Serving on " << socket_path << std::endl;
+  for ( ;; ) {
+    int fd = accept( listener, nullptr, nullptr );
+    if ( fd < 0 ) {
+      if ( errno == EINTR )
+        continue;
+      std::cout << "accept failed: " << std::strerror( errno ) << std::endl;
+      return 1;
+    }
+    std::thread( serve_client, fd, &server, &index, pre ).detach();
+  }
+}
 
-  // Reads images into training vector
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
 
-  std::string image_path = mnsit_dir + "training-images.bin";
-  std::string label_path = mnsit_dir + "training-labels.bin";
+int main( int argc, char** argv ) {
 
-  read_labeled_images( image_path, label_path, v_training, training_size );
+  // Strip the options of the server
+
+  std::string socket_path = take_option( argc, argv, "--serve" );
+  std::string dataset_dir = take_option( argc, argv, "--dataset" );
+  std::string workers_str = take_option( argc, argv, "--workers" );
+  std::string queue_str   = take_option( argc, argv, "--queue" );
+  std::string batch_str   = take_option( argc, argv, "--batch" );
+  std::string window_str  = take_option( argc, argv, "--window-us" );
+  bool        use_mmap    = take_flag( argc, argv, "--mmap" );
+  bool        preprocess  = take_flag( argc, argv, "--preprocess" );
+
+  ImagePreprocessor        preprocessor;
+  const ImagePreprocessor* pre = preprocess ? &preprocessor : nullptr;
+
+  if ( dataset_dir.empty() )
+    dataset_dir = mnsit_dir;
+  else if ( dataset_dir[dataset_dir.size() - 1] != '/' )
+    dataset_dir += "/";
+
+  std::string image_path = dataset_dir + "training-images.bin";
+  std::string label_path = dataset_dir + "training-labels.bin";
+
+  if ( !socket_path.empty() ) {
+    if ( argc != 2 ) {
+      std::cout << "usage: ./hrs-backend --serve=<socket> <method> "
+                << "[--dataset=<dir>] [--workers=<n>] [--queue=<n>] "
+                << "[--batch=<n>] [--window-us=<n>] [--mmap | --preprocess]"
+                << std::endl;
+      return 1;
+    }
 
-  std::string method = argv[2];
+    std::string         method = argv[1];
+    IHandwritingRecSys* hrs    = make_hrs( method );
+    if ( hrs == nullptr ) {
+      std::cout << "Unknown method: " << method << std::endl;
+      return 1;
+    }
 
-  double training_time;
-  double infering_time;
+    // A mapped linear search reads the training set in place, so one
+    // batch of requests costs a single pass over the file
 
-  Image result;
+    int count = count_labeled_images( image_path );
+    if ( count < 1 ) {
+      std::cout << "Could not read the dataset in " << dataset_dir
+                << std::endl;
+      return 1;
+    }
 
-  // Train and classify
-  if ( method == "LinearSearch" ) {
-    HRSLinearSearch hrs;
-
-    // Training
-    ece2400::timer_reset();
-    hrs.train( v_training );
-    training_time = ece2400::timer_get_elapsed();
-
-    // Inference
-    ece2400::timer_reset();
-    result = hrs.classify( img );
-    infering_time = ece2400::timer_get_elapsed();
-  }
+    // A mapped linear search reports the index of every neighbor in the
+    // training file; otherwise the index is looked up from the training
+    // set in memory
+
+    Vector<Image>    v_training;
+    TrainingIndex    index;
+    HRSLinearSearch* linear = dynamic_cast<HRSLinearSearch*>( hrs );
+    if ( use_mmap && linear != nullptr && !preprocess ) {
+      linear->map_training_set( image_path, label_path );
+    }
+    else {
+      read_labeled_images( image_path, label_path, v_training, count );
+      if ( preprocess )
+        v_training = preprocessor.apply( v_training );
+      Image::choose_distance_kernel( v_training );
+      hrs->train( v_training );
+      index.build( v_training );
+    }
 
-  else if ( method == "BinarySearch" ) {
-    HRSBinarySearch hrs;
+    int status = 1;
+    try {
+      BatchingClassifier server(
+          *hrs, workers_str.empty() ? 1 : atoi( workers_str.c_str() ),
+          queue_str.empty() ? 1024 : atoi( queue_str.c_str() ),
+          batch_str.empty() ? 64 : atoi( batch_str.c_str() ),
+          window_str.empty() ? 200000
+                             : 1000LL * atoll( window_str.c_str() ) );
+      status = serve( socket_path, server, index, pre );
+    }
+    catch ( ece2400::InvalidArgument e ) {
+      std::cout << "Invalid server settings: " << e.to_str() << std::endl;
+    }
+    delete hrs;
+    return status;
+  }
 
-    // Training
-    ece2400::timer_reset();
-    hrs.train( v_training );
-    training_time = ece2400::timer_get_elapsed();
+  if ( argc != 3 && !( argc == 4 && std::string( argv[3] ) == "--pretty" ) ) {
+    std::cout << "usage: ./hrs-backend <image.bin> <method> [--pretty] "
+              << "[--preprocess]"
+              << std::endl;
+    return 1;
+  }
 
-    // Inference
-    ece2400::timer_reset();
-    result = hrs.classify( img );
-    infering_time = ece2400::timer_get_elapsed();
+  // Read the image to classify from the raw file
+  unsigned char bytes[image_bytes];
+  if ( !read_image( argv[1], bytes ) ) {
+    std::cout << "Could not read a " << ncols << "x" << nrows
+              << " raw image from " << argv[1] << std::endl;
+    return 1;
   }
 
-  else if ( method == "TreeSearch" ) {
-    HRSTreeSearch hrs;
+  Image img = parse_image( bytes );
+  if ( preprocess )
+    img = preprocessor.apply( img );
 
-    // Training
-    ece2400::timer_reset();
-    hrs.train( v_training );
-    training_time = ece2400::timer_get_elapsed();
+  Vector<Image> v_training;
+
+  // Reads images into training vector
 
-    // Inference
-    ece2400::timer_reset();
-    result = hrs.classify( img );
-    infering_time = ece2400::timer_get_elapsed();
+  int count = count_labeled_images( image_path );
+  if ( count < 1 ) {
+    std::cout << "Could not read the dataset in " << dataset_dir
+              << std::endl;
+    return 1;
   }
+  read_labeled_images( image_path, label_path, v_training,
+                       count < training_size ? count : training_size );
+  if ( preprocess )
+    v_training = preprocessor.apply( v_training );
+  Image::choose_distance_kernel( v_training );
 
-  else if ( method == "TableSearch" ) {
-    HRSTableSearch hrs;
+  std::string method = argv[2];
+
+  double training_time = 0.0;
+  double infering_time = 0.0;
 
-    // Training
-    ece2400::timer_reset();
-    hrs.train( v_training );
-    training_time = ece2400::timer_get_elapsed();
+  Image result;
 
-    // Inference
-    ece2400::timer_reset();
-    result = hrs.classify( img );
-    infering_time = ece2400::timer_get_elapsed();
+  // Train and classify
+  IHandwritingRecSys* hrs = make_hrs( method );
+  if ( hrs == nullptr ) {
+    std::cout << "Unknown method: " << method << std::endl;
+    return 1;
   }
 
-  else if ( method == "Alternative" ) {
-    HRSAlternative hrs;
+  // Training
+  ece2400::timer_reset();
+  hrs->train( v_training );
+  training_time = ece2400::timer_get_elapsed();
 
-    // Training
-    ece2400::timer_reset();
-    hrs.train( v_training );
-    training_time = ece2400::timer_get_elapsed();
+  // Inference
+  ece2400::timer_reset();
+  result = hrs->classify( img );
+  infering_time = ece2400::timer_get_elapsed();
 
-    // Inference
-    ece2400::timer_reset();
-    result = hrs.classify( img );
-    infering_time = ece2400::timer_get_elapsed();
-  }
+  delete hrs;
 
-  std::cout << "Training Time: "    << training_time << std::endl;
-  std::cout << "Inferene Time: "    << infering_time << std::endl;
-  std::cout << "Prediction Label: " << result.get_label() << std::endl;
-  std::cout << "Prediction Match: " << std::endl;
+  TrainingIndex index;
+  index.build( v_training );
 
-  // Print out the closest image
+  std::cout << "Training Time: "       << training_time         << std::endl;
+  std::cout << "Inference Time: "      << infering_time         << std::endl;
+  std::cout << "Prediction Label: "    << result.get_label()    << std::endl;
+  std::cout << "Prediction Distance: " << result.distance( img ) << std::endl;
+  std::cout << "Prediction Index: "    << index.find( result )  << std::endl;
 
-  if ( argc == 4 && std::string( argv[3] ) == "--pretty") {
+  // Print out the closest image
+  if ( argc == 4 )
     result.print();
-  }
-  else{
-    // Print out numerical value
-    for ( int i = 0; i < nrows; i++ ) {
-      for ( int j = 0; j < ncols; j++ ) {
-        std::cout << result.at( j, i ) << " ";
-      }
-      std::cout << std::endl;
-    }
-  }
 
   return 0;
 }
@@ -8,6 +8,8 @@
 #include <iomanip> // for std::setw
 #include "ece2400-stdlib.h"
 #include "mnist-utils.h"
+#include "Histogram.h"
+#include "PerfCounters.h"
 #include "Vector.h"
 #include "HRSBinarySearch.h"
 
@@ -15,6 +17,12 @@
 // constants
 //------------------------------------------------------------------------
 
+const std::string default_dataset_dir = "/classes/ece2400/mnist/";
+
+//------------------------------------------------------------------------
+// print_help
+//------------------------------------------------------------------------
+
 void print_help()
 {
   std::cout << "usage: ./hrs-binary-search-eval [<train_size>] [<test_size>] [<K>]"
@@ -26,21 +34,30 @@ void print_help()
             << std::endl << std::endl
             << "positional arguments:" << std::endl
             << "  train_size  Size of the training set. " << std::endl
-            << "It has to be within (0, 60000]." << std::endl
+            << "It has to be within (0, 60000] for MNIST." << std::endl
             << "  test_size   Size of the testing set. " << std::endl
-            << "It has to be within (0, 10000]." << std::endl
-            << "  K           Const K. " << std::endl;
+            << "It has to be within (0, 10000] for MNIST." << std::endl
+            << "  K           Const K. " << std::endl
+            << std::endl
+            << "optional arguments:" << std::endl
+            << "  --perf-counters  Report hardware performance counters "
+            << "for training and classification." << std::endl
+            << "  --dataset=<dir>  Read the training and testing sets "
+            << "from <dir> instead of " << default_dataset_dir
+            << ", e.g. a dataset made by mnist-synth. The full sizes "
+            << "are the sizes of that dataset." << std::endl
+            << "  --stream=<n>     Train with train_stream, reading "
+            << "<n> training images at a time instead of all of them "
+            << "up front. The training time then includes reading."
+            << std::endl;
 }
 
 //------------------------------------------------------------------------
 // constants
 //------------------------------------------------------------------------
 
-const std::string  mnsit_dir          = "/classes/ece2400/mnist/";
-const int full_training_size = 60000;
-const int full_testing_size  = 10000;
-const int default_k          = 1000;
-const int width              = 22;
+const int default_k = 1000;
+const int width     = 22;
 
 //------------------------------------------------------------------------
 // main
@@ -48,6 +65,19 @@ const int width              = 22;
 
 int main( int argc, char** argv )
 {
+  // Strip optional flags so the positional arguments keep their places
+
+  bool        perf_counters = take_flag( argc, argv, "--perf-counters" );
+  std::string dataset_dir   = take_option( argc, argv, "--dataset" );
+  std::string stream_str    = take_option( argc, argv, "--stream" );
+  int         stream_batch  = atoi( stream_str.c_str() );
+
+  if ( !stream_str.empty() && stream_batch < 1 ) {
+    std::cout << "Invalid stream batch size: " << stream_str
+              << std::endl << std::endl;
+    return 1;
+  }
+
   // Parse command line argument
   int testing_size;
   int training_size;
@@ -60,6 +90,24 @@ int main( int argc, char** argv )
     return 1;
   }
 
+  // The full sizes are the sizes of the dataset
+
+  if ( dataset_dir.empty() )
+    dataset_dir = default_dataset_dir;
+  else if ( dataset_dir[dataset_dir.size() - 1] != '/' )
+    dataset_dir += "/";
+
+  int full_training_size =
+      count_labeled_images( dataset_dir + "training-images.bin" );
+  int full_testing_size =
+      count_labeled_images( dataset_dir + "testing-images.bin" );
+
+  if ( full_training_size < 1 || full_testing_size < 1 ) {
+    std::cout << "Could not read the dataset in " << dataset_dir
+              << std::endl << std::endl;
+    return 1;
+  }
+
   if ( argc == 1 ) {
     training_size = full_training_size;
     testing_size  = full_testing_size;
@@ -99,15 +147,22 @@ int main( int argc, char** argv )
 
   // Reads images into training vector
 
-  std::string image_path = mnsit_dir + "training-images.bin";
-  std::string label_path = mnsit_dir + "training-labels.bin";
+  std::string image_path = dataset_dir + "training-images.bin";
+  std::string label_path = dataset_dir + "training-labels.bin";
 
-  read_labeled_images( image_path, label_path, v_train, training_size );
+  // When streaming, the training images are only read during training
+
+  LabeledImageStream* training_stream = nullptr;
+  if ( stream_batch > 0 )
+    training_stream =
+        new LabeledImageStream( image_path, label_path, training_size );
+  else
+    read_labeled_images( image_path, label_path, v_train, training_size );
 
   // Reads images into testing vector
 
-  image_path = mnsit_dir + "testing-images.bin";
-  label_path = mnsit_dir + "testing-labels.bin";
+  image_path = dataset_dir + "testing-images.bin";
+  label_path = dataset_dir + "testing-labels.bin";
 
   read_labeled_images( image_path, label_path, v_test, testing_size );
 
@@ -115,20 +170,43 @@ int main( int argc, char** argv )
 
   HRSBinarySearch clf( K );
 
+  // Count hardware events in each phase if requested
+
+  PerfCounters training_counters;
+  PerfCounters classification_counters;
+  if ( perf_counters ) {
+    training_counters.open();
+    classification_counters.open();
+  }
+
   // Time the training phase
 
+  training_counters.start();
   ece2400::timer_reset();
 
-  clf.train( v_train );
+  if ( stream_batch > 0 )
+    clf.train_stream( *training_stream, stream_batch );
+  else
+    clf.train( v_train );
 
   double training_time = ece2400::timer_get_elapsed();
+  training_counters.stop();
+
+  delete training_stream;
+
+  // Time the classification phase, recording the latency and the number
+  // of distance evaluations of every query
 
-  // Time the classification phase
+  Histogram latency_ns;
+  Histogram distances;
 
+  classification_counters.start();
   ece2400::timer_reset();
 
-  double accuracy = classify_with_progress_bar( clf, v_test );
+  double accuracy =
+      classify_with_progress_bar( clf, v_test, &latency_ns, &distances );
   double classification_time = ece2400::timer_get_elapsed();
+  classification_counters.stop();
 
   std::cout << std::setw(width) << std::left
             << " - training time" << " : " << training_time
@@ -137,11 +215,30 @@ int main( int argc, char** argv )
             << " - classification time" << " : " << classification_time
             << " seconds" << std::endl;
 
+  clf.stats().print();
+
+  if ( perf_counters ) {
+    training_counters.print( "training", 0 );
+    classification_counters.print( "classification", testing_size );
+  }
+
   // Report accuracy only if using the full traininig dataset
 
   if ( training_size == full_training_size && testing_size == full_testing_size )
     std::cout << std::setw(width) << std::left
               << " - accuracy" << " : " << accuracy << std::endl;
 
+  // Report the tail latency and the spread of the work per query
+
+  latency_ns.print_percentiles( "latency", "us", 1e-3 );
+  distances.print_percentiles( "distances", "per query" );
+  latency_ns.print( "latency", "us", 1e-3 );
+  distances.print( "distances", "per query" );
+
+  // Report where the time went when run with ECE2400_PROFILE=1
+
+  if ( ece2400::profile_enabled() )
+    ece2400::profile_print();
+
   return 0;
 }
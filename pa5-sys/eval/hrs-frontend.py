@@ -17,6 +17,7 @@ import os
 from PIL import Image, ImageDraw, ImageFilter, ImageTk
 import numpy as np
 import subprocess
+import struct
 
 #-------------------------------------------------------------------------
 # global variables
@@ -35,12 +36,13 @@ method     = ''
 dotsize    = 26
 whiteratio = 20
 canvasdege = 640
+mnist_dir  = '/classes/ece2400/mnist/'
 
 OPTIONS = [
   "LinearSearch",
   "BinarySearch",
   "TreeSearch",
-  "TableSearch",
+  "VPTreeSearch",
   "Alternative",
 ]
 
@@ -141,17 +143,10 @@ def run_backend( png_file ):
     nl = np.reshape( nl, ( 140, 168 ) )
     tva = [ (255 - x) for x in tva ]
 
-    try:
-      os.remove( './image.txt' )
-    except:
-       pass
+    # The backend reads the raw pixels, one byte each
 
-    with open( 'image.txt', 'w' ) as f:
-      for i in range( len(tva) ):
-        item = str( tva[i] )
-        f.write( item + ' ' )
-        if ( i % 28 ) == 27:
-          f.write("\n")
+    with open( 'image.bin', 'wb' ) as f:
+      f.write( struct.pack( '784B', *[ int(x) for x in tva ] ) )
 
     try:
         os.remove('./my_plot.png')
@@ -173,7 +168,7 @@ def run_backend( png_file ):
       return
 
     p = subprocess.Popen(
-      "./hrs-backend image.txt " + method,
+      "./hrs-backend image.bin " + method + " --preprocess",
       shell=True,
       stdout=subprocess.PIPE,
       stderr=subprocess.PIPE
@@ -181,7 +176,7 @@ def run_backend( png_file ):
 
     print( p )
 
-    cimage = output_to_img( p )
+    cimage = read_training_image( parse_output( p ) )
     cnl = expand(cimage,6,5)
     cnl = np.reshape(cnl,(140,168))
 
@@ -195,45 +190,50 @@ def run_backend( png_file ):
                  padx = (15,1), pady =(8,14), sticky = 'e' )
 
 #-------------------------------------------------------------------------
-# output_to_img
+# parse_output
 #-------------------------------------------------------------------------
+# The backend prints one "name: value" line per result. Returns the
+# index of the closest image in the training file, or -1.
 
-def output_to_img( p ):
+def parse_output( p ):
   global traintime
   global infertime
   global label
-  cimage = []
-
-  trainindx = p.find("Training Time: ") #15
-
-  inferindx = p.find("Inferene Time: ")#15
-  labelindx = p.find("Prediction Label: ") #18
-  imgindx = p.find("Prediction Match: ")#18
-  traintime = p[trainindx+15:inferindx-1]
-  infertime = p[inferindx+15:labelindx-1]
-  label = p[labelindx+18:imgindx-1]
 
-  img = p[imgindx+19:]
-  x = 0
-  while x < (len(img)-1):
-    if img[x] != " " and  img[x] != "\n":
+  fields = {}
+  for line in p.splitlines():
+    name, sep, value = line.partition( ': ' )
+    if sep:
+      fields[name] = value.strip()
 
-      if img[x+1] == " " or img[x+1] == "\n":
-        cimage.append(255 - int(img[x]))
+  traintime = fields.get( 'Training Time', '' )
+  infertime = fields.get( 'Inference Time', '' )
+  label     = fields.get( 'Prediction Label', '' )
 
-      elif img[x+2] == " " or img[x+2] == "\n":
-        k = 255- 10*int(img[x]) - int(img[x+1])
-        cimage.append(k)
-        x = x+1
+  try:
+    return int( fields.get( 'Prediction Index', '-1' ) )
+  except ValueError:
+    return -1
 
-      else:
-        k = 255 - 100* int(img[x]) - 10*int(img[x+1])-int(img[x+2])
-        cimage.append(k)
-        x = x+2
-
-    x = x+1
-
-  return cimage
+#-------------------------------------------------------------------------
+# read_training_image
+#-------------------------------------------------------------------------
+# Reads the closest image straight out of the MNIST training file, which
+# holds a 16 byte header followed by 784 bytes per image. Returns a blank
+# image if the index is not known.
+
+def read_training_image( index ):
+  if index < 0:
+    return [255] * 784
+
+  try:
+    with open( mnist_dir + 'training-images.bin', 'rb' ) as f:
+      f.seek( 16 + 784 * index )
+      pixels = struct.unpack( '784B', f.read( 784 ) )
+  except ( IOError, struct.error ):
+    return [255] * 784
+
+  return [ 255 - x for x in pixels ]
 
 #-------------------------------------------------------------------------
 # clickrun
@@ -8,6 +8,8 @@
 #include <iomanip> // for std::setw
 #include "ece2400-stdlib.h"
 #include "mnist-utils.h"
+#include "Histogram.h"
+#include "PerfCounters.h"
 #include "Vector.h"
 #include "HRSLinearSearch.h"
 
@@ -15,9 +17,16 @@
 // constants
 //------------------------------------------------------------------------
 
+const std::string default_dataset_dir = "/classes/ece2400/mnist/";
+
+//------------------------------------------------------------------------
+// print_help
+//------------------------------------------------------------------------
+
 void print_help()
 {
-  std::cout << "usage: ./hrs-linear-search-eval [<train_size>] [<test_size>]"
+  std::cout << "usage: ./hrs-linear-search-eval [<train_size>] [<test_size>] "
+            << "[<condense>]"
             << std::endl << std::endl
             << "Evaluation program for HRSBinarySearch. You must use "
             << "full training set to get the accuracy! "
@@ -26,19 +35,91 @@ void print_help()
             << std::endl << std::endl
             << "positional arguments:" << std::endl
             << "  train_size  Size of the training set. " << std::endl
-            << "It has to be within (0, 60000]." << std::endl
+            << "It has to be within (0, 60000] for MNIST." << std::endl
             << "  test_size   Size of the testing set. " << std::endl
-            << "It has to be within (0, 10000]." << std::endl;
+            << "It has to be within (0, 10000] for MNIST." << std::endl
+            << "  condense    1 to train on condensed prototypes. "
+            << std::endl
+            << std::endl
+            << "optional arguments:" << std::endl
+            << "  --perf-counters  Report hardware performance counters "
+            << "for training and classification." << std::endl
+            << "  --dataset=<dir>  Read the training and testing sets "
+            << "from <dir> instead of " << default_dataset_dir
+            << ", e.g. a dataset made by mnist-synth. The full sizes "
+            << "are the sizes of that dataset." << std::endl
+            << "  --stream=<n>     Train with train_stream, reading "
+            << "<n> training images at a time instead of all of them "
+            << "up front. The training time then includes reading."
+            << std::endl
+            << "  --mmap           Search the training images in place "
+            << "in the memory-mapped training file instead of reading "
+            << "them, for training sets larger than memory." << std::endl
+            << "  --batch=<n>      Classify <n> testing images per call "
+            << "to classify_batch, so each pass over a mapped training "
+            << "set serves <n> queries. Every query of a batch is "
+            << "reported with the latency of the whole batch."
+            << std::endl;
 }
 
 //------------------------------------------------------------------------
 // constants
 //------------------------------------------------------------------------
 
-const std::string mnsit_dir          = "/classes/ece2400/mnist/";
-const int         full_training_size = 60000;
-const int         full_testing_size  = 10000;
-const int         width              = 22;
+const int width = 22;
+
+//------------------------------------------------------------------------
+// classify_in_batches
+//------------------------------------------------------------------------
+// Like classify_with_progress_bar, but classifies batch_size images per
+// call to classify_batch. The latency of every query is the time its
+// batch took, and the distances of a batch are split evenly among its
+// queries.
+
+double classify_in_batches( HRSLinearSearch& hrs, const Vector<Image>& v_test,
+                            int batch_size, Histogram& latency_ns,
+                            Histogram& distances )
+{
+  const int test_size = v_test.size();
+  if ( test_size == 0 )
+    return 0;
+
+  int num_correct = 0;
+  for ( int begin = 0; begin < test_size; begin += batch_size ) {
+    int end = ( test_size - begin < batch_size ) ? test_size
+                                                 : begin + batch_size;
+
+    // scrub the labels before classifying
+    Vector<Image> batch;
+    batch.reserve( end - begin );
+    for ( int i = begin; i < end; i++ ) {
+      batch.push_back( v_test[i] );
+      batch[i - begin].set_label( '?' );
+    }
+
+    long long start_ns    = ece2400::timer_now_ns();
+    HRSStats  start_stats = hrs_stats_local();
+
+    Vector<Image> results = hrs.classify_batch( batch );
+
+    long long elapsed_ns = ece2400::timer_now_ns() - start_ns;
+    long long per_query  = hrs_stats_since( start_stats ).distance_calls /
+                          ( end - begin );
+
+    for ( int i = begin; i < end; i++ ) {
+      latency_ns.record( elapsed_ns );
+      distances.record( per_query );
+      if ( results[i - begin].get_label() == v_test[i].get_label() )
+        num_correct++;
+    }
+
+    std::cout << "\r - classified " << end << " of " << test_size
+              << std::flush;
+  }
+  std::cout << std::endl;
+
+  return (double) num_correct / (double) test_size;
+}
 
 //------------------------------------------------------------------------
 // main
@@ -46,17 +127,64 @@ const int         width              = 22;
 
 int main( int argc, char** argv )
 {
+  // Strip optional flags so the positional arguments keep their places
+
+  bool        perf_counters = take_flag( argc, argv, "--perf-counters" );
+  bool        use_mmap      = take_flag( argc, argv, "--mmap" );
+  std::string dataset_dir   = take_option( argc, argv, "--dataset" );
+  std::string stream_str    = take_option( argc, argv, "--stream" );
+  std::string batch_str     = take_option( argc, argv, "--batch" );
+  int         stream_batch  = atoi( stream_str.c_str() );
+  int         query_batch   = atoi( batch_str.c_str() );
+
+  if ( !stream_str.empty() && stream_batch < 1 ) {
+    std::cout << "Invalid stream batch size: " << stream_str
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  if ( !batch_str.empty() && query_batch < 1 ) {
+    std::cout << "Invalid batch size: " << batch_str
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  if ( use_mmap && stream_batch > 0 ) {
+    std::cout << "--mmap and --stream cannot be combined"
+              << std::endl << std::endl;
+    return 1;
+  }
+
   // Parse command line argument
   int testing_size;
   int training_size;
+  int condense = 0;
 
-  if ( argc != 3 && argc != 1 ) {
+  if ( argc != 4 && argc != 3 && argc != 1 ) {
     std::cout << "Invalid command line arguments!"
               << std::endl << std::endl;
     print_help();
     return 1;
   }
 
+  // The full sizes are the sizes of the dataset
+
+  if ( dataset_dir.empty() )
+    dataset_dir = default_dataset_dir;
+  else if ( dataset_dir[dataset_dir.size() - 1] != '/' )
+    dataset_dir += "/";
+
+  int full_training_size =
+      count_labeled_images( dataset_dir + "training-images.bin" );
+  int full_testing_size =
+      count_labeled_images( dataset_dir + "testing-images.bin" );
+
+  if ( full_training_size < 1 || full_testing_size < 1 ) {
+    std::cout << "Could not read the dataset in " << dataset_dir
+              << std::endl << std::endl;
+    return 1;
+  }
+
   if ( argc == 1 ) {
     training_size = full_training_size;
     testing_size  = full_testing_size;
@@ -65,6 +193,14 @@ int main( int argc, char** argv )
   else {
     training_size = atoi( argv[1] );
     testing_size  = atoi( argv[2] );
+    if ( argc == 4 )
+      condense = atoi( argv[3] );
+
+    if ( use_mmap && condense != 0 ) {
+      std::cout << "A mapped training set cannot be condensed"
+                << std::endl << std::endl;
+      return 1;
+    }
 
     // Check range
     if ( testing_size < 1 || testing_size > full_testing_size ) {
@@ -89,39 +225,81 @@ int main( int argc, char** argv )
             << " - training size" << " : " << training_size << std::endl;
   std::cout << std::setw(width) << std::left
             << " - testing  size" << " : " << testing_size  << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - condense"      << " : " << condense      << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - mmap"          << " : " << use_mmap      << std::endl;
 
   // Reads images into training vector
 
-  std::string image_path = mnsit_dir + "training-images.bin";
-  std::string label_path = mnsit_dir + "training-labels.bin";
+  std::string image_path = dataset_dir + "training-images.bin";
+  std::string label_path = dataset_dir + "training-labels.bin";
+
+  // When streaming, the training images are only read during training,
+  // and when mapping, they are never read
 
-  read_labeled_images( image_path, label_path, v_train, training_size );
+  LabeledImageStream* training_stream = nullptr;
+  if ( stream_batch > 0 )
+    training_stream =
+        new LabeledImageStream( image_path, label_path, training_size );
+  else if ( !use_mmap )
+    read_labeled_images( image_path, label_path, v_train, training_size );
 
   // Reads images into testing vector
 
-  image_path = mnsit_dir + "testing-images.bin";
-  label_path = mnsit_dir + "testing-labels.bin";
+  image_path = dataset_dir + "testing-images.bin";
+  label_path = dataset_dir + "testing-labels.bin";
 
   read_labeled_images( image_path, label_path, v_test, testing_size );
 
   // Instantiate a classifier
 
-  HRSLinearSearch clf;
+  HRSLinearSearch clf( condense != 0 );
+
+  // Count hardware events in each phase if requested
+
+  PerfCounters training_counters;
+  PerfCounters classification_counters;
+  if ( perf_counters ) {
+    training_counters.open();
+    classification_counters.open();
+  }
 
   // Time the training phase
 
+  training_counters.start();
   ece2400::timer_reset();
 
-  clf.train( v_train );
+  if ( use_mmap )
+    clf.map_training_set( dataset_dir + "training-images.bin",
+                          dataset_dir + "training-labels.bin", training_size );
+  else if ( stream_batch > 0 )
+    clf.train_stream( *training_stream, stream_batch );
+  else
+    clf.train( v_train );
 
   double training_time = ece2400::timer_get_elapsed();
+  training_counters.stop();
+
+  delete training_stream;
+
+  // Time the classification phase, recording the latency and the number
+  // of distance evaluations of every query
 
-  // Time the classification phase
+  Histogram latency_ns;
+  Histogram distances;
 
+  classification_counters.start();
   ece2400::timer_reset();
 
-  double accuracy = classify_with_progress_bar( clf, v_test );
+  double accuracy =
+      ( query_batch > 0 )
+          ? classify_in_batches( clf, v_test, query_batch, latency_ns,
+                                 distances )
+          : classify_with_progress_bar( clf, v_test, &latency_ns,
+                                        &distances );
   double classification_time = ece2400::timer_get_elapsed();
+  classification_counters.stop();
 
   std::cout << std::setw(width) << std::left
             << " - training time" << " : " << training_time
@@ -130,11 +308,30 @@ int main( int argc, char** argv )
             << " - classification time" << " : " << classification_time
             << " seconds" << std::endl;
 
+  clf.stats().print();
+
+  if ( perf_counters ) {
+    training_counters.print( "training", 0 );
+    classification_counters.print( "classification", testing_size );
+  }
+
   // Report accuracy only if using the full traininig dataset
 
   if ( training_size == full_training_size && testing_size == full_testing_size )
     std::cout << std::setw(width) << std::left
               << " - accuracy" << " : " << accuracy << std::endl;
 
+  // Report the tail latency and the spread of the work per query
+
+  latency_ns.print_percentiles( "latency", "us", 1e-3 );
+  distances.print_percentiles( "distances", "per query" );
+  latency_ns.print( "latency", "us", 1e-3 );
+  distances.print( "distances", "per query" );
+
+  // Report where the time went when run with ECE2400_PROFILE=1
+
+  if ( ece2400::profile_enabled() )
+    ece2400::profile_print();
+
   return 0;
 }
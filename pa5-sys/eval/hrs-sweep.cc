@@ -0,0 +1,330 @@
+//========================================================================
+// hrs-sweep.cc
+//========================================================================
+// Sweeps the parameters of a handwriting recognition system and reports
+// the accuracy, latency and work of every setting as CSV.
+//
+// Query-time parameters (K of HRSBinarySearch and HRSTreeSearch) are
+// changed on a classifier that has been trained once, so a sweep over
+// many settings costs one training plus one pass over the testing set
+// per setting. Build-time parameters (the leaf size of HRSVPTreeSearch
+// and the number of shards of HRSShardedSearch) need the index to be
+// rebuilt for every setting, which is included in the reported training
+// time. With --preprocess, every system is wrapped in HRSPreprocessed,
+// and preprocessing the training set counts as training time. The
+// distance kernel is chosen for the training set before training unless
+// --kernel picks one, and is reported in every row.
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+#include "Histogram.h"
+#include "Vector.h"
+#include "HRSLinearSearch.h"
+#include "HRSBinarySearch.h"
+#include "HRSTreeSearch.h"
+#include "HRSVPTreeSearch.h"
+#include "HRSShardedSearch.h"
+#include "HRSPreprocessed.h"
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const std::string default_dataset_dir = "/classes/ece2400/mnist/";
+
+//------------------------------------------------------------------------
+// print_help
+//------------------------------------------------------------------------
+
+void print_help()
+{
+  std::cout << "usage: ./hrs-sweep <system> <train_size> <test_size> "
+            << "[<values>] [--csv=<path>] [--dataset=<dir>] [--preprocess] "
+            << "[--kernel=<dense|sparse>]"
+            << std::endl << std::endl
+            << "Trains the given system once and classifies the testing "
+            << "set once for every parameter value, writing one CSV row "
+            << "per value. The accuracy is reported for any training "
+            << "and testing set size."
+            << std::endl << std::endl
+            << "positional arguments:" << std::endl
+            << "  system      linear, binary (sweeps K), tree (sweeps K) "
+            << "vptree (sweeps the leaf size) or sharded (sweeps the "
+            << "number of worker processes)" << std::endl
+            << "  train_size  Size of the training set. " << std::endl
+            << "It has to be within (0, 60000] for MNIST." << std::endl
+            << "  test_size   Size of the testing set. " << std::endl
+            << "It has to be within (0, 10000] for MNIST." << std::endl
+            << "  values      Comma separated parameter values, e.g. "
+            << "1,10,100,1000. Ignored for linear." << std::endl
+            << std::endl
+            << "optional arguments:" << std::endl
+            << "  --csv=<path>  Write the CSV to <path> instead of "
+            << "standard output." << std::endl
+            << "  --dataset=<dir>  Read the training and testing sets "
+            << "from <dir> instead of " << default_dataset_dir
+            << "." << std::endl
+            << "  --preprocess  Crop, center and deskew every image first "
+            << "(see ImagePreprocessor.h)." << std::endl
+            << "  --kernel=<dense|sparse>  Compute distances with the given "
+            << "kernel instead of the faster one on the training set (see "
+            << "Image.h)." << std::endl;
+}
+
+//------------------------------------------------------------------------
+// parse_values
+//------------------------------------------------------------------------
+// Parses a comma separated list of positive integers. Returns false if
+// any of them is not one.
+
+bool parse_values( const std::string& str, std::vector<int>& values )
+{
+  std::stringstream ss( str );
+  std::string       item;
+  while ( std::getline( ss, item, ',' ) ) {
+    char* end;
+    long  value = std::strtol( item.c_str(), &end, 10 );
+    if ( item.empty() || *end != '\0' || value < 1 || value > 1000000000 )
+      return false;
+    values.push_back( (int) value );
+  }
+  return !values.empty();
+}
+
+//------------------------------------------------------------------------
+// write_row
+//------------------------------------------------------------------------
+// Classifies the testing set and writes one CSV row. The stats are reset
+// first so the work of earlier settings is not included.
+
+void write_row( std::ostream& out, IHandwritingRecSys& hrs,
+                const Vector<Image>& v_test, const std::string& system,
+                const std::string& param, int value, int train_size,
+                double train_time )
+{
+  Histogram latency_ns;
+  Histogram distances;
+
+  hrs.reset_stats();
+  double   accuracy = classify_with_progress_bar( hrs, v_test, &latency_ns,
+                                                  &distances, false );
+  HRSStats stats    = hrs.stats();
+
+  double queries = (double) v_test.size();
+
+  out << system << ","
+      << param << ","
+      << value << ","
+      << train_size << ","
+      << v_test.size() << ","
+      << train_time << ","
+      << accuracy << ","
+      << latency_ns.mean() * 1e-3 << ","
+      << (double) latency_ns.percentile( 50.0 ) * 1e-3 << ","
+      << (double) latency_ns.percentile( 99.0 ) * 1e-3 << ","
+      << distances.mean() << ","
+      << (double) stats.nodes_visited / queries << ","
+      << (double) stats.bytes_touched / queries << ","
+      << ( Image::get_distance_kernel() == Image::SPARSE ? "sparse" : "dense" )
+      << std::endl;
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  // Strip optional arguments so the positional arguments keep their
+  // places
+
+  std::string csv_path    = take_option( argc, argv, "--csv" );
+  std::string dataset_dir = take_option( argc, argv, "--dataset" );
+  bool        preprocess  = take_flag( argc, argv, "--preprocess" );
+  std::string kernel      = take_option( argc, argv, "--kernel" );
+
+  if ( argc != 4 && argc != 5 ) {
+    std::cout << "Invalid command line arguments!"
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  std::string system        = argv[1];
+  int         training_size = atoi( argv[2] );
+  int         testing_size  = atoi( argv[3] );
+
+  if ( system != "linear" && system != "binary" && system != "tree" &&
+       system != "vptree" && system != "sharded" ) {
+    std::cout << "Invalid system: " << system
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  // The full sizes are the sizes of the dataset
+
+  if ( dataset_dir.empty() )
+    dataset_dir = default_dataset_dir;
+  else if ( dataset_dir[dataset_dir.size() - 1] != '/' )
+    dataset_dir += "/";
+
+  int full_training_size =
+      count_labeled_images( dataset_dir + "training-images.bin" );
+  int full_testing_size =
+      count_labeled_images( dataset_dir + "testing-images.bin" );
+
+  if ( full_training_size < 1 || full_testing_size < 1 ) {
+    std::cout << "Could not read the dataset in " << dataset_dir
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  // Check range
+  if ( training_size < 1 || training_size > full_training_size ) {
+    std::cout << "Invalid training size: " << training_size
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  // Check range
+  if ( testing_size < 1 || testing_size > full_testing_size ) {
+    std::cout << "Invalid testing size: " << testing_size
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  if ( !kernel.empty() && kernel != "dense" && kernel != "sparse" ) {
+    std::cout << "Invalid kernel: " << kernel
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  std::vector<int> values;
+  if ( system == "linear" )
+    values.push_back( 0 );
+  else if ( argc != 5 || !parse_values( argv[4], values ) ) {
+    std::cout << "Invalid parameter values"
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  std::ofstream csv_file;
+  if ( !csv_path.empty() ) {
+    csv_file.open( csv_path.c_str() );
+    if ( !csv_file ) {
+      std::cout << "Could not open " << csv_path << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = csv_path.empty() ? std::cout : csv_file;
+
+  // Reads images into training vector
+
+  Vector<Image> v_train;
+  Vector<Image> v_test;
+
+  std::string image_path = dataset_dir + "training-images.bin";
+  std::string label_path = dataset_dir + "training-labels.bin";
+
+  read_labeled_images( image_path, label_path, v_train, training_size );
+
+  // Reads images into testing vector
+
+  image_path = dataset_dir + "testing-images.bin";
+  label_path = dataset_dir + "testing-labels.bin";
+
+  read_labeled_images( image_path, label_path, v_test, testing_size );
+
+  if ( kernel.empty() )
+    Image::choose_distance_kernel( v_train );
+  else
+    Image::set_distance_kernel( kernel == "sparse" ? Image::SPARSE
+                                                   : Image::DENSE );
+
+  out << "system,param,value,train_size,test_size,train_time_s,accuracy,"
+      << "mean_latency_us,p50_latency_us,p99_latency_us,"
+      << "distances_per_query,nodes_per_query,bytes_per_query,kernel"
+      << std::endl;
+
+  // Query-time parameters: train once, then change the parameter in
+  // place for every value
+
+  if ( system == "linear" ) {
+    HRSLinearSearch     clf;
+    HRSPreprocessed     pre( clf );
+    IHandwritingRecSys& hrs = preprocess ? (IHandwritingRecSys&) pre : clf;
+    ece2400::timer_reset();
+    hrs.train( v_train );
+    double training_time = ece2400::timer_get_elapsed();
+    write_row( out, hrs, v_test, system, "none", 0, training_size,
+               training_time );
+  }
+
+  else if ( system == "binary" ) {
+    HRSBinarySearch     clf;
+    HRSPreprocessed     pre( clf );
+    IHandwritingRecSys& hrs = preprocess ? (IHandwritingRecSys&) pre : clf;
+    ece2400::timer_reset();
+    hrs.train( v_train );
+    double training_time = ece2400::timer_get_elapsed();
+    for ( size_t i = 0; i < values.size(); i++ ) {
+      clf.set_k( values[i] );
+      write_row( out, hrs, v_test, system, "K", values[i], training_size,
+                 training_time );
+    }
+  }
+
+  else if ( system == "tree" ) {
+    HRSTreeSearch       clf;
+    HRSPreprocessed     pre( clf );
+    IHandwritingRecSys& hrs = preprocess ? (IHandwritingRecSys&) pre : clf;
+    ece2400::timer_reset();
+    hrs.train( v_train );
+    double training_time = ece2400::timer_get_elapsed();
+    for ( size_t i = 0; i < values.size(); i++ ) {
+      clf.set_k( values[i] );
+      write_row( out, hrs, v_test, system, "K", values[i], training_size,
+                 training_time );
+    }
+  }
+
+  // Build-time parameters: the index is rebuilt for every value
+
+  else if ( system == "sharded" ) {
+    for ( size_t i = 0; i < values.size(); i++ ) {
+      HRSShardedSearch    clf( values[i] );
+      HRSPreprocessed     pre( clf );
+      IHandwritingRecSys& hrs = preprocess ? (IHandwritingRecSys&) pre : clf;
+      ece2400::timer_reset();
+      hrs.train( v_train );
+      double training_time = ece2400::timer_get_elapsed();
+      write_row( out, hrs, v_test, system, "shards", values[i],
+                 training_size, training_time );
+    }
+  }
+
+  else {
+    for ( size_t i = 0; i < values.size(); i++ ) {
+      HRSVPTreeSearch     clf( values[i] );
+      HRSPreprocessed     pre( clf );
+      IHandwritingRecSys& hrs = preprocess ? (IHandwritingRecSys&) pre : clf;
+      ece2400::timer_reset();
+      hrs.train( v_train );
+      double training_time = ece2400::timer_get_elapsed();
+      write_row( out, hrs, v_test, system, "leaf_size", values[i],
+                 training_size, training_time );
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,242 @@
+//========================================================================
+// mnist-synth.cc
+//========================================================================
+// Generates a synthetic dataset in the MNIST file format.
+//
+// The generated images are random distortions (see ImageDistorter.h) of
+// either the digits in digits.dat or the MNIST training images, so the
+// eval programs can be run on training sets much larger than MNIST with
+// --dataset=<dir>. Images are generated and written in batches, so the
+// size of the dataset is only limited by the disk.
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip> // for std::setw
+#include <string>
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+#include "ImageDistorter.h"
+#include "Image.h"
+#include "Vector.h"
+
+#include "digits.dat"
+
+//------------------------------------------------------------------------
+// print_help
+//------------------------------------------------------------------------
+
+void print_help()
+{
+  std::cout << "usage: ./mnist-synth <out_dir> <train_size> <test_size> "
+            << "[options]"
+            << std::endl << std::endl
+            << "Writes training-images.bin, training-labels.bin, "
+            << "testing-images.bin and testing-labels.bin to out_dir. "
+            << "The training and testing images are distorted with "
+            << "different random numbers."
+            << std::endl << std::endl
+            << "positional arguments:" << std::endl
+            << "  out_dir     Existing directory to write to." << std::endl
+            << "  train_size  Number of training images to generate."
+            << std::endl
+            << "  test_size   Number of testing images to generate."
+            << std::endl
+            << std::endl
+            << "optional arguments:" << std::endl
+            << "  --source=<dir>  Distort the first 60000 MNIST training "
+            << "images in <dir> instead of digits.dat." << std::endl
+            << "  --seed=<n>      Seed of the random numbers (default 0)."
+            << std::endl
+            << "  --alpha=<x>     Strength of the elastic distortion "
+            << "(default 34)." << std::endl
+            << "  --sigma=<x>     Smoothness of the elastic distortion "
+            << "(default 4)." << std::endl
+            << "  --shift=<n>     Maximum shift in pixels (default 2)."
+            << std::endl
+            << "  --noise=<x>     Standard deviation of the pixel noise "
+            << "(default 8)." << std::endl;
+}
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int ncols        = 28;
+const int nrows        = 28;
+const int img_size     = nrows * ncols;
+const int batch_size   = 10000;
+const int max_size     = 100000000;
+const int source_limit = 60000;
+const int width        = 22;
+
+//------------------------------------------------------------------------
+// load_digits
+//------------------------------------------------------------------------
+
+Vector<Image> load_digits()
+{
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+  return vec;
+}
+
+//------------------------------------------------------------------------
+// generate
+//------------------------------------------------------------------------
+// Cycles through the source images so every one of them is used about
+// equally often, distorting each copy differently.
+
+void generate( const Vector<Image>& source, ImageDistorter& distorter,
+               const std::string& images_path,
+               const std::string& labels_path, int size )
+{
+  // Start with empty files and append one batch at a time
+
+  write_labeled_images( images_path, labels_path, Vector<Image>() );
+
+  Vector<Image> batch;
+  batch.reserve( batch_size );
+  for ( int i = 0; i < size; i++ ) {
+    batch.push_back( distorter.distort( source[i % source.size()] ) );
+    if ( batch.size() == batch_size || i == size - 1 ) {
+      write_labeled_images( images_path, labels_path, batch, true );
+      batch = Vector<Image>();
+      batch.reserve( batch_size );
+      std::cout << "\r - " << images_path << ": " << i + 1 << " / " << size
+                << std::flush;
+    }
+  }
+  std::cout << std::endl;
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  // Strip optional arguments so the positional arguments keep their
+  // places
+
+  std::string source_dir = take_option( argc, argv, "--source" );
+  std::string seed_str   = take_option( argc, argv, "--seed" );
+  std::string alpha_str  = take_option( argc, argv, "--alpha" );
+  std::string sigma_str  = take_option( argc, argv, "--sigma" );
+  std::string shift_str  = take_option( argc, argv, "--shift" );
+  std::string noise_str  = take_option( argc, argv, "--noise" );
+
+  if ( argc != 4 ) {
+    std::cout << "Invalid command line arguments!"
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  std::string out_dir       = argv[1];
+  int         training_size = atoi( argv[2] );
+  int         testing_size  = atoi( argv[3] );
+
+  if ( out_dir[out_dir.size() - 1] != '/' )
+    out_dir += "/";
+
+  // Check range
+  if ( training_size < 1 || training_size > max_size ||
+       testing_size < 1 || testing_size > max_size ) {
+    std::cout << "Invalid size, sizes have to be within (0, " << max_size
+              << "]" << std::endl << std::endl;
+    return 1;
+  }
+
+  unsigned int seed =
+      seed_str.empty() ? 0 : (unsigned int) strtoul( seed_str.c_str(), 0, 10 );
+
+  // Two distorters with different seeds, so that testing images are not
+  // copies of training images
+
+  ImageDistorter train_distorter( 2 * seed );
+  ImageDistorter test_distorter( 2 * seed + 1 );
+
+  try {
+    ImageDistorter* distorters[] = { &train_distorter, &test_distorter };
+    for ( int i = 0; i < 2; i++ ) {
+      ImageDistorter& d = *distorters[i];
+      if ( !alpha_str.empty() || !sigma_str.empty() )
+        d.set_elastic( alpha_str.empty() ? 34.0 : atof( alpha_str.c_str() ),
+                       sigma_str.empty() ? 4.0 : atof( sigma_str.c_str() ) );
+      if ( !shift_str.empty() )
+        d.set_shift( atoi( shift_str.c_str() ) );
+      if ( !noise_str.empty() )
+        d.set_noise( atof( noise_str.c_str() ) );
+    }
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    std::cout << "Invalid distortion: " << e.to_str() << std::endl;
+    return 1;
+  }
+
+  // Read the images to distort
+
+  Vector<Image> source;
+  if ( source_dir.empty() ) {
+    source = load_digits();
+  }
+  else {
+    if ( source_dir[source_dir.size() - 1] != '/' )
+      source_dir += "/";
+    std::string image_path = source_dir + "training-images.bin";
+    std::string label_path = source_dir + "training-labels.bin";
+
+    int count = count_labeled_images( image_path );
+    if ( count < 1 ) {
+      std::cout << "Could not read " << image_path << std::endl;
+      return 1;
+    }
+    read_labeled_images( image_path, label_path, source,
+                         count < source_limit ? count : source_limit );
+  }
+
+  std::cout << "Generating synthetic dataset..." << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - source images" << " = " << source.size() << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - training size" << " = " << training_size << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - testing  size" << " = " << testing_size  << std::endl;
+
+  ece2400::timer_reset();
+
+  try {
+    generate( source, train_distorter, out_dir + "training-images.bin",
+              out_dir + "training-labels.bin", training_size );
+    generate( source, test_distorter, out_dir + "testing-images.bin",
+              out_dir + "testing-labels.bin", testing_size );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    std::cout << "Could not write to " << out_dir << ": " << e.to_str()
+              << std::endl;
+    return 1;
+  }
+
+  std::cout << std::setw(width) << std::left
+            << " - generation time" << " : " << ece2400::timer_get_elapsed()
+            << " seconds" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+//========================================================================
+// tree-stress-eval.cc
+//========================================================================
+// Stress benchmark for Tree. Inserts keys in increasing order, which is
+// the worst case for an unbalanced binary search tree: every node only
+// has a right child, so the tree is as deep as it is large. Reports the
+// throughput of add, contains, to_vector and find_closest.
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip> // for std::setw
+#include "ece2400-stdlib.h"
+#include "Vector.h"
+#include "Tree.h"
+
+//------------------------------------------------------------------------
+// print_help
+//------------------------------------------------------------------------
+
+void print_help()
+{
+  std::cout << "usage: ./tree-stress-eval [<size>] [<queries>] [<K>]"
+            << std::endl << std::endl
+            << "Stress benchmark for Tree. Adds <size> keys in "
+            << "increasing order and then times <queries> contains and "
+            << "find_closest calls on keys spread over the whole range."
+            << std::endl << std::endl
+            << "positional arguments:" << std::endl
+            << "  size     Number of keys to add. " << std::endl
+            << "  queries  Number of contains/find_closest queries. "
+            << std::endl
+            << "  K        Const K passed to the tree. " << std::endl;
+}
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int default_size    = 1000000;
+const int default_queries = 1000;
+const int default_k       = 1000;
+const int width           = 22;
+
+//------------------------------------------------------------------------
+// cmp_int / dist_int
+//------------------------------------------------------------------------
+
+bool cmp_int( int a, int b )
+{
+  return a < b;
+}
+
+int dist_int( int a, int b )
+{
+  return ( a > b ) ? a - b : b - a;
+}
+
+//------------------------------------------------------------------------
+// print_throughput
+//------------------------------------------------------------------------
+
+void print_throughput( const char* name, int ops, double seconds )
+{
+  std::cout << std::setw(width) << std::left << name << " : "
+            << seconds << " seconds (";
+  if ( seconds > 0.0 )
+    std::cout << ops / seconds << " ops/s)" << std::endl;
+  else
+    std::cout << "n/a ops/s)" << std::endl;
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+  // Parse command line argument
+  int size    = default_size;
+  int queries = default_queries;
+  int K       = default_k;
+
+  if ( argc > 4 ) {
+    std::cout << "Invalid command line arguments!"
+              << std::endl << std::endl;
+    print_help();
+    return 1;
+  }
+
+  if ( argc > 1 ) size    = atoi( argv[1] );
+  if ( argc > 2 ) queries = atoi( argv[2] );
+  if ( argc > 3 ) K       = atoi( argv[3] );
+
+  if ( size < 1 || queries < 1 || K < 1 ) {
+    std::cout << "Invalid arguments: size, queries and K must be positive"
+              << std::endl << std::endl;
+    return 1;
+  }
+
+  std::cout << "Stress testing Tree..." << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - size"    << " = " << size    << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - queries" << " = " << queries << std::endl;
+  std::cout << std::setw(width) << std::left
+            << " - K"       << " = " << K       << std::endl;
+
+  Tree<int, bool ( * )( int, int )> tree( K, cmp_int );
+  int errors = 0;
+
+  // Add keys in increasing order
+
+  ece2400::timer_reset();
+
+  for ( int i = 0; i < size; i++ )
+    tree.add( i );
+
+  double add_time = ece2400::timer_get_elapsed();
+
+  if ( tree.size() != size )
+    errors++;
+
+  // Look up keys spread over the whole range
+
+  ece2400::timer_reset();
+
+  for ( int i = 0; i < queries; i++ ) {
+    int key = (int) ( (long long) i * size / queries );
+    if ( !tree.contains( key ) )
+      errors++;
+  }
+
+  double contains_time = ece2400::timer_get_elapsed();
+
+  // Flatten the tree
+
+  ece2400::timer_reset();
+
+  Vector<int> vec = tree.to_vector();
+
+  double to_vector_time = ece2400::timer_get_elapsed();
+
+  if ( vec.size() != size )
+    errors++;
+
+  // Find the closest key to keys spread over the whole range
+
+  ece2400::timer_reset();
+
+  for ( int i = 0; i < queries; i++ ) {
+    int key = (int) ( (long long) i * size / queries );
+    if ( tree.find_closest( key, dist_int ) != key )
+      errors++;
+  }
+
+  double find_closest_time = ece2400::timer_get_elapsed();
+
+  print_throughput( " - add",          size,    add_time          );
+  print_throughput( " - contains",     queries, contains_time     );
+  print_throughput( " - to_vector",    size,    to_vector_time    );
+  print_throughput( " - find_closest", queries, find_closest_time );
+
+  if ( errors > 0 ) {
+    std::cout << " - errors : " << errors << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
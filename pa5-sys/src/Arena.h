@@ -0,0 +1,51 @@
+//========================================================================
+// Arena.h
+//========================================================================
+// Declarations for a generic slab arena.
+//
+// An Arena hands out objects from a list of large, fixed-size slabs.
+// Allocating is a bump of the next free slot, and objects are referred
+// to by an integer handle rather than a pointer, so that a whole arena
+// (and any structure linked together by handles) can be cloned slab by
+// slab. Objects are never freed individually; they all go away at once
+// with clear() or when the arena is destroyed.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+
+template <typename T>
+class Arena {
+ public:
+  Arena( int slab_size = 1024 );
+  ~Arena();
+
+  // Copy constructor
+  Arena( const Arena<T>& arena );
+
+  // Methods
+  int  size() const;
+  int  alloc( const T& value );
+  void clear();
+
+  // Operator overloading
+  const T&  operator[]( int idx ) const;
+  T&        operator[]( int idx );
+  Arena<T>& operator=( const Arena<T>& arena );
+
+ private:
+  void copy_from( const Arena<T>& arena );
+
+  T** m_slabs;
+  int m_nslabs;
+  int m_maxslabs;
+  int m_shift;
+  int m_mask;
+  int m_size;
+};
+
+// Include inline definitions
+#include "Arena.inl"
+
+#endif /* ARENA_H */
@@ -0,0 +1,157 @@
+//========================================================================
+// Arena.inl
+//========================================================================
+// Implementation of Arena.
+
+#include "ece2400-stdlib.h"
+#include <new>
+#include <type_traits>
+
+//------------------------------------------------------------------------
+// Arena
+//------------------------------------------------------------------------
+// The slab size is rounded up to a power of two so that a handle can be
+// split into a slab number and an offset with a shift and a mask.
+
+template <typename T>
+Arena<T>::Arena( int slab_size )
+{
+  if ( slab_size < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "slab size must be positive" );
+    throw e;
+  }
+  m_shift = 0;
+  while ( ( 1 << m_shift ) < slab_size ) {
+    m_shift++;
+  }
+  m_mask     = ( 1 << m_shift ) - 1;
+  m_slabs    = nullptr;
+  m_nslabs   = 0;
+  m_maxslabs = 0;
+  m_size     = 0;
+}
+
+template <typename T>
+Arena<T>::~Arena()
+{
+  clear();
+  delete[] m_slabs;
+}
+
+//------------------------------------------------------------------------
+// size
+//------------------------------------------------------------------------
+// Returns the number of objects allocated so far
+
+template <typename T>
+int Arena<T>::size() const
+{
+  return m_size;
+}
+
+//------------------------------------------------------------------------
+// alloc
+//------------------------------------------------------------------------
+// Copies the value into the next free slot and returns its handle. A
+// new slab is only requested when the last one is full, and existing
+// objects never move.
+
+template <typename T>
+int Arena<T>::alloc( const T& value )
+{
+  int slab = m_size >> m_shift;
+  if ( slab == m_nslabs ) {
+    if ( m_nslabs == m_maxslabs ) {
+      int maxslabs = ( m_maxslabs == 0 ) ? 4 : m_maxslabs * 2;
+      T** slabs    = new T*[maxslabs];
+      for ( int i = 0; i < m_nslabs; i++ ) {
+        slabs[i] = m_slabs[i];
+      }
+      delete[] m_slabs;
+      m_slabs    = slabs;
+      m_maxslabs = maxslabs;
+    }
+    m_slabs[m_nslabs] =
+        static_cast<T*>( ::operator new( sizeof( T ) * ( m_mask + 1 ) ) );
+    m_nslabs++;
+  }
+  new ( &m_slabs[slab][m_size & m_mask] ) T( value );
+  return m_size++;
+}
+
+//------------------------------------------------------------------------
+// clear
+//------------------------------------------------------------------------
+// Releases every object at once. Destructors only have to run for
+// types that need them, so clearing an arena of plain old data just
+// returns its slabs.
+
+template <typename T>
+void Arena<T>::clear()
+{
+  if ( !std::is_trivially_destructible<T>::value ) {
+    for ( int i = 0; i < m_size; i++ ) {
+      ( *this )[i].~T();
+    }
+  }
+  for ( int i = 0; i < m_nslabs; i++ ) {
+    ::operator delete( m_slabs[i] );
+  }
+  m_nslabs = 0;
+  m_size   = 0;
+}
+
+//------------------------------------------------------------------------
+// copy_from
+//------------------------------------------------------------------------
+// Clones the other arena slot by slot. Every object keeps its handle,
+// so links between objects stay valid in the copy.
+
+template <typename T>
+void Arena<T>::copy_from( const Arena<T>& arena )
+{
+  m_shift    = arena.m_shift;
+  m_mask     = arena.m_mask;
+  m_nslabs   = 0;
+  m_maxslabs = arena.m_nslabs;
+  m_size     = 0;
+  m_slabs    = ( m_maxslabs > 0 ) ? new T*[m_maxslabs] : nullptr;
+  for ( int i = 0; i < arena.m_size; i++ ) {
+    alloc( arena[i] );
+  }
+}
+
+template <typename T>
+Arena<T>::Arena( const Arena<T>& arena )
+{
+  copy_from( arena );
+}
+
+template <typename T>
+Arena<T>& Arena<T>::operator=( const Arena<T>& arena )
+{
+  if ( this != &arena ) {
+    clear();
+    delete[] m_slabs;
+    copy_from( arena );
+  }
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// operator[]
+//------------------------------------------------------------------------
+// Returns the object with the given handle
+
+template <typename T>
+const T& Arena<T>::operator[]( int idx ) const
+{
+  return m_slabs[idx >> m_shift][idx & m_mask];
+}
+
+template <typename T>
+T& Arena<T>::operator[]( int idx )
+{
+  return m_slabs[idx >> m_shift][idx & m_mask];
+}
@@ -0,0 +1,189 @@
+//========================================================================
+// BatchingClassifier.cc
+//========================================================================
+// Implementation of BatchingClassifier.
+
+#include "BatchingClassifier.h"
+#include "IHandwritingRecSys.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int idle_spins    = 64;
+const int idle_sleep_us = 50;
+
+//------------------------------------------------------------------------
+// BatchingClassifier
+//------------------------------------------------------------------------
+
+BatchingClassifier::BatchingClassifier( IHandwritingRecSys& hrs,
+                                        int nworkers, int capacity,
+                                        int max_batch, long long window_ns )
+    : m_hrs( hrs ), m_queue( capacity )
+{
+  if ( nworkers < 1 || max_batch < 1 || window_ns < 0 ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "workers and batch size must be positive and the window must not "
+        "be negative" );
+    throw e;
+  }
+  m_max_batch = max_batch;
+  m_window_ns = window_ns;
+  m_stop      = false;
+  m_requests  = 0;
+  m_batches   = 0;
+  m_rejected  = 0;
+
+  for ( int i = 0; i < nworkers; i++ )
+    m_workers.push_back( std::thread( &BatchingClassifier::run_worker, this ) );
+}
+
+//------------------------------------------------------------------------
+// ~BatchingClassifier
+//------------------------------------------------------------------------
+// Workers finish what is queued before they exit. A request submitted
+// while they were exiting is dropped, which breaks its promise, so
+// whoever waits for it gets an exception instead of waiting forever.
+
+BatchingClassifier::~BatchingClassifier()
+{
+  m_stop = true;
+  for ( size_t i = 0; i < m_workers.size(); i++ )
+    m_workers[i].join();
+
+  Request* request;
+  while ( m_queue.try_pop( request ) )
+    delete request;
+}
+
+//------------------------------------------------------------------------
+// try_submit
+//------------------------------------------------------------------------
+// Queues a request and hands back the future of its result. Returns
+// false, without queuing anything, if the queue is full. The future is
+// taken before the request is queued, since a worker may finish and
+// delete the request as soon as it is in the queue.
+
+bool BatchingClassifier::try_submit( const Image& img,
+                                     std::future<Image>& result, int* index )
+{
+  Request* request = new Request;
+  request->query   = img;
+  request->index   = index;
+
+  std::future<Image> future = request->result.get_future();
+  if ( m_stop || !m_queue.try_push( request ) ) {
+    delete request;
+    m_rejected++;
+    return false;
+  }
+  result = std::move( future );
+  return true;
+}
+
+//------------------------------------------------------------------------
+// classify
+//------------------------------------------------------------------------
+// Submits a request and waits for its result. Throws InvalidArgument if
+// the queue is full.
+
+Image BatchingClassifier::classify( const Image& img )
+{
+  std::future<Image> result;
+  if ( !try_submit( img, result ) ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "too many requests are queued" );
+    throw e;
+  }
+  return result.get();
+}
+
+//------------------------------------------------------------------------
+// requests / batches / rejected
+//------------------------------------------------------------------------
+
+long long BatchingClassifier::requests() const
+{
+  return m_requests;
+}
+
+long long BatchingClassifier::batches() const
+{
+  return m_batches;
+}
+
+long long BatchingClassifier::rejected() const
+{
+  return m_rejected;
+}
+
+//------------------------------------------------------------------------
+// run_worker
+//------------------------------------------------------------------------
+// Takes a request, gathers more until the batch is full or the window
+// that started with the first request is over, and classifies them
+// together, handing back the training set index of each result to the
+// requests that asked for it. An exception from the HRS is passed on to
+// every request of the batch.
+
+void BatchingClassifier::run_worker()
+{
+  int idle = 0;
+  for ( ;; ) {
+    Request* first;
+    if ( !m_queue.try_pop( first ) ) {
+      if ( m_stop )
+        return;
+      if ( ++idle < idle_spins )
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(
+            std::chrono::microseconds( idle_sleep_us ) );
+      continue;
+    }
+    idle = 0;
+
+    std::vector<Request*> batch( 1, first );
+    long long             deadline = ece2400::timer_now_ns() + m_window_ns;
+    while ( (int) batch.size() < m_max_batch ) {
+      Request* request;
+      if ( m_queue.try_pop( request ) )
+        batch.push_back( request );
+      else if ( ece2400::timer_now_ns() >= deadline )
+        break;
+      else
+        std::this_thread::yield();
+    }
+
+    Vector<Image> queries;
+    queries.reserve( (int) batch.size() );
+    for ( size_t i = 0; i < batch.size(); i++ )
+      queries.push_back( batch[i]->query );
+
+    m_requests += (long long) batch.size();
+    m_batches++;
+
+    try {
+      Vector<int>   indices;
+      Vector<Image> results = m_hrs.classify_batch( queries, indices );
+      for ( size_t i = 0; i < batch.size(); i++ ) {
+        if ( batch[i]->index != nullptr )
+          *batch[i]->index = indices[(int) i];
+        batch[i]->result.set_value( results[(int) i] );
+      }
+    }
+    catch ( ... ) {
+      for ( size_t i = 0; i < batch.size(); i++ )
+        batch[i]->result.set_exception( std::current_exception() );
+    }
+
+    for ( size_t i = 0; i < batch.size(); i++ )
+      delete batch[i];
+  }
+}
@@ -0,0 +1,78 @@
+//========================================================================
+// BatchingClassifier.h
+//========================================================================
+// Declarations for serving classification requests from many threads.
+//
+// A BatchingClassifier puts the requests of any number of threads into
+// a BoundedQueue that a fixed pool of worker threads takes them from.
+// A worker that takes a request waits up to window_ns for more to
+// arrive, and classifies all of them (at most max_batch) with a single
+// classify_batch call. For an HRS that serves a batch with one pass over
+// its training set, e.g. a mapped HRSLinearSearch, that pass is shared
+// by every request that arrived within the window. Under overload the
+// queue fills up and try_submit fails immediately, so callers can turn
+// requests away instead of letting the queue, and the latency of every
+// request in it, grow without bound.
+//
+// Given an index, try_submit also hands back the position of the result
+// in the training set as classify_batch reports it (-1 if the HRS does
+// not keep track of it). The index is written before the result is
+// ready, so it has to stay valid until then.
+//
+// Idle workers poll the queue, yielding at first and then sleeping for
+// idle_sleep_us between polls. With more than one worker, the HRS must
+// allow classify_batch to be called from several threads at once.
+
+#ifndef BATCHING_CLASSIFIER_H
+#define BATCHING_CLASSIFIER_H
+
+#include "BoundedQueue.h"
+#include "Image.h"
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+class IHandwritingRecSys;
+
+class BatchingClassifier {
+ public:
+  BatchingClassifier( IHandwritingRecSys& hrs, int nworkers = 1,
+                      int capacity = 1024, int max_batch = 64,
+                      long long window_ns = 200000 );
+  ~BatchingClassifier();
+
+  // Methods
+  bool  try_submit( const Image& img, std::future<Image>& result,
+                    int* index = nullptr );
+  Image classify( const Image& img );
+
+  long long requests() const;
+  long long batches() const;
+  long long rejected() const;
+
+ private:
+  // Workers hold a pointer to the classifier, so it cannot be copied
+  BatchingClassifier( const BatchingClassifier& );
+  BatchingClassifier& operator=( const BatchingClassifier& );
+
+  struct Request {
+    Image               query;
+    std::promise<Image> result;
+    int*                index;
+  };
+
+  void run_worker();
+
+  IHandwritingRecSys&      m_hrs;
+  int                      m_max_batch;
+  long long                m_window_ns;
+  BoundedQueue<Request*>   m_queue;
+  std::vector<std::thread> m_workers;
+  std::atomic<bool>        m_stop;
+  std::atomic<long long>   m_requests;
+  std::atomic<long long>   m_batches;
+  std::atomic<long long>   m_rejected;
+};
+
+#endif  // BATCHING_CLASSIFIER_H
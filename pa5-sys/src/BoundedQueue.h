@@ -0,0 +1,60 @@
+//========================================================================
+// BoundedQueue.h
+//========================================================================
+// Declarations for a generic bounded lock-free queue.
+//
+// A BoundedQueue is a fixed-size ring buffer that any number of threads
+// may push to and pop from at the same time without locks (Dmitry
+// Vyukov's bounded MPMC queue). Every slot carries a sequence number
+// that says whether it is ready to be written or read in the current
+// lap around the ring, so a push or pop is one compare-and-swap on the
+// shared position plus one store to the slot. Neither call ever blocks:
+// try_push returns false when the queue is full and try_pop returns
+// false when it is empty, which leaves it to the caller to back off,
+// reject the value, or retry. The capacity is rounded up to a power of
+// two, and to at least two, which the sequence numbers need to tell a
+// full slot from an empty one.
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T>
+class BoundedQueue {
+ public:
+  BoundedQueue( int capacity );
+  ~BoundedQueue();
+
+  // Methods
+  int  capacity() const;
+  bool try_push( const T& value );
+  bool try_pop( T& value );
+
+ private:
+  // Queues are shared by reference, never copied
+  BoundedQueue( const BoundedQueue<T>& );
+  BoundedQueue<T>& operator=( const BoundedQueue<T>& );
+
+  struct Slot {
+    std::atomic<size_t> seq;
+    T                   value;
+  };
+
+  // The push and pop positions are kept on separate cache lines, so
+  // producers and consumers do not invalidate each other's line
+
+  Slot*               m_slots;
+  size_t              m_mask;
+  char                m_pad0[64];
+  std::atomic<size_t> m_push_pos;
+  char                m_pad1[64];
+  std::atomic<size_t> m_pop_pos;
+  char                m_pad2[64];
+};
+
+// Include inline definitions
+#include "BoundedQueue.inl"
+
+#endif /* BOUNDED_QUEUE_H */
@@ -0,0 +1,112 @@
+//========================================================================
+// BoundedQueue.inl
+//========================================================================
+// Implementation of BoundedQueue.
+
+#include "ece2400-stdlib.h"
+
+//------------------------------------------------------------------------
+// BoundedQueue
+//------------------------------------------------------------------------
+// Slot i starts with sequence number i, i.e., ready for the push at
+// position i.
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue( int capacity )
+{
+  if ( capacity < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "capacity must be positive" );
+    throw e;
+  }
+  size_t size = 2;
+  while ( size < (size_t) capacity ) {
+    size *= 2;
+  }
+  m_slots = new Slot[size];
+  for ( size_t i = 0; i < size; i++ ) {
+    m_slots[i].seq.store( i, std::memory_order_relaxed );
+  }
+  m_mask = size - 1;
+  m_push_pos.store( 0, std::memory_order_relaxed );
+  m_pop_pos.store( 0, std::memory_order_relaxed );
+}
+
+template <typename T>
+BoundedQueue<T>::~BoundedQueue()
+{
+  delete[] m_slots;
+}
+
+template <typename T>
+int BoundedQueue<T>::capacity() const
+{
+  return (int) ( m_mask + 1 );
+}
+
+//------------------------------------------------------------------------
+// try_push
+//------------------------------------------------------------------------
+// The slot at the push position is free when its sequence number equals
+// the position. A smaller one means the value from the previous lap has
+// not been popped yet, i.e., the queue is full. After writing, the
+// sequence number becomes position + 1, which marks the slot as ready
+// for the pop at this position.
+
+template <typename T>
+bool BoundedQueue<T>::try_push( const T& value )
+{
+  size_t pos = m_push_pos.load( std::memory_order_relaxed );
+  for ( ;; ) {
+    Slot&     slot = m_slots[pos & m_mask];
+    size_t    seq  = slot.seq.load( std::memory_order_acquire );
+    ptrdiff_t diff = (ptrdiff_t) seq - (ptrdiff_t) pos;
+    if ( diff == 0 ) {
+      if ( m_push_pos.compare_exchange_weak( pos, pos + 1,
+                                             std::memory_order_relaxed ) ) {
+        slot.value = value;
+        slot.seq.store( pos + 1, std::memory_order_release );
+        return true;
+      }
+    }
+    else if ( diff < 0 ) {
+      return false;
+    }
+    else {
+      pos = m_push_pos.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// try_pop
+//------------------------------------------------------------------------
+// The slot at the pop position holds a value when its sequence number is
+// position + 1; a smaller one means the queue is empty. After reading,
+// the sequence number moves a whole lap ahead, which frees the slot for
+// the push one lap later.
+
+template <typename T>
+bool BoundedQueue<T>::try_pop( T& value )
+{
+  size_t pos = m_pop_pos.load( std::memory_order_relaxed );
+  for ( ;; ) {
+    Slot&     slot = m_slots[pos & m_mask];
+    size_t    seq  = slot.seq.load( std::memory_order_acquire );
+    ptrdiff_t diff = (ptrdiff_t) seq - (ptrdiff_t) ( pos + 1 );
+    if ( diff == 0 ) {
+      if ( m_pop_pos.compare_exchange_weak( pos, pos + 1,
+                                            std::memory_order_relaxed ) ) {
+        value = slot.value;
+        slot.seq.store( pos + m_mask + 1, std::memory_order_release );
+        return true;
+      }
+    }
+    else if ( diff < 0 ) {
+      return false;
+    }
+    else {
+      pos = m_pop_pos.load( std::memory_order_relaxed );
+    }
+  }
+}
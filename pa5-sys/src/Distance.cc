@@ -0,0 +1,124 @@
+//========================================================================
+// Distance.cc
+//========================================================================
+// Implementations of the distance functors that are not inlined.
+
+#include "Distance.h"
+#include <climits>
+#include <cmath>
+
+//------------------------------------------------------------------------
+// CascadeDistance
+//------------------------------------------------------------------------
+
+CascadeDistance::CascadeDistance()
+{
+  m_best = INT_MAX;
+}
+
+int CascadeDistance::operator()( const Image& a, const Image& b )
+{
+  int d = a.distance_within( b, m_best );
+  if ( d < m_best )
+    m_best = d;
+  return d;
+}
+
+//------------------------------------------------------------------------
+// TangentDistance
+//------------------------------------------------------------------------
+// With the difference d = b - a and the tangent vectors as the columns
+// of T, the closest image is at alpha = ( T'T + ridge I )^-1 T'd, and
+// its squared distance is d'd - (T'd)' alpha. The small ridge keeps the
+// system solvable when the tangents are (close to) dependent, e.g. for
+// a blank image, where all of them are zero and the distance is the
+// euclidean one. Everything is summed in one pass over the pixels, so
+// the tangents are never stored.
+
+const int    tangent_count = 4;
+const double tangent_ridge = 1.0;
+
+// Solves m x = rhs in place for a symmetric positive definite m with a
+// Cholesky decomposition
+static void solve_spd( double m[tangent_count][tangent_count], double* rhs )
+{
+  for ( int j = 0; j < tangent_count; j++ ) {
+    for ( int k = 0; k < j; k++ )
+      m[j][j] -= m[j][k] * m[j][k];
+    m[j][j] = std::sqrt( m[j][j] );
+    for ( int i = j + 1; i < tangent_count; i++ ) {
+      for ( int k = 0; k < j; k++ )
+        m[i][j] -= m[i][k] * m[j][k];
+      m[i][j] /= m[j][j];
+    }
+  }
+  for ( int i = 0; i < tangent_count; i++ ) {
+    for ( int k = 0; k < i; k++ )
+      rhs[i] -= m[i][k] * rhs[k];
+    rhs[i] /= m[i][i];
+  }
+  for ( int i = tangent_count - 1; i >= 0; i-- ) {
+    for ( int k = i + 1; k < tangent_count; k++ )
+      rhs[i] -= m[k][i] * rhs[k];
+    rhs[i] /= m[i][i];
+  }
+}
+
+int TangentDistance::operator()( const Image& a, const Image& b ) const
+{
+  begin_distance( a, b );
+  int        ncols = a.get_ncols();
+  int        nrows = a.get_nrows();
+  const int* pa    = a.pixels();
+  const int* pb    = b.pixels();
+  double     cx    = ( ncols - 1 ) / 2.0;
+  double     cy    = ( nrows - 1 ) / 2.0;
+
+  double tt[tangent_count][tangent_count] = { { 0.0 } };
+  double td[tangent_count]                = { 0.0 };
+  double dd                               = 0.0;
+
+  for ( int y = 0; y < nrows; y++ ) {
+    for ( int x = 0; x < ncols; x++ ) {
+      int i = y * ncols + x;
+
+      // Central differences, reading pixels outside of the image as zero
+      int    left  = ( x > 0 ) ? pa[i - 1] : 0;
+      int    right = ( x < ncols - 1 ) ? pa[i + 1] : 0;
+      int    up    = ( y > 0 ) ? pa[i - ncols] : 0;
+      int    down  = ( y < nrows - 1 ) ? pa[i + ncols] : 0;
+      double gx    = 0.5 * ( right - left );
+      double gy    = 0.5 * ( down - up );
+      double px    = x - cx;
+      double py    = y - cy;
+
+      double t[tangent_count] = { gx, gy, py * gx - px * gy,
+                                  px * gx + py * gy };
+      double d                = pb[i] - pa[i];
+
+      dd += d * d;
+      for ( int j = 0; j < tangent_count; j++ ) {
+        td[j] += t[j] * d;
+        for ( int k = 0; k <= j; k++ )
+          tt[j][k] += t[j] * t[k];
+      }
+    }
+  }
+
+  for ( int j = 0; j < tangent_count; j++ )
+    tt[j][j] += tangent_ridge;
+
+  double alpha[tangent_count];
+  for ( int j = 0; j < tangent_count; j++ )
+    alpha[j] = td[j];
+  solve_spd( tt, alpha );
+
+  double dist = dd;
+  for ( int j = 0; j < tangent_count; j++ )
+    dist -= td[j] * alpha[j];
+  if ( dist < 0.0 )
+    dist = 0.0;
+  if ( dist > dd )
+    dist = dd;
+  return (int) ( dist + 0.5 );
+}
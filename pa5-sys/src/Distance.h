@@ -0,0 +1,113 @@
+//========================================================================
+// Distance.h
+//========================================================================
+// Distance functions for Images.
+//
+// Every search takes its distance function as a template parameter
+// (DistFunc of find_closest_linear, find_closest_binary,
+// parallel_linear_search, Tree::find_closest and VPTree), so passing one
+// of the functors below compiles a separate search for that metric, with
+// the pixel loop of the metric inlined into it. Switching metrics costs
+// no virtual or function pointer call per distance.
+//
+// - L2Distance        : squared euclidean distance, i.e., Image::distance
+// - CascadeDistance   : the same distances, cut short once they cannot
+//                       beat the closest one so far
+// - L1Distance        : sum of the absolute pixel differences
+// - ChebyshevDistance : largest absolute pixel difference
+// - CosineDistance    : one minus the cosine of the angle between the
+//                       images, scaled by cosine_scale
+// - TangentDistance   : squared euclidean distance from the second image
+//                       to the plane of small shifts, rotations and
+//                       scalings of the first one
+//
+// All of them return ints, count as one distance each (see
+// HRSStats), and throw InvalidArgument if the
+// images have different dimensions. L1Distance and ChebyshevDistance are
+// metrics, so they can also be used by VPTree; the others do not obey
+// the triangle inequality.
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include "Image.h"
+
+//------------------------------------------------------------------------
+// L2Distance
+//------------------------------------------------------------------------
+
+class L2Distance {
+ public:
+  int operator()( const Image& a, const Image& b ) const;
+};
+
+//------------------------------------------------------------------------
+// CascadeDistance
+//------------------------------------------------------------------------
+// Distance function for searches that keep the closest value seen so
+// far and only replace it with a strictly closer one, such as
+// find_closest_linear. It remembers the smallest distance it returned
+// and cuts every later distance short with distance_within, so values
+// that cannot be closer cost a few region sums instead of every pixel,
+// and the closest value found stays exactly the same. A fresh one has to
+// be used for every search.
+
+class CascadeDistance {
+ public:
+  CascadeDistance();
+  int operator()( const Image& a, const Image& b );
+
+ private:
+  int m_best;
+};
+
+//------------------------------------------------------------------------
+// L1Distance / ChebyshevDistance
+//------------------------------------------------------------------------
+
+class L1Distance {
+ public:
+  int operator()( const Image& a, const Image& b ) const;
+};
+
+class ChebyshevDistance {
+ public:
+  int operator()( const Image& a, const Image& b ) const;
+};
+
+//------------------------------------------------------------------------
+// CosineDistance
+//------------------------------------------------------------------------
+// Brightness does not matter: an image and the same image at half the
+// brightness are at distance 0. A blank image is at distance
+// cosine_scale from every other image and at 0 from another blank one.
+
+const int cosine_scale = 1 << 20;
+
+class CosineDistance {
+ public:
+  int operator()( const Image& a, const Image& b ) const;
+};
+
+//------------------------------------------------------------------------
+// TangentDistance
+//------------------------------------------------------------------------
+// One-sided tangent distance (Simard et al., "Efficient pattern
+// recognition using a new transformation distance", NIPS 1992). The
+// tangent vectors of the first image, i.e., the changes of its pixels
+// under a small shift along x and along y, a small rotation and a small
+// scaling about the center, are estimated from central differences, and
+// the distance is the squared euclidean distance from the second image
+// to the closest image a + T alpha. This is a linear approximation, so
+// it only forgives small transformations. It is never more than the
+// squared euclidean distance.
+
+class TangentDistance {
+ public:
+  int operator()( const Image& a, const Image& b ) const;
+};
+
+// Include inline definitions
+#include "Distance.inl"
+
+#endif  // DISTANCE_H
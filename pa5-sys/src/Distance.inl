@@ -0,0 +1,105 @@
+//========================================================================
+// Distance.inl
+//========================================================================
+// Inline definitions of the distance functors. Their pixel loops are
+// simple reductions over two arrays, which the compiler vectorizes once
+// they are inlined into a search.
+
+#include "HRSStats.h"
+#include "ece2400-stdlib.h"
+#include <cmath>
+#include <cstddef>
+
+//------------------------------------------------------------------------
+// begin_distance
+//------------------------------------------------------------------------
+// Throws InvalidArgument unless the images have the same dimensions,
+// counts one distance that reads the pixels of both, and returns the
+// number of pixels.
+
+inline int begin_distance( const Image& a, const Image& b )
+{
+  if ( a.get_ncols() != b.get_ncols() || a.get_nrows() != b.get_nrows() ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "dimensions of images do not match" );
+    throw e;
+  }
+  int size = a.get_ncols() * a.get_nrows();
+  HRS_STATS_ADD( distance_calls, 1 );
+  HRS_STATS_ADD( bytes_touched, (size_t) size * sizeof( int ) );
+  return size;
+}
+
+//------------------------------------------------------------------------
+// L2Distance
+//------------------------------------------------------------------------
+
+inline int L2Distance::operator()( const Image& a, const Image& b ) const
+{
+  return a.distance( b );
+}
+
+//------------------------------------------------------------------------
+// L1Distance
+//------------------------------------------------------------------------
+
+inline int L1Distance::operator()( const Image& a, const Image& b ) const
+{
+  int        size  = begin_distance( a, b );
+  const int* pa    = a.pixels();
+  const int* pb    = b.pixels();
+  int        total = 0;
+  for ( int i = 0; i < size; i++ ) {
+    int diff = pa[i] - pb[i];
+    total += ( diff < 0 ) ? -diff : diff;
+  }
+  return total;
+}
+
+//------------------------------------------------------------------------
+// ChebyshevDistance
+//------------------------------------------------------------------------
+
+inline int ChebyshevDistance::operator()( const Image& a,
+                                          const Image& b ) const
+{
+  int        size    = begin_distance( a, b );
+  const int* pa      = a.pixels();
+  const int* pb      = b.pixels();
+  int        largest = 0;
+  for ( int i = 0; i < size; i++ ) {
+    int diff = pa[i] - pb[i];
+    diff     = ( diff < 0 ) ? -diff : diff;
+    largest  = ( diff > largest ) ? diff : largest;
+  }
+  return largest;
+}
+
+//------------------------------------------------------------------------
+// CosineDistance
+//------------------------------------------------------------------------
+// The dot product and both squared norms are summed in one pass.
+
+inline int CosineDistance::operator()( const Image& a, const Image& b ) const
+{
+  int        size = begin_distance( a, b );
+  const int* pa   = a.pixels();
+  const int* pb   = b.pixels();
+  long long  dot  = 0;
+  long long  na   = 0;
+  long long  nb   = 0;
+  for ( int i = 0; i < size; i++ ) {
+    dot += (long long) ( pa[i] * pb[i] );
+    na += (long long) ( pa[i] * pa[i] );
+    nb += (long long) ( pb[i] * pb[i] );
+  }
+
+  if ( na == 0 || nb == 0 )
+    return ( na == nb ) ? 0 : cosine_scale;
+
+  double cosine = (double) dot / std::sqrt( (double) na * (double) nb );
+  double dist   = ( 1.0 - cosine ) * cosine_scale;
+  if ( dist < 0.0 )
+    dist = 0.0;
+  return (int) ( dist + 0.5 );
+}
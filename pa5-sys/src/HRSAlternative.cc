@@ -5,97 +5,287 @@
 
 #include "HRSAlternative.h"
 #include "IHandwritingRecSys.h"
+#include "Distance.h"
 #include "Image.h"
 #include "Vector.h"
+#include "Numa.h"
+#include "mnist-utils.h"
 #include <cstddef>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 //------------------------------------------------------------------------
 // HRSAlternative
 //------------------------------------------------------------------------
 // The default constructor for the HRSAlternative class
-HRSAlternative::HRSAlternative()
+
+HRSAlternative::HRSAlternative( int nworkers )
 {
-  m_vimage = Vector<Image>();
+  if ( nworkers < 0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "number of workers must not be negative" );
+    throw e;
+  }
+  m_nworkers = nworkers;
+  m_size     = 0;
+  m_job      = job_stop;
+  m_round    = 0;
+  m_pending  = 0;
+  m_append   = nullptr;
+  m_query    = nullptr;
 }
 
 //------------------------------------------------------------------------
-// train
+// ~HRSAlternative
 //------------------------------------------------------------------------
-// A function that sets the array of the HRSAlternative equal to the
-// given vector
+// Stops the workers before their slices go away
 
-void HRSAlternative::train( const Vector<Image>& vec )
+HRSAlternative::~HRSAlternative()
 {
-  m_vimage = vec;
+  stop_workers();
 }
 
-// Distance Function for Images
-int distance_euclidean( const Image& a, const Image& b )
+//------------------------------------------------------------------------
+// start_workers / stop_workers
+//------------------------------------------------------------------------
+// Starts one worker per slice, or none with a single slice, and stops
+// them again. A worker starts out having seen the current round, so it
+// waits for the next job.
+
+void HRSAlternative::start_workers()
 {
-  return a.distance( b );
+  size_t nslices = m_slices.size();
+  m_best_idx     = std::vector<int>( nslices, -1 );
+  m_best_dist    = std::vector<double>( nslices, 0.0 );
+  m_worker_stats = std::vector<HRSStats>( nslices );
+  m_errors       = std::vector<std::exception_ptr>( nslices );
+
+  if ( nslices == 1 )
+    return;
+  for ( size_t k = 0; k < nslices; k++ )
+    m_workers.push_back(
+        std::thread( &HRSAlternative::run_worker, this, (int) k, m_round ) );
+}
+
+void HRSAlternative::stop_workers()
+{
+  if ( m_workers.empty() )
+    return;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_job = job_stop;
+    m_round++;
+  }
+  m_job_ready.notify_all();
+  for ( size_t k = 0; k < m_workers.size(); k++ )
+    m_workers[k].join();
+  m_workers.clear();
 }
 
 //------------------------------------------------------------------------
-// linear_search
+// run_job
 //------------------------------------------------------------------------
-// A function that returns the closest value in the Vector's array to the
-// given value using a linear search
-void linear_search( const Vector<Image>& vec, Image* store_data,
-                    const Image& value, int begin, int end )
+// Runs a job on every slice and waits for all of them, then rethrows
+// the first exception a worker ran into. Without workers the calling
+// thread runs the job on the only slice itself. The caller must hold
+// m_job_mutex.
+
+void HRSAlternative::run_job( Job job )
 {
-  int smallestdiff = distance_euclidean( value, vec[0] );
-  int sdidx        = begin;
-  for ( int i = begin + 1; i < end; i++ ) {
-    int absv = distance_euclidean( value, vec[i] );
-    if ( smallestdiff > absv ) {
-      smallestdiff = absv;
-      sdidx        = i;
+  size_t nslices = m_slices.size();
+  for ( size_t k = 0; k < nslices; k++ )
+    m_errors[k] = nullptr;
+
+  if ( m_workers.empty() ) {
+    do_job( job, 0 );
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_job     = job;
+    m_pending = (int) nslices;
+    m_round++;
+    m_job_ready.notify_all();
+    m_job_done.wait( lock, [this]() { return m_pending == 0; } );
+  }
+
+  for ( size_t k = 0; k < nslices; k++ ) {
+    if ( m_errors[k] )
+      std::rethrow_exception( m_errors[k] );
+  }
+}
+
+//------------------------------------------------------------------------
+// run_worker
+//------------------------------------------------------------------------
+// The loop of worker k, which pins itself to the CPU of its slice once
+// and then runs every job handed out after the given round
+
+void HRSAlternative::run_worker( int k, long long round )
+{
+  pin_thread( m_cpus[(size_t) k] );
+  while ( true ) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_job_ready.wait( lock, [&]() { return m_round != round; } );
+      round = m_round;
+      job   = m_job;
+    }
+    if ( job == job_stop )
+      return;
+
+    try {
+      do_job( job, k );
+    }
+    catch ( ... ) {
+      m_errors[(size_t) k] = std::current_exception();
     }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( --m_pending == 0 )
+      m_job_done.notify_one();
   }
-  *store_data = vec[sdidx];
 }
 
-Image parallel_linear_search( const Vector<Image>& vec, const Image& value )
+//------------------------------------------------------------------------
+// do_job
+//------------------------------------------------------------------------
+// Runs a job on slice k. job_append appends the k-th of nslices
+// contiguous pieces of m_append to the slice, so the copies are
+// allocated and first touched on the node of the slice's worker.
+// job_search searches the slice for m_query and records what it
+// counted, so the thread that handed out the job can add it.
+
+void HRSAlternative::do_job( Job job, int k )
 {
-  if ( vec.size() == 0 ) {
-    ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
-    throw e;
+  size_t         s       = (size_t) k;
+  Vector<Image>& slice   = m_slices[s];
+  int            nslices = (int) m_slices.size();
+
+  if ( job == job_append ) {
+    const Vector<Image>& vec = *m_append;
+    int begin = (int) ( (long long) vec.size() * k / nslices );
+    int end   = (int) ( (long long) vec.size() * ( k + 1 ) / nslices );
+    slice.reserve( slice.size() + end - begin );
+    for ( int i = begin; i < end; i++ )
+      slice.push_back( vec[i] );
   }
-  int mid1 = vec.size() / 4;
-  int mid2 = vec.size() / 2;
-  int mid3 = 3 * ( vec.size() / 4 );
-
-  Image       store_data[4];
-  std::thread thread0( &linear_search, vec, &store_data[0], value, 0, mid1 );
-  std::thread thread1( &linear_search, vec, &store_data[1], value, mid1, mid2 );
-  std::thread thread2( &linear_search, vec, &store_data[2], value, mid2, mid3 );
-  linear_search( vec, &store_data[3], value, mid3, vec.size() );
-
-  thread0.join();
-  thread1.join();
-  thread2.join();
-
-  int   smallest_dist = distance_euclidean( store_data[3], value );
-  Image smallest      = store_data[3];
-  for ( int i = 0; i < 3; i++ ) {
-    int distance = distance_euclidean( store_data[i], value );
-    if ( distance < smallest_dist ) {
-      smallest      = store_data[i];
-      smallest_dist = distance;
-    }
+  else if ( job == job_search ) {
+    HRSStats start = hrs_stats_local();
+    m_best_idx[s]  = -1;
+    if ( slice.size() > 0 )
+      linear_search_chunk( &slice[0], 0, slice.size(), *m_query,
+                           CascadeDistance(), &m_best_idx[s],
+                           &m_best_dist[s] );
+    m_worker_stats[s] = hrs_stats_since( start );
+  }
+}
+
+//------------------------------------------------------------------------
+// fill_slices
+//------------------------------------------------------------------------
+// Appends one contiguous piece of vec to every slice, each copied by
+// the slice's worker
+
+void HRSAlternative::fill_slices( const Vector<Image>& vec )
+{
+  std::lock_guard<std::mutex> lock( m_job_mutex );
+  m_append = &vec;
+  run_job( job_append );
+  m_append = nullptr;
+  m_size += vec.size();
+}
+
+//------------------------------------------------------------------------
+// train
+//------------------------------------------------------------------------
+// A function that sets the array of the HRSAlternative equal to the
+// given vector, with duplicate images collapsed into one, and splits it
+// into the slices of a new set of workers
+
+void HRSAlternative::train( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  Vector<Image> images = dedup_images( vec );
+
+  int nslices = m_nworkers;
+  if ( nslices == 0 ) {
+    std::vector<std::vector<int>> nodes = numa_node_cpus();
+    for ( size_t i = 0; i < nodes.size(); i++ )
+      nslices += (int) nodes[i].size();
+    if ( nslices > images.size() / parallel_min_chunk )
+      nslices = images.size() / parallel_min_chunk;
   }
+  if ( nslices > images.size() )
+    nslices = images.size();
+  if ( nslices < 1 )
+    nslices = 1;
 
-  return smallest;
+  stop_workers();
+  m_cpus   = numa_worker_cpus( nslices );
+  m_slices = std::vector<Vector<Image>>( (size_t) nslices );
+  m_size   = 0;
+  start_workers();
+  fill_slices( images );
+}
+
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// A function that appends the given images to the training set, spread
+// over the slices of the workers
+
+void HRSAlternative::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  if ( m_size == 0 ) {
+    train( vec );
+    return;
+  }
+  fill_slices( dedup_images( vec ) );
 }
 
 //------------------------------------------------------------------------
 // classify
 //------------------------------------------------------------------------
-// A function that finds the closest Image to the given Image using linear
-// search method
+// A function that finds the closest Image to the given Image using a
+// linear search split across the workers. Every worker searches its own
+// slice from its own CPU and hands its stats back to the calling
+// thread; ties go to the lowest slice.
 
 Image HRSAlternative::classify( const Image& img )
 {
-  return parallel_linear_search( m_vimage, img );
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  if ( m_size == 0 ) {
+    ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
+    throw e;
+  }
+
+  HRS_STATS_ADD( candidates, m_size );
+
+  std::lock_guard<std::mutex> lock( m_job_mutex );
+  m_query = &img;
+  run_job( job_search );
+  m_query = nullptr;
+
+  size_t nslices = m_slices.size();
+  if ( !m_workers.empty() ) {
+    for ( size_t k = 0; k < nslices; k++ )
+      hrs_stats_local() += m_worker_stats[k];
+  }
+
+  size_t best = nslices;
+  for ( size_t k = 0; k < nslices; k++ ) {
+    if ( m_best_idx[k] >= 0 &&
+         ( best == nslices || m_best_dist[k] < m_best_dist[best] ) )
+      best = k;
+  }
+  return m_slices[best][m_best_idx[best]];
 }
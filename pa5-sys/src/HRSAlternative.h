@@ -8,6 +8,11 @@
 
 #include "IHandwritingRecSys.h"
 #include "Vector.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 // Here we use forward declaration instead of #include. Forward
 // declaration is a declaration of an identifier (type, variable, or
@@ -23,8 +28,22 @@
 class Image;
 
 //------------------------------------------------------------------------
-// HRSLinearSearch
+// HRSAlternative
 //------------------------------------------------------------------------
+// Linear search split across worker threads, one per usable CPU by
+// default. The training set is partitioned into one contiguous slice
+// per worker, and every worker is pinned to a CPU spread over the NUMA
+// nodes (see numa_worker_cpus). The workers are started by train and
+// live until the next train or the end of the HRS. A worker pins itself
+// once and then copies its slice itself, so its pages are first
+// touched, and thus placed, on the node it searches them from; classify
+// hands the query to the waiting workers and reads local memory only.
+// Queries from several threads take turns, each using every worker.
+// Without an explicit number of workers, a worker gets no fewer than
+// parallel_min_chunk images, so small sets are searched by the calling
+// thread alone. Added samples are spread over the slices, so only ties
+// between them and other images may go differently from
+// HRSLinearSearch.
 
 class HRSAlternative : public IHandwritingRecSys {
  public:
@@ -33,9 +52,11 @@ class HRSAlternative : public IHandwritingRecSys {
   // constructors. Note that you may need to change the evaluation program
   // if you do so.
   //''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
-  HRSAlternative();
+  HRSAlternative( int nworkers = 0 );
+  ~HRSAlternative();
 
   void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
   Image classify( const Image& img );
 
  private:
@@ -44,7 +65,41 @@ class HRSAlternative : public IHandwritingRecSys {
   // according to our naming convention, data member's name should starts
   // with a `m_` prefix.
   //''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
-  Vector<Image> m_vimage;
+  // Workers hold a pointer to the HRS, so it cannot be copied
+  HRSAlternative( const HRSAlternative& );
+  HRSAlternative& operator=( const HRSAlternative& );
+
+  enum Job { job_append, job_search, job_stop };
+
+  void start_workers();
+  void stop_workers();
+  void run_job( Job job );
+  void run_worker( int k, long long round );
+  void do_job( Job job, int k );
+  void fill_slices( const Vector<Image>& vec );
+
+  int                        m_nworkers;  // 0 to pick by size
+  std::vector<int>           m_cpus;      // CPU of every slice's worker
+  std::vector<Vector<Image>> m_slices;
+  int                        m_size;
+
+  // Worker pool, empty with a single slice. m_job_mutex is held by the
+  // thread that hands out a job until it has read its results, and
+  // m_mutex guards the job and the round it was handed out in.
+  std::vector<std::thread>        m_workers;
+  std::mutex                      m_job_mutex;
+  std::mutex                      m_mutex;
+  std::condition_variable         m_job_ready;
+  std::condition_variable         m_job_done;
+  Job                             m_job;
+  long long                       m_round;    // bumped for every job
+  int                             m_pending;  // workers still busy
+  const Vector<Image>*            m_append;   // input of job_append
+  const Image*                    m_query;    // input of job_search
+  std::vector<int>                m_best_idx;
+  std::vector<double>             m_best_dist;
+  std::vector<HRSStats>           m_worker_stats;
+  std::vector<std::exception_ptr> m_errors;
 };
 
 #endif
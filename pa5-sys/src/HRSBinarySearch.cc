@@ -5,10 +5,16 @@
 
 #include "HRSBinarySearch.h"
 #include "IHandwritingRecSys.h"
+#include "Distance.h"
 #include "Image.h"
 #include "Vector.h"
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 //------------------------------------------------------------------------
 // HRSBinarySearch
@@ -20,9 +26,12 @@ HRSBinarySearch::HRSBinarySearch( int k )
   m_k      = k;
 }
 
-// Image compare function
-bool less_intensity( const Image& a, const Image& b )
+// Image compare function: orders images along the curve of
+// Image::curve_key, breaking ties by intensity
+static bool less_key( const Image& a, const Image& b )
 {
+  if ( a.curve_key() != b.curve_key() )
+    return a.curve_key() < b.curve_key();
   return a.get_intensity() < b.get_intensity();
 }
 
@@ -30,19 +39,112 @@ bool less_intensity( const Image& a, const Image& b )
 // train
 //------------------------------------------------------------------------
 // A function that sets the array of the HRSBinarySearch equal to the
-// given vector
+// given vector, with duplicate images collapsed into one
 
 void HRSBinarySearch::train( const Vector<Image>& vec )
 {
-  m_vimage = vec;
-  m_vimage.sort( less_intensity );
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  m_vimage = dedup_images( vec );
+  m_vimage.sort( less_key );
   printf( "finished sort\n" );
 }
 
-// Distance Function for Images
-int distance_euclidean( const Image& a, const Image& b )
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// A function that sorts the new images on their own and merges them into
+// the already sorted training set, instead of sorting everything again.
+// The merge works backwards from the end of the grown vector, so only
+// the training images that sort after the first new image have to move.
+
+void HRSBinarySearch::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  Vector<Image> batch = dedup_images( vec );
+  batch.sort( less_key );
+
+  int i = m_vimage.size() - 1;
+  int j = batch.size() - 1;
+  for ( int k = 0; k < batch.size(); k++ ) {
+    m_vimage.push_back( batch[k] );
+  }
+
+  int k = m_vimage.size() - 1;
+  while ( j >= 0 && i >= 0 ) {
+    if ( less_key( batch[j], m_vimage[i] ) ) {
+      m_vimage[k--] = std::move( m_vimage[i--] );
+    }
+    else {
+      m_vimage[k--] = std::move( batch[j--] );
+    }
+  }
+  while ( j >= 0 ) {
+    m_vimage[k--] = std::move( batch[j--] );
+  }
+}
+
+//------------------------------------------------------------------------
+// set_k
+//------------------------------------------------------------------------
+
+void HRSBinarySearch::set_k( int k )
 {
-  return a.distance( b );
+  if ( k < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "K must be positive" );
+    throw e;
+  }
+  m_k = k;
+}
+
+//------------------------------------------------------------------------
+// train_stream
+//------------------------------------------------------------------------
+// Merging every batch into the training set with add_samples would move
+// the whole training set once per batch. Instead, each batch is sorted
+// on its own and appended as a run, and neighboring runs are merged in
+// pairs until a single run is left, so every image only moves a number
+// of times logarithmic in the number of batches. Duplicates are only
+// collapsed within a batch.
+
+void HRSBinarySearch::train_stream( LabeledImageStream& stream,
+                                    int                 batch_size )
+{
+  ECE2400_PROFILE_SCOPE( "train_stream" );
+
+  m_vimage = Vector<Image>();
+  m_vimage.reserve( stream.size() );
+
+  std::vector<int> runs;  // start of every run, and the end of the last
+
+  Vector<Image> batch;
+  while ( stream.next_batch( batch, batch_size ) ) {
+    Vector<Image> run = dedup_images( batch );
+    run.sort( less_key );
+    runs.push_back( m_vimage.size() );
+    for ( int i = 0; i < run.size(); i++ ) {
+      m_vimage.push_back( run[i] );
+    }
+  }
+  runs.push_back( m_vimage.size() );
+
+  ECE2400_PROFILE_SCOPE( "merge" );
+  while ( runs.size() > 2 ) {
+    Image*           base   = &m_vimage[0];
+    size_t           n_runs = runs.size() - 1;
+    std::vector<int> merged;
+    for ( size_t j = 0; j < n_runs; j += 2 ) {
+      merged.push_back( runs[j] );
+      if ( j + 1 < n_runs ) {
+        std::inplace_merge( base + runs[j], base + runs[j + 1],
+                            base + runs[j + 2], less_key );
+      }
+    }
+    merged.push_back( runs[n_runs] );
+    runs.swap( merged );
+  }
 }
 
 //------------------------------------------------------------------------
@@ -52,6 +154,9 @@ int distance_euclidean( const Image& a, const Image& b )
 // search method
 Image HRSBinarySearch::classify( const Image& img )
 {
-  return m_vimage.find_closest_binary( img, m_k, distance_euclidean,
-                                       less_intensity );
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  return m_vimage.find_closest_binary( img, m_k, CascadeDistance(),
+                                       less_key );
 }
\ No newline at end of file
@@ -31,8 +31,15 @@ class HRSBinarySearch : public IHandwritingRecSys {
   HRSBinarySearch( int K = 1000 );
 
   void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
   Image classify( const Image& img );
 
+  void train_stream( LabeledImageStream& stream, int batch_size );
+
+  // Number of training images the final linear search looks at. Can be
+  // changed after training.
+  void set_k( int K );
+
  private:
   Vector<Image> m_vimage;
   int           m_k;
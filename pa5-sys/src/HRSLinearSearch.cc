@@ -4,35 +4,105 @@
 // Handwritten recognition system that uses linear search.
 
 #include "HRSLinearSearch.h"
+#include "Distance.h"
 #include "Image.h"
+#include "mnist-utils.h"
+#include <climits>
 #include <cstddef>
 #include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+// A mapped training set is scanned in chunks of about scan_chunk_bytes
+// of pixels, with the next scan_readahead chunks prefetched. Within a
+// chunk, queries are compared in blocks of scan_query_block so that the
+// pixels of a block of queries stay in the cache while the chunk is
+// streamed past them.
+
+const size_t scan_chunk_bytes = 4 << 20;
+const int    scan_readahead   = 2;
+const int    scan_query_block = 64;
+
+// Sizes of the IDX headers in front of the pixels and labels
+
+const size_t idx_images_header = 16;
+const size_t idx_labels_header = 8;
 
 //------------------------------------------------------------------------
 // HRSLinearSearch
 //------------------------------------------------------------------------
 // The default constructor for the HRSLinearSearch class
 
-HRSLinearSearch::HRSLinearSearch()
+HRSLinearSearch::HRSLinearSearch( bool condense )
 {
-  m_vimage = Vector<Image>();
+  m_vimage      = Vector<Image>();
+  m_condense    = condense;
+  m_images_map  = nullptr;
+  m_images_len  = 0;
+  m_labels_map  = nullptr;
+  m_labels_len  = 0;
+  m_pixels      = nullptr;
+  m_labels      = nullptr;
+  m_mapped_size = 0;
+  m_ncols       = 0;
+  m_nrows       = 0;
+}
+
+HRSLinearSearch::~HRSLinearSearch()
+{
+  unmap_training_set();
 }
 
 //------------------------------------------------------------------------
 // train
 //------------------------------------------------------------------------
 // A function that sets the array of the HRSLinearSearch equal to the
-// given vector
+// given vector, with duplicate images collapsed into one, and condensed
+// into prototypes if requested
 
 void HRSLinearSearch::train( const Vector<Image>& vec )
 {
-  m_vimage = vec;
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  unmap_training_set();
+  m_vimage = dedup_images( vec );
+  if ( m_condense ) {
+    m_vimage = condense_images( m_vimage );
+  }
 }
 
-// Distance Function for Images
-int distance_euclidean( const Image& a, const Image& b )
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// A function that appends the given images to the training set. When
+// condensing, only the images the current prototypes misclassify are
+// added.
+
+void HRSLinearSearch::add_samples( const Vector<Image>& vec )
 {
-  return a.distance( b );
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  if ( m_pixels != nullptr ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "cannot add samples to a mapped training set" );
+    throw e;
+  }
+
+  Vector<Image> batch = dedup_images( vec );
+  if ( m_condense ) {
+    condense_images_into( batch, m_vimage );
+    return;
+  }
+  for ( int i = 0; i < batch.size(); i++ ) {
+    m_vimage.push_back( batch[i] );
+  }
 }
 
 //------------------------------------------------------------------------
@@ -43,5 +113,276 @@ int distance_euclidean( const Image& a, const Image& b )
 
 Image HRSLinearSearch::classify( const Image& img )
 {
-  return m_vimage.find_closest_linear( img, distance_euclidean );
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  if ( m_pixels != nullptr ) {
+    Vector<Image> queries;
+    queries.push_back( img );
+    return scan_mapped( queries )[0];
+  }
+  return m_vimage.find_closest_linear( img, CascadeDistance() );
+}
+
+//------------------------------------------------------------------------
+// classify_batch
+//------------------------------------------------------------------------
+// Returns the closest training image of every query, and given
+// indices, the index of every result in the mapped files. A mapped
+// training set is scanned once for the whole batch; otherwise this is
+// the same as classifying the queries one at a time.
+
+Vector<Image> HRSLinearSearch::classify_batch( const Vector<Image>& queries )
+{
+  ECE2400_PROFILE_SCOPE( "classify_batch" );
+
+  if ( m_pixels == nullptr )
+    return IHandwritingRecSys::classify_batch( queries );
+
+  HRSStatsScope stats_scope( m_stats, queries.size() );
+  return scan_mapped( queries );
+}
+
+Vector<Image> HRSLinearSearch::classify_batch( const Vector<Image>& queries,
+                                               Vector<int>&         indices )
+{
+  ECE2400_PROFILE_SCOPE( "classify_batch" );
+
+  if ( m_pixels == nullptr )
+    return IHandwritingRecSys::classify_batch( queries, indices );
+
+  HRSStatsScope stats_scope( m_stats, queries.size() );
+  return scan_mapped( queries, &indices );
+}
+
+//------------------------------------------------------------------------
+// map_training_set
+//------------------------------------------------------------------------
+// Replaces the training set with the first size images (all of them if
+// size is negative) of the given IDX files, mapped read-only. Throws
+// InvalidArgument if the files cannot be mapped, are not IDX files,
+// hold different numbers of images and labels, or are shorter than
+// their headers say.
+
+static void* map_file( const std::string& path, size_t& len )
+{
+  int fd = open( path.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    return nullptr;
+
+  struct stat st;
+  void*       map = MAP_FAILED;
+  if ( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+    len = (size_t) st.st_size;
+    map = mmap( nullptr, len, PROT_READ, MAP_SHARED, fd, 0 );
+  }
+
+  // The mapping keeps the file open
+  close( fd );
+  return ( map == MAP_FAILED ) ? nullptr : map;
+}
+
+static int load_be32( const unsigned char* bytes )
+{
+  return (int) ( ( (unsigned) bytes[0] << 24 ) | ( (unsigned) bytes[1] << 16 ) |
+                 ( (unsigned) bytes[2] << 8 ) | (unsigned) bytes[3] );
+}
+
+void HRSLinearSearch::map_training_set( const std::string& images_path,
+                                        const std::string& labels_path,
+                                        int                size )
+{
+  ECE2400_PROFILE_SCOPE( "map_training_set" );
+
+  unmap_training_set();
+  m_vimage = Vector<Image>();
+
+  m_images_map = map_file( images_path, m_images_len );
+  m_labels_map = map_file( labels_path, m_labels_len );
+
+  const unsigned char* images = (const unsigned char*) m_images_map;
+  const unsigned char* labels = (const unsigned char*) m_labels_map;
+
+  bool valid = images != nullptr && labels != nullptr &&
+               m_images_len >= idx_images_header &&
+               m_labels_len >= idx_labels_header &&
+               load_be32( images ) == 0x00000803 &&
+               load_be32( labels ) == 0x00000801 &&
+               load_be32( images + 4 ) == load_be32( labels + 4 ) &&
+               load_be32( images + 4 ) >= 0 && load_be32( images + 8 ) > 0 &&
+               load_be32( images + 12 ) > 0;
+
+  if ( valid ) {
+    int count     = load_be32( images + 4 );
+    m_nrows       = load_be32( images + 8 );
+    m_ncols       = load_be32( images + 12 );
+    m_mapped_size = ( size >= 0 && size < count ) ? size : count;
+
+    size_t img_bytes = (size_t) m_ncols * (size_t) m_nrows;
+    valid = m_images_len - idx_images_header >=
+                (size_t) m_mapped_size * img_bytes &&
+            m_labels_len - idx_labels_header >= (size_t) m_mapped_size;
+  }
+
+  if ( !valid ) {
+    unmap_training_set();
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "could not map matching IDX image and label files" );
+    throw e;
+  }
+
+  m_pixels = images + idx_images_header;
+  m_labels = labels + idx_labels_header;
+
+  madvise( m_images_map, m_images_len, MADV_SEQUENTIAL );
+  madvise( m_labels_map, m_labels_len, MADV_SEQUENTIAL );
+}
+
+//------------------------------------------------------------------------
+// unmap_training_set
+//------------------------------------------------------------------------
+
+void HRSLinearSearch::unmap_training_set()
+{
+  if ( m_images_map != nullptr )
+    munmap( m_images_map, m_images_len );
+  if ( m_labels_map != nullptr )
+    munmap( m_labels_map, m_labels_len );
+
+  m_images_map  = nullptr;
+  m_images_len  = 0;
+  m_labels_map  = nullptr;
+  m_labels_len  = 0;
+  m_pixels      = nullptr;
+  m_labels      = nullptr;
+  m_mapped_size = 0;
+}
+
+//------------------------------------------------------------------------
+// scan_mapped
+//------------------------------------------------------------------------
+// Finds the closest mapped image of every query with one pass over the
+// mapping, and if given indices, sets them to the index of each in the
+// mapped files. Distances are computed straight from the packed bytes
+// and equal Image::distance; ties go to the lowest index, as in
+// find_closest_linear.
+
+static int distance_packed( const int* query, const unsigned char* pixels,
+                            int size )
+{
+  int total = 0;
+  for ( int i = 0; i < size; i++ ) {
+    int diff = query[i] - (int) pixels[i];
+    total += diff * diff;
+  }
+  return total;
+}
+
+// Asks the kernel to start reading the given bytes of a mapping, which
+// has to start on a page boundary
+static void prefetch( const void* map, size_t map_len, size_t begin,
+                      size_t len )
+{
+  size_t page = (size_t) sysconf( _SC_PAGESIZE );
+  begin       = begin / page * page;
+  if ( begin >= map_len )
+    return;
+  if ( len > map_len - begin )
+    len = map_len - begin;
+  madvise( (char*) map + begin, len, MADV_WILLNEED );
+}
+
+Vector<Image> HRSLinearSearch::scan_mapped( const Vector<Image>& queries,
+                                            Vector<int>* indices ) const
+{
+  int nqueries = queries.size();
+  int img_size = m_ncols * m_nrows;
+
+  if ( m_mapped_size == 0 ) {
+    ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
+    throw e;
+  }
+
+  Vector<Image> results;
+  if ( indices != nullptr )
+    *indices = Vector<int>();
+  if ( nqueries == 0 )
+    return results;
+
+  // Copy the query pixels next to each other
+
+  std::vector<int> query_pixels( (size_t) nqueries * (size_t) img_size );
+  for ( int q = 0; q < nqueries; q++ ) {
+    const Image& query = queries[q];
+    if ( query.get_ncols() * query.get_nrows() != img_size ) {
+      ece2400::InvalidArgument e =
+          ece2400::InvalidArgument( "dimensions of images do not match" );
+      throw e;
+    }
+    for ( int i = 0; i < img_size; i++ )
+      query_pixels[(size_t) q * (size_t) img_size + (size_t) i] = query[i];
+  }
+
+  std::vector<int> best_distance( (size_t) nqueries, INT_MAX );
+  std::vector<int> best_index( (size_t) nqueries, 0 );
+
+  size_t img_bytes = (size_t) img_size;
+  int    chunk     = (int) ( scan_chunk_bytes / img_bytes );
+  if ( chunk < 1 )
+    chunk = 1;
+  size_t chunk_bytes = (size_t) chunk * img_bytes;
+
+  for ( int begin = 0; begin < m_mapped_size; begin += chunk ) {
+    int end = ( m_mapped_size - begin < chunk ) ? m_mapped_size : begin + chunk;
+
+    // Start reading the chunks after this one while it is compared
+
+    size_t ahead = idx_images_header + (size_t) end * img_bytes;
+    prefetch( m_images_map, m_images_len, ahead, scan_readahead * chunk_bytes );
+
+    for ( int q0 = 0; q0 < nqueries; q0 += scan_query_block ) {
+      int q1 = ( nqueries - q0 < scan_query_block ) ? nqueries
+                                                    : q0 + scan_query_block;
+      for ( int i = begin; i < end; i++ ) {
+        const unsigned char* pixels = m_pixels + (size_t) i * img_bytes;
+        for ( int q = q0; q < q1; q++ ) {
+          int d = distance_packed(
+              &query_pixels[(size_t) q * (size_t) img_size], pixels,
+              img_size );
+          if ( d < best_distance[(size_t) q] ) {
+            best_distance[(size_t) q] = d;
+            best_index[(size_t) q]    = i;
+          }
+        }
+      }
+    }
+  }
+
+  HRS_STATS_ADD( distance_calls, (long long) nqueries * m_mapped_size );
+  HRS_STATS_ADD( candidates, (long long) nqueries * m_mapped_size );
+  HRS_STATS_ADD( bytes_touched,
+                 (long long) nqueries * m_mapped_size * img_size );
+
+  // Copy the closest images out of the mapping
+
+  results.reserve( nqueries );
+
+  std::vector<int> data( img_bytes );
+  for ( int q = 0; q < nqueries; q++ ) {
+    int                  idx    = best_index[(size_t) q];
+    const unsigned char* pixels = m_pixels + (size_t) idx * img_bytes;
+    for ( size_t j = 0; j < img_bytes; j++ )
+      data[j] = pixels[j];
+
+    Image img( Vector<int>( &data[0], img_size ), m_ncols, m_nrows );
+    img.set_label( (char) ( '0' + m_labels[idx] ) );
+    results.push_back( img );
+  }
+
+  if ( indices != nullptr ) {
+    indices->reserve( nqueries );
+    for ( int q = 0; q < nqueries; q++ )
+      indices->push_back( best_index[(size_t) q] );
+  }
+  return results;
 }
\ No newline at end of file
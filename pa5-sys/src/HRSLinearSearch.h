@@ -8,6 +8,8 @@
 
 #include "IHandwritingRecSys.h"
 #include "Vector.h"
+#include <cstddef>
+#include <string>
 
 // Here we use forward declaration instead of #include. Forward
 // declaration is a declaration of an identifier (type, variable, or
@@ -26,15 +28,64 @@ class Image;
 // HRSLinearSearch
 //------------------------------------------------------------------------
 
+// With condense set, training keeps only the prototypes selected by
+// Hart's condensed nearest neighbor rule (see condense_images), which
+// makes classification proportionally faster.
+//
+// For training sets larger than memory, map_training_set searches the
+// first size images of an IDX images and labels file (as written by
+// write_labeled_images) in place instead: the files are memory-mapped,
+// never read into Images, and every query scans the pixels straight
+// from the mapping. The scan is sequential, so the kernel is told to
+// read ahead aggressively and to drop pages behind the scan, and the
+// next chunks are prefetched while the current one is compared, which
+// overlaps the disk reads with the distance computations. A scan costs
+// a full pass over the file, so classify_batch classifies many queries
+// with one pass, comparing every chunk against all of them while it is
+// in memory. Given indices, classify_batch also returns the index of
+// every result in the mapped files; a training set in memory does not
+// keep the original positions, so its indices are -1. Duplicates are
+// not collapsed and condense does not apply to a mapped set; training again replaces it, and add_samples throws
+// InvalidArgument while it is mapped.
+
 class HRSLinearSearch : public IHandwritingRecSys {
  public:
-  HRSLinearSearch();
+  HRSLinearSearch( bool condense = false );
+  ~HRSLinearSearch();
 
   void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
   Image classify( const Image& img );
 
+  void map_training_set( const std::string& images_path,
+                         const std::string& labels_path, int size = -1 );
+
+  Vector<Image> classify_batch( const Vector<Image>& queries );
+  Vector<Image> classify_batch( const Vector<Image>& queries,
+                                Vector<int>&         indices );
+
  private:
+  // The mappings cannot be shared between copies
+  HRSLinearSearch( const HRSLinearSearch& );
+  HRSLinearSearch& operator=( const HRSLinearSearch& );
+
+  void          unmap_training_set();
+  Vector<Image> scan_mapped( const Vector<Image>& queries,
+                             Vector<int>*         indices = nullptr ) const;
+
   Vector<Image> m_vimage;
+  bool          m_condense;
+
+  // Mapped training set
+  void*                m_images_map;
+  size_t               m_images_len;
+  void*                m_labels_map;
+  size_t               m_labels_len;
+  const unsigned char* m_pixels;  // pixels of the first image
+  const unsigned char* m_labels;  // label of the first image
+  int                  m_mapped_size;
+  int                  m_ncols;
+  int                  m_nrows;
 };
 
 #endif
@@ -0,0 +1,69 @@
+//========================================================================
+// HRSPreprocessed.cc
+//========================================================================
+// Handwritten recognition system that preprocesses images for another.
+
+#include "HRSPreprocessed.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+//------------------------------------------------------------------------
+// HRSPreprocessed
+//------------------------------------------------------------------------
+
+HRSPreprocessed::HRSPreprocessed( IHandwritingRecSys&      hrs,
+                                  const ImagePreprocessor& preprocessor )
+    : m_hrs( hrs ), m_preprocessor( preprocessor )
+{
+}
+
+//------------------------------------------------------------------------
+// train / add_samples
+//------------------------------------------------------------------------
+
+void HRSPreprocessed::train( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "preprocess" );
+  m_hrs.train( m_preprocessor.apply( vec ) );
+}
+
+void HRSPreprocessed::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "preprocess" );
+  m_hrs.add_samples( m_preprocessor.apply( vec ) );
+}
+
+//------------------------------------------------------------------------
+// classify / classify_batch
+//------------------------------------------------------------------------
+
+Image HRSPreprocessed::classify( const Image& img )
+{
+  return m_hrs.classify( m_preprocessor.apply( img ) );
+}
+
+Vector<Image> HRSPreprocessed::classify_batch( const Vector<Image>& images )
+{
+  return m_hrs.classify_batch( m_preprocessor.apply( images ) );
+}
+
+Vector<Image> HRSPreprocessed::classify_batch( const Vector<Image>& images,
+                                               Vector<int>&         indices )
+{
+  return m_hrs.classify_batch( m_preprocessor.apply( images ), indices );
+}
+
+//------------------------------------------------------------------------
+// stats / reset_stats
+//------------------------------------------------------------------------
+
+HRSStats HRSPreprocessed::stats() const
+{
+  return m_hrs.stats();
+}
+
+void HRSPreprocessed::reset_stats()
+{
+  m_hrs.reset_stats();
+}
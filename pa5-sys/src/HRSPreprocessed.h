@@ -0,0 +1,41 @@
+//========================================================================
+// HRSPreprocessed.h
+//========================================================================
+// Handwritten recognition system that preprocesses images for another.
+
+#ifndef HRS_PREPROCESSED_H
+#define HRS_PREPROCESSED_H
+
+#include "IHandwritingRecSys.h"
+#include "ImagePreprocessor.h"
+
+//------------------------------------------------------------------------
+// HRSPreprocessed
+//------------------------------------------------------------------------
+// Passes every image through an ImagePreprocessor before handing it to
+// the wrapped HRS: the training images when they are trained or added,
+// and the queries when they are classified. So the returned image is
+// the preprocessed closest training image. Stats are the ones of the
+// wrapped HRS, which has to outlive the HRSPreprocessed.
+
+class HRSPreprocessed : public IHandwritingRecSys {
+ public:
+  HRSPreprocessed( IHandwritingRecSys&      hrs,
+                   const ImagePreprocessor& preprocessor = ImagePreprocessor() );
+
+  void          train( const Vector<Image>& vec );
+  void          add_samples( const Vector<Image>& vec );
+  Image         classify( const Image& img );
+  Vector<Image> classify_batch( const Vector<Image>& images );
+  Vector<Image> classify_batch( const Vector<Image>& images,
+                                Vector<int>&         indices );
+
+  HRSStats stats() const;
+  void     reset_stats();
+
+ private:
+  IHandwritingRecSys& m_hrs;
+  ImagePreprocessor   m_preprocessor;
+};
+
+#endif
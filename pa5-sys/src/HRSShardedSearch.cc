@@ -0,0 +1,417 @@
+//========================================================================
+// HRSShardedSearch.cc
+//========================================================================
+// Handwritten recognition system that splits linear search across
+// worker processes.
+
+#include "HRSShardedSearch.h"
+#include "HRSLinearSearch.h"
+#include "Image.h"
+#include "mnist-utils.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+// Every message to a worker starts with an op and a count of the images
+// that follow. A worker acknowledges op_train and op_add with a zero,
+// and answers op_query (always one image) with the distance to and the
+// number of distances it took to find the closest image of its shard,
+// followed by that image. A worker with an empty shard answers with a
+// distance of -1 and no image.
+
+const int op_train = 0;
+const int op_add   = 1;
+const int op_query = 2;
+
+//------------------------------------------------------------------------
+// send_all / recv_all
+//------------------------------------------------------------------------
+// Send or receive exactly len bytes. Return false if the other end has
+// gone away.
+
+static bool send_all( int fd, const void* buf, size_t len )
+{
+  const char* p = (const char*) buf;
+  while ( len > 0 ) {
+    ssize_t n = send( fd, p, len, MSG_NOSIGNAL );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return false;
+    p += n;
+    len -= (size_t) n;
+  }
+  return true;
+}
+
+static bool recv_all( int fd, void* buf, size_t len )
+{
+  char* p = (char*) buf;
+  while ( len > 0 ) {
+    ssize_t n = recv( fd, p, len, 0 );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return false;
+    p += n;
+    len -= (size_t) n;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+// send_image / recv_image
+//------------------------------------------------------------------------
+// An image is sent as its number of columns, number of rows and label,
+// followed by its pixels, all as ints.
+
+static bool send_image( int fd, const Image& img, std::vector<int>& buf )
+{
+  int size = img.get_ncols() * img.get_nrows();
+  buf.resize( (size_t) ( 3 + size ) );
+  buf[0] = img.get_ncols();
+  buf[1] = img.get_nrows();
+  buf[2] = img.get_label();
+  for ( int i = 0; i < size; i++ )
+    buf[(size_t) ( 3 + i )] = img[i];
+  return send_all( fd, &buf[0], buf.size() * sizeof( int ) );
+}
+
+static bool recv_image( int fd, Image& img, std::vector<int>& buf )
+{
+  int header[3];
+  if ( !recv_all( fd, header, sizeof( header ) ) || header[0] < 0 ||
+       header[1] < 0 )
+    return false;
+
+  int size = header[0] * header[1];
+  buf.resize( (size_t) size + 1 );
+  if ( !recv_all( fd, &buf[0], (size_t) size * sizeof( int ) ) )
+    return false;
+
+  img = Image( Vector<int>( &buf[0], size ), header[0], header[1] );
+  img.set_label( (char) header[2] );
+  return true;
+}
+
+//------------------------------------------------------------------------
+// run_worker
+//------------------------------------------------------------------------
+// Serves requests for one shard until the coordinator closes its end.
+
+static void run_worker( int fd )
+{
+  HRSLinearSearch  shard;
+  bool             empty = true;
+  std::vector<int> buf;
+
+  int header[2];
+  while ( recv_all( fd, header, sizeof( header ) ) ) {
+    int op    = header[0];
+    int count = header[1];
+
+    Vector<Image> images;
+    images.reserve( count );
+    for ( int i = 0; i < count; i++ ) {
+      Image img;
+      if ( !recv_image( fd, img, buf ) )
+        return;
+      images.push_back( img );
+    }
+
+    if ( op == op_train || op == op_add ) {
+      if ( op == op_train ) {
+        shard.train( images );
+        empty = ( count == 0 );
+      }
+      else if ( count > 0 ) {
+        shard.add_samples( images );
+        empty = false;
+      }
+      int ack = 0;
+      if ( !send_all( fd, &ack, sizeof( ack ) ) )
+        return;
+    }
+
+    else if ( op == op_query && count == 1 ) {
+      int reply[2] = { -1, 0 };
+      if ( empty ) {
+        if ( !send_all( fd, reply, sizeof( reply ) ) )
+          return;
+        continue;
+      }
+
+      HRSStats start  = hrs_stats_local();
+      Image    result = shard.classify( images[0] );
+      reply[1]        = (int) hrs_stats_since( start ).distance_calls;
+      reply[0]        = result.distance( images[0] );
+      if ( !send_all( fd, reply, sizeof( reply ) ) ||
+           !send_image( fd, result, buf ) )
+        return;
+    }
+
+    else {
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// HRSShardedSearch
+//------------------------------------------------------------------------
+
+HRSShardedSearch::HRSShardedSearch( int nshards )
+{
+  if ( nshards < 0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "number of shards must not be negative" );
+    throw e;
+  }
+  if ( nshards == 0 )
+    nshards = (int) std::thread::hardware_concurrency();
+  m_nshards = ( nshards > 0 ) ? nshards : 1;
+  m_failed  = false;
+}
+
+HRSShardedSearch::~HRSShardedSearch()
+{
+  stop_workers();
+}
+
+int HRSShardedSearch::num_shards() const
+{
+  return m_nshards;
+}
+
+//------------------------------------------------------------------------
+// start_workers / stop_workers
+//------------------------------------------------------------------------
+// Each worker is a child process connected to the coordinator by its
+// own socket pair. A worker closes every descriptor it inherits except
+// its own socket and the standard streams. That includes the sockets of
+// the workers of this and of every other live HRSShardedSearch, so every
+// worker sees the end of its socket as soon as its coordinator closes
+// it, whatever order the instances are destroyed in.
+
+static void close_inherited_fds( int keep )
+{
+  std::vector<int> fds;
+  DIR*             dir = opendir( "/proc/self/fd" );
+  if ( dir != nullptr ) {
+    while ( struct dirent* entry = readdir( dir ) ) {
+      int fd = std::atoi( entry->d_name );
+      if ( fd > 2 && fd != keep && fd != dirfd( dir ) )
+        fds.push_back( fd );
+    }
+    closedir( dir );
+  }
+  else {
+    long max_fd = sysconf( _SC_OPEN_MAX );
+    for ( int fd = 3; fd < max_fd; fd++ ) {
+      if ( fd != keep )
+        fds.push_back( fd );
+    }
+  }
+
+  for ( size_t i = 0; i < fds.size(); i++ )
+    close( fds[i] );
+}
+
+void HRSShardedSearch::start_workers()
+{
+  for ( int k = 0; k < m_nshards; k++ ) {
+    int sv[2];
+    if ( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) != 0 ) {
+      stop_workers();
+      ece2400::InvalidArgument e =
+          ece2400::InvalidArgument( "could not create a worker socket" );
+      throw e;
+    }
+
+    pid_t pid = fork();
+    if ( pid == 0 ) {
+      close_inherited_fds( sv[1] );
+      run_worker( sv[1] );
+      _exit( 0 );
+    }
+
+    close( sv[1] );
+    if ( pid < 0 ) {
+      close( sv[0] );
+      stop_workers();
+      ece2400::InvalidArgument e =
+          ece2400::InvalidArgument( "could not start a shard worker" );
+      throw e;
+    }
+    m_sockets.push_back( sv[0] );
+    m_pids.push_back( pid );
+  }
+}
+
+void HRSShardedSearch::stop_workers()
+{
+  for ( size_t i = 0; i < m_sockets.size(); i++ )
+    close( m_sockets[i] );
+  for ( size_t i = 0; i < m_pids.size(); i++ )
+    waitpid( m_pids[i], nullptr, 0 );
+
+  m_sockets.clear();
+  m_pids.clear();
+}
+
+//------------------------------------------------------------------------
+// fail_workers / check_workers
+//------------------------------------------------------------------------
+// Once a send or receive has failed, the other sockets may hold half a
+// request or replies that were never read, which the next call would
+// take for its own. So every worker is stopped, and until train starts
+// new ones, check_workers throws instead of talking to them.
+
+void HRSShardedSearch::fail_workers()
+{
+  stop_workers();
+  m_failed = true;
+  ece2400::InvalidArgument e =
+      ece2400::InvalidArgument( "could not reach a shard worker" );
+  throw e;
+}
+
+void HRSShardedSearch::check_workers() const
+{
+  if ( m_failed ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "shard workers were stopped after a failure" );
+    throw e;
+  }
+}
+
+//------------------------------------------------------------------------
+// send_shards
+//------------------------------------------------------------------------
+// Splits vec into one contiguous piece per worker and sends each worker
+// its piece with the given op. Every piece is sent before waiting for
+// any acknowledgement, so the workers build their shards at the same
+// time.
+
+void HRSShardedSearch::send_shards( const Vector<Image>& vec, int op )
+{
+  std::vector<int> buf;
+
+  bool ok = true;
+  for ( int k = 0; k < m_nshards && ok; k++ ) {
+    int begin = (int) ( (long long) vec.size() * k / m_nshards );
+    int end   = (int) ( (long long) vec.size() * ( k + 1 ) / m_nshards );
+
+    int header[2] = { op, end - begin };
+    ok = send_all( m_sockets[(size_t) k], header, sizeof( header ) );
+    for ( int i = begin; i < end && ok; i++ )
+      ok = send_image( m_sockets[(size_t) k], vec[i], buf );
+  }
+
+  for ( int k = 0; k < m_nshards && ok; k++ ) {
+    int ack;
+    ok = recv_all( m_sockets[(size_t) k], &ack, sizeof( ack ) );
+  }
+
+  if ( !ok )
+    fail_workers();
+}
+
+//------------------------------------------------------------------------
+// train
+//------------------------------------------------------------------------
+// Replaces the shards of every worker, collapsing duplicates over the
+// whole training set first. After a failure, new workers are started.
+
+void HRSShardedSearch::train( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  if ( m_sockets.empty() ) {
+    start_workers();
+    m_failed = false;
+  }
+  send_shards( dedup_images( vec ), op_train );
+}
+
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// Spreads the given images over the shards
+
+void HRSShardedSearch::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  check_workers();
+  if ( m_sockets.empty() )
+    start_workers();
+  send_shards( dedup_images( vec ), op_add );
+}
+
+//------------------------------------------------------------------------
+// classify
+//------------------------------------------------------------------------
+// Sends the query to every worker before waiting for any answer, then
+// keeps the closest answer. The work of the workers is counted as if it
+// had been done here.
+
+Image HRSShardedSearch::classify( const Image& img )
+{
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  check_workers();
+
+  std::vector<int> buf;
+
+  bool ok = !m_sockets.empty();
+  for ( int k = 0; k < m_nshards && ok; k++ ) {
+    int header[2] = { op_query, 1 };
+    ok = send_all( m_sockets[(size_t) k], header, sizeof( header ) ) &&
+         send_image( m_sockets[(size_t) k], img, buf );
+  }
+
+  Image     best;
+  int       best_distance = -1;
+  long long ndistances    = 0;
+  for ( int k = 0; k < m_nshards && ok; k++ ) {
+    int reply[2];
+    ok = recv_all( m_sockets[(size_t) k], reply, sizeof( reply ) );
+    if ( !ok || reply[0] < 0 )
+      continue;
+
+    Image result;
+    ok = recv_image( m_sockets[(size_t) k], result, buf );
+    ndistances += reply[1];
+    if ( ok && ( best_distance < 0 || reply[0] < best_distance ) ) {
+      best_distance = reply[0];
+      best          = result;
+    }
+  }
+
+  if ( !ok && !m_sockets.empty() )
+    fail_workers();
+
+  HRS_STATS_ADD( distance_calls, ndistances );
+  HRS_STATS_ADD( candidates, ndistances );
+  HRS_STATS_ADD( bytes_touched,
+                 ndistances * img.get_ncols() * img.get_nrows() *
+                     (long long) sizeof( int ) );
+
+  if ( best_distance < 0 ) {
+    ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
+    throw e;
+  }
+  return best;
+}
@@ -0,0 +1,69 @@
+//========================================================================
+// HRSShardedSearch.h
+//========================================================================
+// Handwritten recognition system that splits linear search across
+// worker processes.
+
+#ifndef HRS_SHARDED_SEARCH_H
+#define HRS_SHARDED_SEARCH_H
+
+#include "IHandwritingRecSys.h"
+#include "Vector.h"
+#include <sys/types.h>
+#include <vector>
+
+class Image;
+
+//------------------------------------------------------------------------
+// HRSShardedSearch
+//------------------------------------------------------------------------
+// The training set is split into nshards contiguous shards, each held by
+// its own worker process that searches it with HRSLinearSearch. The
+// process that owns the HRSShardedSearch only coordinates: it sends
+// every query to all workers over a socket, lets them search their
+// shards at the same time, and keeps the closest of their answers, ties
+// going to the lower shard, so classification scales with the number of
+// cores. The coordinator still collapses duplicates over the whole
+// training set, so it holds all of it while training.
+//
+// Training collapses duplicates over the whole training set before
+// splitting it, so the result is the same as HRSLinearSearch's on the
+// same images. Samples added later are spread over the shards evenly
+// instead of going after all other images, so only ties between them
+// and other images may be broken differently. With nshards = 0, one
+// worker per hardware thread is started. Workers are started by the
+// first train and exit when the HRSShardedSearch is destroyed. Throws
+// InvalidArgument if a worker cannot be started or reached. A failure
+// can leave messages half sent or unread, so it stops every worker;
+// classify and add_samples then throw InvalidArgument until train
+// starts new ones.
+
+class HRSShardedSearch : public IHandwritingRecSys {
+ public:
+  HRSShardedSearch( int nshards = 0 );
+  ~HRSShardedSearch();
+
+  void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
+  Image classify( const Image& img );
+
+  int num_shards() const;
+
+ private:
+  // Workers cannot be shared between copies
+  HRSShardedSearch( const HRSShardedSearch& );
+  HRSShardedSearch& operator=( const HRSShardedSearch& );
+
+  void start_workers();
+  void stop_workers();
+  void fail_workers();
+  void check_workers() const;
+  void send_shards( const Vector<Image>& vec, int op );
+
+  int                m_nshards;
+  std::vector<int>   m_sockets;  // coordinator end of each worker's socket
+  std::vector<pid_t> m_pids;
+  bool               m_failed;  // workers were stopped after a failure
+};
+
+#endif
@@ -0,0 +1,145 @@
+//========================================================================
+// HRSStats.cc
+//========================================================================
+// Implementation of HRSStats.
+
+#include "HRSStats.h"
+
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+static const int width = 22;
+
+//------------------------------------------------------------------------
+// HRSStats
+//------------------------------------------------------------------------
+
+HRSStats::HRSStats()
+{
+  queries        = 0;
+  distance_calls = 0;
+  nodes_visited  = 0;
+  candidates     = 0;
+  pruned         = 0;
+  bytes_touched  = 0;
+}
+
+HRSStats& HRSStats::operator+=( const HRSStats& rhs )
+{
+  queries += rhs.queries;
+  distance_calls += rhs.distance_calls;
+  nodes_visited += rhs.nodes_visited;
+  candidates += rhs.candidates;
+  pruned += rhs.pruned;
+  bytes_touched += rhs.bytes_touched;
+  return *this;
+}
+
+HRSStats HRSStats::operator-( const HRSStats& rhs ) const
+{
+  HRSStats diff;
+  diff.queries        = queries - rhs.queries;
+  diff.distance_calls = distance_calls - rhs.distance_calls;
+  diff.nodes_visited  = nodes_visited - rhs.nodes_visited;
+  diff.candidates     = candidates - rhs.candidates;
+  diff.pruned         = pruned - rhs.pruned;
+  diff.bytes_touched  = bytes_touched - rhs.bytes_touched;
+  return diff;
+}
+
+//------------------------------------------------------------------------
+// print
+//------------------------------------------------------------------------
+// Prints the work per query in the format of the eval programs
+
+#ifdef HRS_STATS
+
+static void print_per_query( const char* name, long long total,
+                             long long queries )
+{
+  std::cout << std::setw( width ) << std::left << name << " : "
+            << (double) total / (double) queries << std::endl;
+}
+
+#endif
+
+void HRSStats::print() const
+{
+#ifdef HRS_STATS
+  if ( queries == 0 )
+    return;
+  print_per_query( " - distance calls/query", distance_calls, queries );
+  print_per_query( " - nodes visited/query", nodes_visited, queries );
+  print_per_query( " - candidates/query", candidates, queries );
+  print_per_query( " - pruned/query", pruned, queries );
+  print_per_query( " - bytes touched/query", bytes_touched, queries );
+#else
+  std::cout << std::setw( width ) << std::left << " - stats"
+            << " : disabled (configure with -DHRS_STATS=ON)" << std::endl;
+#endif
+}
+
+//------------------------------------------------------------------------
+// hrs_stats_local / hrs_stats_since
+//------------------------------------------------------------------------
+
+namespace {
+
+// Guards stats that scopes on several threads add to
+std::mutex stats_mutex;
+
+thread_local HRSStats thread_stats;
+
+}  // namespace
+
+HRSStats& hrs_stats_local()
+{
+  return thread_stats;
+}
+
+HRSStats hrs_stats_since( const HRSStats& start )
+{
+  return thread_stats - start;
+}
+
+//------------------------------------------------------------------------
+// HRSStatsScope
+//------------------------------------------------------------------------
+
+#ifdef HRS_STATS
+
+HRSStatsScope::HRSStatsScope( HRSStats& stats, int queries )
+    : m_stats( stats ), m_start( thread_stats ), m_queries( queries )
+{
+}
+
+HRSStatsScope::~HRSStatsScope()
+{
+  HRSStats delta = hrs_stats_since( m_start );
+  delta.queries  = m_queries;
+  std::lock_guard<std::mutex> lock( stats_mutex );
+  m_stats += delta;
+}
+
+#endif
+
+//------------------------------------------------------------------------
+// hrs_stats_read / hrs_stats_clear
+//------------------------------------------------------------------------
+
+HRSStats hrs_stats_read( const HRSStats& stats )
+{
+  std::lock_guard<std::mutex> lock( stats_mutex );
+  return stats;
+}
+
+void hrs_stats_clear( HRSStats& stats )
+{
+  std::lock_guard<std::mutex> lock( stats_mutex );
+  stats = HRSStats();
+}
@@ -0,0 +1,119 @@
+//========================================================================
+// HRSStats.h
+//========================================================================
+// Declarations for counting the work done by handwriting recognition
+// systems.
+//
+// The search structures count their work into counters that belong to
+// the calling thread, which costs one thread-local add per event and no
+// synchronization. Worker threads that do part of a query hand what
+// they counted back to the thread that waits for them (see
+// hrs_stats_since). Every HRS wraps classify in an HRSStatsScope, which
+// adds what the calling thread counted during the call to the stats of
+// that HRS.
+//
+// Counting is compiled in only when HRS_STATS is defined (the default;
+// configure with -DHRS_STATS=OFF to remove it). Otherwise
+// HRS_STATS_ADD expands to nothing and all stats read as zero.
+
+#ifndef HRS_STATS_H
+#define HRS_STATS_H
+
+//------------------------------------------------------------------------
+// HRSStats
+//------------------------------------------------------------------------
+// - queries        : number of classify calls
+// - distance_calls : number of Image::distance evaluations
+// - nodes_visited  : tree nodes or binary search steps walked through
+// - candidates     : values considered as the closest one, i.e., the
+//                    values scanned by the final linear search
+// - pruned         : distances cut short because a lower bound already
+//                    ruled the value out (see Image::distance_within)
+// - bytes_touched  : bytes of training data read, counting the pixels
+//                    of every candidate a distance is computed to and
+//                    every node visited
+
+struct HRSStats {
+  HRSStats();
+
+  long long queries;
+  long long distance_calls;
+  long long nodes_visited;
+  long long candidates;
+  long long pruned;
+  long long bytes_touched;
+
+  HRSStats& operator+=( const HRSStats& rhs );
+  HRSStats  operator-( const HRSStats& rhs ) const;
+
+  void print() const;
+};
+
+//------------------------------------------------------------------------
+// hrs_stats_local / hrs_stats_since
+//------------------------------------------------------------------------
+// The counters of the calling thread, and what it has counted since its
+// counters read start. A worker thread that does part of a query reads
+// its counters first and hands hrs_stats_since( start ) back to the
+// thread waiting for it, which adds that to hrs_stats_local(). The work
+// is then counted once, by the query it was done for.
+
+HRSStats& hrs_stats_local();
+HRSStats  hrs_stats_since( const HRSStats& start );
+
+//------------------------------------------------------------------------
+// HRS_STATS_ADD( field_, n_ )
+//------------------------------------------------------------------------
+// Adds n_ to the given field of the calling thread's counters.
+
+#ifdef HRS_STATS
+#define HRS_STATS_ADD( field_, n_ ) \
+  ( hrs_stats_local().field_ += (long long) ( n_ ) )
+#else
+#define HRS_STATS_ADD( field_, n_ ) ( (void) 0 )
+#endif
+
+//------------------------------------------------------------------------
+// HRSStatsScope
+//------------------------------------------------------------------------
+// Counts one query (or the given number of queries, for calls that
+// classify a batch) into the given stats: everything the calling thread
+// counted between construction and destruction, including the work
+// handed back by its workers, is added to them. Scopes on different
+// threads may add to the same stats at the same time. Only that final
+// add takes a lock, once per scope.
+
+#ifdef HRS_STATS
+
+class HRSStatsScope {
+ public:
+  explicit HRSStatsScope( HRSStats& stats, int queries = 1 );
+  ~HRSStatsScope();
+
+ private:
+  HRSStatsScope( const HRSStatsScope& );
+  HRSStatsScope& operator=( const HRSStatsScope& );
+
+  HRSStats& m_stats;
+  HRSStats  m_start;
+  int       m_queries;
+};
+
+#else
+
+class HRSStatsScope {
+ public:
+  explicit HRSStatsScope( HRSStats&, int = 1 ) {}
+};
+
+#endif
+
+//------------------------------------------------------------------------
+// hrs_stats_read / hrs_stats_clear
+//------------------------------------------------------------------------
+// Reads or clears stats that scopes on other threads may be adding to.
+
+HRSStats hrs_stats_read( const HRSStats& stats );
+void     hrs_stats_clear( HRSStats& stats );
+
+#endif  // HRS_STATS_H
@@ -9,5 +9,6 @@
 #include "Vector.h"
 
 //'''' ASSIGNMENT TASK '''''''''''''''''''''''''''''''''''''''''''''''''''
-// Implement HRSTableSearch.
+// Implement HRSTableSearch. add_samples should append each new image to
+// the bin its intensity falls into, without touching the other bins.
 //''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
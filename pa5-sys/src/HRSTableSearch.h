@@ -33,6 +33,7 @@ class HRSTableSearch : public IHandwritingRecSys {
   HRSTableSearch( int K = 1000 );
 
   void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
   Image classify( const Image& img );
 
  private:
@@ -5,12 +5,18 @@
 
 #include "HRSTreeSearch.h"
 
+#include "Distance.h"
 #include "Image.h"
 #include "Tree.h"
 #include "Vector.h"
+#include "mnist-utils.h"
 
-bool HRSTreeSearch::LessIntensity::operator()( const Image& a, const Image& b )
+// Orders images along the curve of Image::curve_key, breaking ties by
+// intensity
+bool HRSTreeSearch::LessKey::operator()( const Image& a, const Image& b )
 {
+  if ( a.curve_key() != b.curve_key() )
+    return a.curve_key() < b.curve_key();
   return a.get_intensity() < b.get_intensity();
 }
 
@@ -18,27 +24,51 @@ bool HRSTreeSearch::LessIntensity::operator()( const Image& a, const Image& b )
 // HRSTreeSearch
 //------------------------------------------------------------------------
 // The default constructor for the HRSTreeSearch class
-HRSTreeSearch::HRSTreeSearch( int k ) : m_training_set( k, LessIntensity() )
+HRSTreeSearch::HRSTreeSearch( int k ) : m_training_set( k, LessKey() )
 {
 }
 
 //------------------------------------------------------------------------
 // train
 //------------------------------------------------------------------------
-// A function that sets the array of the HRSLinearSearch equal to the
-// given vector
+// A function that replaces the training set with the given vector
 
 void HRSTreeSearch::train( const Vector<Image>& vec )
 {
-  for ( int i = 0; i < vec.size(); i++ ) {
-    m_training_set.add( vec[i] );
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  m_training_set.clear();
+  add_samples( vec );
+}
+
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// A function that adds the given images to the tree, with duplicate
+// images collapsed into one. The tree rebalances itself as it grows, so
+// each image costs O(log n) amortized.
+
+void HRSTreeSearch::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  Vector<Image> batch = dedup_images( vec );
+
+  ECE2400_PROFILE_SCOPE( "index build" );
+  for ( int i = 0; i < batch.size(); i++ ) {
+    m_training_set.add( batch[i] );
   }
 }
 
-int HRSTreeSearch::Distance::operator()( const Image& a, const Image& b )
+//------------------------------------------------------------------------
+// set_k
+//------------------------------------------------------------------------
+
+void HRSTreeSearch::set_k( int k )
 {
-  return a.distance( b );
+  m_training_set.set_k( k );
 }
+
 //------------------------------------------------------------------------
 // classify
 //------------------------------------------------------------------------
@@ -46,5 +76,8 @@ int HRSTreeSearch::Distance::operator()( const Image& a, const Image& b )
 // search method
 Image HRSTreeSearch::classify( const Image& img )
 {
-  return m_training_set.find_closest( img, Distance() );
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  return m_training_set.find_closest( img, CascadeDistance() );
 }
\ No newline at end of file
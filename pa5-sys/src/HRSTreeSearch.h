@@ -36,20 +36,20 @@ class HRSTreeSearch : public IHandwritingRecSys {
   HRSTreeSearch( int K = 1000 );
 
   void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
   Image classify( const Image& img );
 
+  // Number of training images the final linear search looks at. Can be
+  // changed after training.
+  void set_k( int K );
+
  private:
-  class LessIntensity {
+  class LessKey {
    public:
     bool operator()( const Image& a, const Image& b );
   };
 
-  class Distance {
-   public:
-    int operator()( const Image& a, const Image& b );
-  };
-
-  Tree<Image, LessIntensity> m_training_set;
+  Tree<Image, LessKey> m_training_set;
   // ImgCmpFunc m_dist;
 };
 
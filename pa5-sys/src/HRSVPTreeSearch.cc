@@ -0,0 +1,75 @@
+//========================================================================
+// HRSVPTreeSearch.cc
+//========================================================================
+// Definitions for HRSVPTreeSearch
+
+#include "HRSVPTreeSearch.h"
+
+#include "Image.h"
+#include "VPTree.h"
+#include "Vector.h"
+#include "mnist-utils.h"
+#include <cmath>
+
+double HRSVPTreeSearch::Distance::operator()( const Image& a, const Image& b )
+{
+  return std::sqrt( (double) a.distance( b ) );
+}
+
+//------------------------------------------------------------------------
+// HRSVPTreeSearch
+//------------------------------------------------------------------------
+// The default constructor for the HRSVPTreeSearch class
+
+HRSVPTreeSearch::HRSVPTreeSearch( int leaf_size )
+    : m_training_set( leaf_size, Distance() )
+{
+}
+
+//------------------------------------------------------------------------
+// train
+//------------------------------------------------------------------------
+// A function that builds the vantage-point tree from the given vector,
+// with duplicate images collapsed into one
+
+void HRSVPTreeSearch::train( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "train" );
+
+  Vector<Image> batch = dedup_images( vec );
+
+  ECE2400_PROFILE_SCOPE( "index build" );
+  m_training_set.build( batch );
+}
+
+//------------------------------------------------------------------------
+// add_samples
+//------------------------------------------------------------------------
+// A function that adds the given images to the vantage-point tree without
+// rebuilding it
+
+void HRSVPTreeSearch::add_samples( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "add_samples" );
+
+  Vector<Image> batch = dedup_images( vec );
+
+  ECE2400_PROFILE_SCOPE( "index build" );
+  for ( int i = 0; i < batch.size(); i++ ) {
+    m_training_set.add( batch[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// classify
+//------------------------------------------------------------------------
+// A function that finds the closest Image to the given Image using a
+// branch-and-bound search of the vantage-point tree
+
+Image HRSVPTreeSearch::classify( const Image& img )
+{
+  ECE2400_PROFILE_SCOPE( "classify" );
+  HRSStatsScope stats_scope( m_stats );
+
+  return m_training_set.find_closest( img );
+}
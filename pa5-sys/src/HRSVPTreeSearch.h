@@ -0,0 +1,55 @@
+//========================================================================
+// HRSVPTreeSearch.h
+//========================================================================
+// Handwritten recognition system that uses a vantage-point tree.
+
+#ifndef HRS_VPTREE_H
+#define HRS_VPTREE_H
+
+#include "IHandwritingRecSys.h"
+#include "Image.h"
+#include "VPTree.h"
+
+// Here we use forward declaration instead of #include. Forward
+// declaration is a declaration of an identifier (type, variable, or
+// class) before giving a complete definition.
+//
+// We should use forward declaration whenever possible. Using forward
+// declaration is almost always better than using #include because
+// #include may have some side effects such as:
+// - including other headers you don't need
+// - polluting the namespcae
+// - longer compilation time
+
+class Image;
+
+template <typename T>
+class Vector;
+
+//------------------------------------------------------------------------
+// HRSVPTreeSearch
+//------------------------------------------------------------------------
+// Exact nearest neighbor search. This is a drop-in replacement for
+// HRSTreeSearch that classifies exactly like HRSLinearSearch, but only
+// evaluates the distance to a fraction of the training images.
+
+class HRSVPTreeSearch : public IHandwritingRecSys {
+ public:
+  HRSVPTreeSearch( int leaf_size = 16 );
+
+  void  train( const Vector<Image>& vec );
+  void  add_samples( const Vector<Image>& vec );
+  Image classify( const Image& img );
+
+ private:
+  // Image::distance returns the squared euclidean distance, which does
+  // not obey the triangle inequality, so the tree works on its root.
+  class Distance {
+   public:
+    double operator()( const Image& a, const Image& b );
+  };
+
+  VPTree<Image, Distance> m_training_set;
+};
+
+#endif
@@ -0,0 +1,278 @@
+//========================================================================
+// Histogram.cc
+//========================================================================
+// Implementation of Histogram.
+
+#include "Histogram.h"
+#include "ece2400-stdlib.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+static const int width     = 22;
+static const int bar_width = 40;
+
+//------------------------------------------------------------------------
+// msb
+//------------------------------------------------------------------------
+// Position of the most significant set bit of a positive value
+
+static int msb( long long value )
+{
+  return 63 - __builtin_clzll( (unsigned long long) value );
+}
+
+//------------------------------------------------------------------------
+// Histogram
+//------------------------------------------------------------------------
+// Precision is the number of bits of each value that are kept, so with
+// the default of 5 bits every bucket is at most 1/32 of its lower bound
+// wide.
+
+Histogram::Histogram( int precision )
+{
+  if ( precision < 1 || precision > 16 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "precision must be within [1, 16]" );
+    throw e;
+  }
+  m_precision = precision;
+  clear();
+}
+
+void Histogram::clear()
+{
+  m_counts.clear();
+  m_count = 0;
+  m_min   = 0;
+  m_max   = 0;
+  m_sum   = 0.0;
+}
+
+//------------------------------------------------------------------------
+// bucket / bucket_low / bucket_high
+//------------------------------------------------------------------------
+// With S = 2^precision, values below 2S each get their own bucket. A
+// larger value whose top bit is at position m is shifted right by
+// m - precision, which leaves a mantissa in [S, 2S), and lands in bucket
+// shift * S + mantissa. Consecutive powers of two therefore map to
+// consecutive runs of S buckets.
+
+int Histogram::bucket( long long value ) const
+{
+  long long sub = 1LL << m_precision;
+  if ( value < 2 * sub )
+    return (int) value;
+  int shift = msb( value ) - m_precision;
+  return (int) ( (long long) shift * sub + ( value >> shift ) );
+}
+
+long long Histogram::bucket_low( int idx ) const
+{
+  long long sub = 1LL << m_precision;
+  if ( idx < 2 * sub )
+    return idx;
+  int       shift    = (int) ( idx / sub ) - 1;
+  long long mantissa = idx - (long long) shift * sub;
+  return mantissa << shift;
+}
+
+long long Histogram::bucket_high( int idx ) const
+{
+  long long sub = 1LL << m_precision;
+  if ( idx < 2 * sub )
+    return idx;
+  int       shift    = (int) ( idx / sub ) - 1;
+  long long mantissa = idx - (long long) shift * sub;
+  return ( ( mantissa + 1 ) << shift ) - 1;
+}
+
+//------------------------------------------------------------------------
+// record
+//------------------------------------------------------------------------
+
+void Histogram::record( long long value )
+{
+  if ( value < 0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "histogram values must not be negative" );
+    throw e;
+  }
+
+  size_t idx = (size_t) bucket( value );
+  if ( idx >= m_counts.size() )
+    m_counts.resize( idx + 1, 0 );
+  m_counts[idx]++;
+
+  if ( m_count == 0 || value < m_min )
+    m_min = value;
+  if ( m_count == 0 || value > m_max )
+    m_max = value;
+  m_count++;
+  m_sum += (double) value;
+}
+
+//------------------------------------------------------------------------
+// merge
+//------------------------------------------------------------------------
+// Adds the values of another histogram with the same precision, e.g.,
+// one recorded by another thread.
+
+void Histogram::merge( const Histogram& other )
+{
+  if ( other.m_precision != m_precision ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "histogram precisions do not match" );
+    throw e;
+  }
+  if ( other.m_count == 0 )
+    return;
+
+  if ( other.m_counts.size() > m_counts.size() )
+    m_counts.resize( other.m_counts.size(), 0 );
+  for ( size_t i = 0; i < other.m_counts.size(); i++ )
+    m_counts[i] += other.m_counts[i];
+
+  if ( m_count == 0 || other.m_min < m_min )
+    m_min = other.m_min;
+  if ( m_count == 0 || other.m_max > m_max )
+    m_max = other.m_max;
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+//------------------------------------------------------------------------
+// count / min / max / mean
+//------------------------------------------------------------------------
+
+long long Histogram::count() const
+{
+  return m_count;
+}
+
+long long Histogram::min() const
+{
+  return m_min;
+}
+
+long long Histogram::max() const
+{
+  return m_max;
+}
+
+double Histogram::mean() const
+{
+  return ( m_count > 0 ) ? m_sum / (double) m_count : 0.0;
+}
+
+//------------------------------------------------------------------------
+// percentile
+//------------------------------------------------------------------------
+// Returns the smallest bucket bound below which at least p percent of
+// the values fall. The result is never more than the largest recorded
+// value, so percentile( 100 ) is exactly max().
+
+long long Histogram::percentile( double p ) const
+{
+  if ( m_count == 0 )
+    return 0;
+
+  long long rank = (long long) std::ceil( p / 100.0 * (double) m_count );
+  if ( rank < 1 )
+    rank = 1;
+  if ( rank > m_count )
+    rank = m_count;
+
+  long long seen = 0;
+  for ( size_t i = 0; i < m_counts.size(); i++ ) {
+    seen += m_counts[i];
+    if ( seen >= rank ) {
+      long long high = bucket_high( (int) i );
+      return ( high < m_max ) ? high : m_max;
+    }
+  }
+  return m_max;
+}
+
+//------------------------------------------------------------------------
+// print_percentiles
+//------------------------------------------------------------------------
+// Prints the usual percentiles in the format of the eval programs.
+// Values are multiplied by scale first, e.g., 1e-3 to print nanoseconds
+// as microseconds.
+
+void Histogram::print_percentiles( const char* name, const char* unit,
+                                   double scale ) const
+{
+  const double      ps[]     = { 50.0, 90.0, 99.0, 99.9 };
+  const char* const labels[] = { "p50", "p90", "p99", "p99.9" };
+
+  std::string prefix = std::string( " - " ) + name + " ";
+
+  for ( int i = 0; i < 4; i++ )
+    std::cout << std::setw( width ) << std::left << ( prefix + labels[i] )
+              << " : " << (double) percentile( ps[i] ) * scale << " "
+              << unit << std::endl;
+
+  std::cout << std::setw( width ) << std::left << ( prefix + "max" )
+            << " : " << (double) m_max * scale << " " << unit << std::endl;
+  std::cout << std::setw( width ) << std::left << ( prefix + "mean" )
+            << " : " << mean() * scale << " " << unit << std::endl;
+}
+
+//------------------------------------------------------------------------
+// print
+//------------------------------------------------------------------------
+// Dumps the histogram with one row per power of two, which is coarse
+// enough to fit on a screen and fine enough to see the shape of a long
+// tail. Each row shows its range, its count, the cumulative share of
+// all values and a bar.
+
+void Histogram::print( const char* name, const char* unit,
+                       double scale ) const
+{
+  std::cout << " - " << name << " histogram (" << m_count << " values)"
+            << std::endl;
+  if ( m_count == 0 )
+    return;
+
+  // Row 0 holds the value 0 and row r > 0 holds [2^(r-1), 2^r)
+
+  std::vector<long long> rows( 65, 0 );
+  for ( size_t i = 0; i < m_counts.size(); i++ ) {
+    long long low = bucket_low( (int) i );
+    int       row = ( low == 0 ) ? 0 : msb( low ) + 1;
+    rows[(size_t) row] += m_counts[i];
+  }
+
+  long long most = 0;
+  for ( size_t r = 0; r < rows.size(); r++ )
+    most = ( rows[r] > most ) ? rows[r] : most;
+
+  long long seen = 0;
+  for ( size_t r = 0; r < rows.size(); r++ ) {
+    if ( rows[r] == 0 )
+      continue;
+    seen += rows[r];
+
+    double low  = ( r == 0 ) ? 0.0 : std::ldexp( 1.0, (int) r - 1 );
+    double high = ( r == 0 ) ? 1.0 : std::ldexp( 1.0, (int) r );
+    int    bars = (int) ( (double) bar_width * (double) rows[r] /
+                       (double) most );
+
+    std::cout << "   [" << std::setw( 10 ) << std::right << low * scale
+              << ", " << std::setw( 10 ) << high * scale << ") " << unit
+              << " " << std::setw( 8 ) << rows[r] << " " << std::fixed
+              << std::setprecision( 2 ) << std::setw( 7 )
+              << 100.0 * (double) seen / (double) m_count << "% "
+              << std::string( (size_t) bars, '#' ) << std::endl;
+    std::cout.unsetf( std::ios::floatfield );
+    std::cout << std::setprecision( 6 );
+  }
+}
@@ -0,0 +1,51 @@
+//========================================================================
+// Histogram.h
+//========================================================================
+// Declarations for a log-bucketed histogram.
+//
+// A Histogram records non-negative integer values (e.g., latencies in
+// nanoseconds) into buckets whose width grows with the value, in the
+// style of HdrHistogram. Every power of two is split into 2^precision
+// equally wide sub-buckets, so any recorded value is known to within a
+// relative error of 2^-precision no matter how large it is, while the
+// whole range of a long long fits in a few thousand counters. This
+// keeps recording constant time and lets percentiles deep in the tail
+// (p99.9) be read off without storing every value.
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <vector>
+
+class Histogram {
+ public:
+  Histogram( int precision = 5 );
+
+  // Methods
+  void      record( long long value );
+  void      merge( const Histogram& other );
+  void      clear();
+  long long count() const;
+  long long min() const;
+  long long max() const;
+  double    mean() const;
+  long long percentile( double p ) const;
+
+  void print_percentiles( const char* name, const char* unit,
+                          double scale = 1.0 ) const;
+  void print( const char* name, const char* unit, double scale = 1.0 ) const;
+
+ private:
+  int       bucket( long long value ) const;
+  long long bucket_low( int idx ) const;
+  long long bucket_high( int idx ) const;
+
+  int                    m_precision;
+  std::vector<long long> m_counts;
+  long long              m_count;
+  long long              m_min;
+  long long              m_max;
+  double                 m_sum;
+};
+
+#endif  // HISTOGRAM_H
@@ -0,0 +1,57 @@
+//========================================================================
+// IHandwritingRecSys.cc
+//========================================================================
+// Default implementations for the handwriting recognition systems.
+
+#include "IHandwritingRecSys.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+
+//------------------------------------------------------------------------
+// train_stream
+//------------------------------------------------------------------------
+// train replaces whatever the HRS held before, so an empty stream still
+// leaves an empty HRS behind.
+
+void IHandwritingRecSys::train_stream( LabeledImageStream& stream,
+                                       int                 batch_size )
+{
+  ECE2400_PROFILE_SCOPE( "train_stream" );
+
+  Vector<Image> batch;
+  bool          first = true;
+  while ( stream.next_batch( batch, batch_size ) ) {
+    if ( first )
+      train( batch );
+    else
+      add_samples( batch );
+    first = false;
+  }
+  if ( first )
+    train( batch );
+}
+
+//------------------------------------------------------------------------
+// classify_batch
+//------------------------------------------------------------------------
+
+Vector<Image> IHandwritingRecSys::classify_batch( const Vector<Image>& images )
+{
+  Vector<Image> results;
+  results.reserve( images.size() );
+  for ( int i = 0; i < images.size(); i++ )
+    results.push_back( classify( images[i] ) );
+  return results;
+}
+
+Vector<Image> IHandwritingRecSys::classify_batch( const Vector<Image>& images,
+                                                  Vector<int>& indices )
+{
+  indices = Vector<int>();
+  indices.reserve( images.size() );
+  for ( int i = 0; i < images.size(); i++ )
+    indices.push_back( -1 );
+  return classify_batch( images );
+}
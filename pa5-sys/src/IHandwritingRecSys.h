@@ -18,7 +18,10 @@
 // - polluting the namespcae
 // - longer compilation time
 
+#include "HRSStats.h"
+
 class Image;
+class LabeledImageStream;
 
 template <typename T>
 class Vector;
@@ -28,14 +31,46 @@ class Vector;
 //------------------------------------------------------------------------
 // Abstract base class for handwriting recognition systems (HRS)
 //
-// - train   : Train the HRS with a vector of labeled images
-// - classify: Classify an image and return a label
+// - train      : Train the HRS with a vector of labeled images
+// - add_samples: Add more labeled images to an already trained HRS. The
+//                cost should depend on the number of new images rather
+//                than on the number of images the HRS already holds.
+// - train_stream: Train the HRS with every image of a stream, reading
+//                one batch of batch_size images at a time. Only one
+//                batch is in memory besides what the HRS keeps. By
+//                default this trains with the first batch and adds the
+//                others with add_samples.
+// - classify   : Classify an image and return a label
+// - classify_batch: Classify several images at once, returning the
+//                result of each. An HRS may serve a batch with less
+//                work than classifying its images one at a time. By
+//                default this calls classify for every image. Given
+//                indices, it also returns the position of every result
+//                in the training set, or -1 where the HRS does not keep
+//                track of it; by default every index is -1.
+// - stats      : Work done by classify so far, summed over every query
+//                and thread (see HRSStats.h). An HRS that wraps another
+//                may report the stats of the wrapped one instead.
 //
 
 class IHandwritingRecSys {
  public:
-  virtual void  train( const Vector<Image>& v ) = 0;
-  virtual Image classify( const Image& image )  = 0;
+  virtual ~IHandwritingRecSys() {}
+
+  virtual void  train( const Vector<Image>& v )       = 0;
+  virtual void  add_samples( const Vector<Image>& v ) = 0;
+  virtual Image classify( const Image& image )        = 0;
+
+  virtual void train_stream( LabeledImageStream& stream, int batch_size );
+  virtual Vector<Image> classify_batch( const Vector<Image>& images );
+  virtual Vector<Image> classify_batch( const Vector<Image>& images,
+                                        Vector<int>&         indices );
+
+  virtual HRSStats stats() const { return hrs_stats_read( m_stats ); }
+  virtual void     reset_stats() { hrs_stats_clear( m_stats ); }
+
+ protected:
+  HRSStats m_stats;
 };
 
 #endif  // IHRS_H
@@ -4,7 +4,11 @@
 // Implementations for Image.
 
 #include "Image.h"
+#include "HRSStats.h"
 #include "ece2400-stdlib.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <iostream>
 
 //''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
@@ -60,9 +64,159 @@ Image::Image()
   m_cols      = 0;
   m_rows      = 0;
   m_intensity = 0;
+  m_norm      = 0;
+  m_sparse    = Vector<int>( NULL, 0 );
+  m_curve_key = 0;
+  m_pyramid   = Vector<int>( NULL, 0 );
   m_label     = '?';
 }
 
+//------------------------------------------------------------------------
+// square
+//------------------------------------------------------------------------
+// A function that returns the square of a given value
+
+int square( int x )
+{
+  return x * x;
+}
+
+//------------------------------------------------------------------------
+// make_curve_key
+//------------------------------------------------------------------------
+// The image is split into a curve_grid x curve_grid grid of regions and
+// the mean brightness of every region, quantized to curve_bits bits, is
+// a coordinate of a point. The key is the index of that point along a
+// Hilbert curve through the whole space, computed with Skilling's
+// algorithm ("Programming the Hilbert curve", AIP Conf. Proc. 707, 2004).
+//
+// Sorting images by their key puts images with similar region means
+// next to each other, which correlates with euclidean distance much
+// better than the total intensity does, while a Hilbert curve, unlike a
+// Z-order curve, never jumps between far apart points.
+
+const int curve_grid = 3;
+const int curve_dims = curve_grid * curve_grid;
+const int curve_bits = 64 / curve_dims;
+
+static unsigned long long hilbert_index( unsigned int* x )
+{
+  // Inverse undo excess work
+  unsigned int m = 1u << ( curve_bits - 1 );
+  for ( unsigned int q = m; q > 1; q >>= 1 ) {
+    unsigned int p = q - 1;
+    for ( int i = 0; i < curve_dims; i++ ) {
+      if ( x[i] & q ) {
+        x[0] ^= p;
+      }
+      else {
+        unsigned int t = ( x[0] ^ x[i] ) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for ( int i = 1; i < curve_dims; i++ )
+    x[i] ^= x[i - 1];
+  unsigned int t = 0;
+  for ( unsigned int q = m; q > 1; q >>= 1 ) {
+    if ( x[curve_dims - 1] & q )
+      t ^= q - 1;
+  }
+  for ( int i = 0; i < curve_dims; i++ )
+    x[i] ^= t;
+
+  // Interleave the bits, most significant first
+  unsigned long long key = 0;
+  for ( int b = curve_bits - 1; b >= 0; b-- ) {
+    for ( int i = 0; i < curve_dims; i++ )
+      key = ( key << 1 ) | ( ( x[i] >> b ) & 1u );
+  }
+  return key;
+}
+
+static unsigned long long make_curve_key( const Vector<int>& vec, int ncols,
+                                          int nrows )
+{
+  if ( ncols < curve_grid || nrows < curve_grid )
+    return 0;
+
+  long long sums[curve_dims]  = { 0 };
+  long long areas[curve_dims] = { 0 };
+  for ( int y = 0; y < nrows; y++ ) {
+    int gy = y * curve_grid / nrows;
+    for ( int x = 0; x < ncols; x++ ) {
+      int r = gy * curve_grid + x * curve_grid / ncols;
+      sums[r] += vec[y * ncols + x];
+      areas[r]++;
+    }
+  }
+
+  unsigned int       coords[curve_dims];
+  unsigned long long top = ( 1ull << curve_bits ) - 1;
+  for ( int r = 0; r < curve_dims; r++ ) {
+    long long          sum = sums[r] < 0 ? 0 : sums[r];
+    unsigned long long c   = (unsigned long long) sum * top /
+                           ( (unsigned long long) areas[r] * 255 );
+    coords[r] = (unsigned int) ( c < top ? c : top );
+  }
+  return hilbert_index( coords );
+}
+
+//------------------------------------------------------------------------
+// make_pyramid
+//------------------------------------------------------------------------
+// Level g of the pyramid splits the image into a g x g grid of regions,
+// pixel (x, y) falling into region (x * g / ncols, y * g / nrows), and
+// holds the sum of every region. For 28x28 images the levels sum 7x7,
+// 4x4 and 2x2 blocks. Levels with more regions than the image has rows
+// or columns are left out, so images of the same size always have the
+// same levels.
+//
+// By Cauchy-Schwarz, the squared difference of two region sums is at
+// most the number of pixels in the region times the distance between the
+// two images restricted to the region. Summing over the regions of a
+// level gives a lower bound on the distance that only takes g * g
+// differences, and the finer the level, the tighter the bound.
+
+const int pyramid_levels[]  = { 4, 7, 14 };
+const int pyramid_nlevels   = 3;
+const int pyramid_max_level = 14;
+
+static bool has_level( int g, int ncols, int nrows )
+{
+  return g <= ncols && g <= nrows;
+}
+
+// Pixels in the largest region of level g
+static long long level_area( int g, int ncols, int nrows )
+{
+  return (long long) ( ( ncols + g - 1 ) / g ) * ( ( nrows + g - 1 ) / g );
+}
+
+static Vector<int> make_pyramid( const Vector<int>& vec, int ncols,
+                                 int nrows )
+{
+  Vector<int> pyramid;
+  for ( int l = 0; l < pyramid_nlevels; l++ ) {
+    int g = pyramid_levels[l];
+    if ( !has_level( g, ncols, nrows ) )
+      continue;
+
+    int sums[pyramid_max_level * pyramid_max_level] = { 0 };
+    for ( int y = 0; y < nrows; y++ ) {
+      int gy = y * g / nrows;
+      for ( int x = 0; x < ncols; x++ )
+        sums[gy * g + x * g / ncols] += vec[y * ncols + x];
+    }
+    for ( int r = 0; r < g * g; r++ )
+      pyramid.push_back( sums[r] );
+  }
+  return pyramid;
+}
+
 //------------------------------------------------------------------------
 // Image( const VectorInt& vec, int ncols, int nrows )
 //------------------------------------------------------------------------
@@ -86,10 +240,23 @@ Image::Image( const Vector<int>& vec, int ncols, int nrows )
   m_cols      = ncols;
   m_rows      = nrows;
   m_intensity = 0;
+  m_norm      = 0;
+  int nonzero = 0;
   for ( int i = 0; i < size; i++ ) {
     m_intensity = m_intensity + vec[i];
+    m_norm      = m_norm + square( vec[i] );
+    nonzero     = nonzero + ( vec[i] != 0 );
+  }
+  m_sparse.reserve( 2 * nonzero );
+  for ( int i = 0; i < size; i++ ) {
+    if ( vec[i] != 0 ) {
+      m_sparse.push_back( i );
+      m_sparse.push_back( vec[i] );
+    }
   }
-  m_label = '?';
+  m_curve_key = make_curve_key( vec, ncols, nrows );
+  m_pyramid   = make_pyramid( vec, ncols, nrows );
+  m_label     = '?';
 }
 
 //------------------------------------------------------------------------
@@ -158,30 +325,66 @@ int Image::get_intensity() const
 }
 
 //------------------------------------------------------------------------
-// square
+// distance
 //------------------------------------------------------------------------
-// A function that returns the square of a given value
+// A function that returns the euclidean distance between one image and another
 
-int square( int x )
+static void check_dimensions( const Image& a, const Image& b )
 {
-  return x * x;
+  int size = a.get_ncols() * a.get_nrows();
+  if ( size != b.get_nrows() * b.get_ncols() ||
+       ( a.get_nrows() != b.get_nrows() && a.get_ncols() != b.get_ncols() ) ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "dimensions of images do not match" );
+    throw e;
+  }
+}
+
+int Image::distance( const Image& other ) const
+{
+  ECE2400_PROFILE_SCOPE( "distance" );
+  HRS_STATS_ADD( distance_calls, 1 );
+
+  check_dimensions( *this, other );
+  return pixel_distance( other );
 }
 
 //------------------------------------------------------------------------
-// distance
+// Distance kernels
 //------------------------------------------------------------------------
-// A function that returns the euclidean distance between one image and another
+// The dense kernel sums the squared difference of every pair of pixels,
+// which the compiler vectorizes. The sparse kernel expands the sum into
+// ||a||^2 + ||b||^2 - 2 a.b, where the squared norms are computed once
+// per image, and only the dot product is left for every distance. It
+// walks the nonzero pixels of whichever image has fewer of them and
+// reads the matching pixels of the other, so for an MNIST digit, where
+// about four pixels in five are zero, it touches a fraction of the
+// pixels, but as gathers that do not vectorize. Both compute exactly the
+// same integer.
 
-int Image::distance( const Image& other ) const
+namespace {
+
+std::atomic<int> kernel( Image::DENSE );
+
+}  // namespace
+
+int Image::pixel_distance( const Image& other ) const
 {
-  int total_distance = 0;
-  int size           = m_cols * m_rows;
-  if ( size != other.get_nrows() * other.get_ncols() ||
-       ( m_rows != other.get_nrows() && m_cols != other.get_ncols() ) ) {
-    ece2400::InvalidArgument e =
-        ece2400::InvalidArgument( "dimensions of images do not match" );
-    throw e;
+  if ( kernel.load( std::memory_order_relaxed ) == SPARSE ) {
+    // Index and value of every nonzero pixel, and the pixel it meets
+    HRS_STATS_ADD( bytes_touched,
+                   (size_t) std::min( m_sparse.size(), other.m_sparse.size() )
+                       / 2 * 3 * sizeof( int ) );
+    return sparse_distance( other );
   }
+  HRS_STATS_ADD( bytes_touched, (size_t) ( m_cols * m_rows ) * sizeof( int ) );
+  return dense_distance( other );
+}
+
+int Image::dense_distance( const Image& other ) const
+{
+  int size           = m_cols * m_rows;
+  int total_distance = 0;
   for ( int i = 0; i < size; i++ ) {
     int before_square = m_vector[i] - other.m_vector[i];
     total_distance    = total_distance + square( before_square );
@@ -189,6 +392,121 @@ int Image::distance( const Image& other ) const
   return total_distance;
 }
 
+int Image::sparse_distance( const Image& other ) const
+{
+  const Image& sparse = ( m_sparse.size() <= other.m_sparse.size() ) ? *this
+                                                                      : other;
+  const Image& dense  = ( &sparse == this ) ? other : *this;
+
+  int n   = sparse.m_sparse.size();
+  int dot = 0;
+  for ( int i = 0; i < n; i += 2 )
+    dot = dot + sparse.m_sparse[i + 1] * dense.m_vector[sparse.m_sparse[i]];
+  return m_norm + other.m_norm - 2 * dot;
+}
+
+//------------------------------------------------------------------------
+// set_distance_kernel / get_distance_kernel
+//------------------------------------------------------------------------
+
+void Image::set_distance_kernel( DistanceKernel k )
+{
+  kernel.store( k );
+}
+
+Image::DistanceKernel Image::get_distance_kernel()
+{
+  return (DistanceKernel) kernel.load();
+}
+
+//------------------------------------------------------------------------
+// choose_distance_kernel
+//------------------------------------------------------------------------
+// Times both kernels on every pair of up to choose_images images spread
+// over the set (which all have to be of the same size), choose_rounds
+// times each in turns, and keeps the fastest time of each so that a slow
+// round (e.g. the first one, with cold caches) does not decide. The
+// distances are not counted.
+
+const int choose_images = 32;
+const int choose_rounds = 5;
+
+Image::DistanceKernel Image::choose_distance_kernel( const Vector<Image>& vec )
+{
+  Vector<Image> sample;
+  int           step = vec.size() / choose_images + 1;
+  for ( int i = 0; i < vec.size(); i += step )
+    sample.push_back( vec[i] );
+
+  long long best[2] = { LLONG_MAX, LLONG_MAX };
+
+  volatile long long sink = 0;
+  for ( int r = 0; r < choose_rounds; r++ ) {
+    for ( int k = 0; k < 2; k++ ) {
+      long long start = ece2400::timer_now_ns();
+      long long sum   = 0;
+      for ( int i = 0; i < sample.size(); i++ ) {
+        for ( int j = 0; j < sample.size(); j++ ) {
+          sum += ( k == DENSE ) ? sample[i].dense_distance( sample[j] )
+                                : sample[i].sparse_distance( sample[j] );
+        }
+      }
+      sink              = sink + sum;
+      long long elapsed = ece2400::timer_now_ns() - start;
+      if ( elapsed < best[k] )
+        best[k] = elapsed;
+    }
+  }
+
+  DistanceKernel choice = ( best[SPARSE] < best[DENSE] ) ? SPARSE : DENSE;
+  set_distance_kernel( choice );
+  return choice;
+}
+
+//------------------------------------------------------------------------
+// distance_within
+//------------------------------------------------------------------------
+// A cascade over the levels of the pyramid, coarsest first: as soon as
+// the lower bound of a level reaches bound, that lower bound is returned and
+// the remaining levels and the pixels are never read. Only distances
+// that may be less than bound are computed in full. Either way this
+// counts as one distance; the ones cut short also count as pruned.
+
+int Image::distance_within( const Image& other, int bound ) const
+{
+  ECE2400_PROFILE_SCOPE( "distance" );
+  HRS_STATS_ADD( distance_calls, 1 );
+
+  check_dimensions( *this, other );
+
+  if ( bound < INT_MAX && m_pyramid.size() > 0 ) {
+    const int* a = &m_pyramid[0];
+    const int* b = &other.m_pyramid[0];
+    for ( int l = 0; l < pyramid_nlevels; l++ ) {
+      int g = pyramid_levels[l];
+      if ( !has_level( g, m_cols, m_rows ) )
+        continue;
+
+      long long sum = 0;
+      for ( int r = 0; r < g * g; r++ ) {
+        long long diff = a[r] - b[r];
+        sum += diff * diff;
+      }
+      HRS_STATS_ADD( bytes_touched, (size_t) ( g * g ) * sizeof( int ) );
+
+      long long lower = sum / level_area( g, m_cols, m_rows );
+      if ( lower >= bound ) {
+        HRS_STATS_ADD( pruned, 1 );
+        return (int) lower;
+      }
+      a += g * g;
+      b += g * g;
+    }
+  }
+
+  return pixel_distance( other );
+}
+
 //------------------------------------------------------------------------
 // display
 //------------------------------------------------------------------------
@@ -261,4 +579,31 @@ bool Image::operator!=( const Image& rhs ) const
 const int& Image::operator[]( int idx ) const
 {
   return m_vector[idx];
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------
+// hash
+//------------------------------------------------------------------------
+// A function that returns an FNV-1a hash of the pixels. Equal images
+// always have equal hashes, so the hash can be used to find exact
+// duplicates without comparing every pair of images.
+
+unsigned int Image::hash() const
+{
+  unsigned int h    = 2166136261u;
+  int          size = m_cols * m_rows;
+  for ( int i = 0; i < size; i++ ) {
+    h = ( h ^ (unsigned int) m_vector[i] ) * 16777619u;
+  }
+  return h;
+}
+
+//------------------------------------------------------------------------
+// curve_key
+//------------------------------------------------------------------------
+// Computed once when the image is constructed, see make_curve_key
+
+unsigned long long Image::curve_key() const
+{
+  return m_curve_key;
+}
@@ -15,6 +15,10 @@
 
 class Image {
  public:
+  // Ways of computing the distance between the pixels of two images (see
+  // Image.cc). They always give the same result.
+  enum DistanceKernel { DENSE, SPARSE };
+
   // Constructors
   Image();
   Image( const Vector<int>& vec, int ncols, int nrows );
@@ -27,6 +31,27 @@ class Image {
   char get_label() const;
   int  get_intensity() const;
   int  distance( const Image& other ) const;
+
+  // Returns the distance if it is less than bound, and otherwise some
+  // value that is at least bound, which is cheaper when lower bounds from
+  // the region sums already reach bound (see Image.cc).
+  int distance_within( const Image& other, int bound ) const;
+
+  unsigned int hash() const;
+
+  // Position of the image along a Hilbert curve through the mean
+  // brightness of a few regions (see Image.cc). Images close in
+  // euclidean distance tend to have close keys.
+  unsigned long long curve_key() const;
+
+  // The kernel is shared by every image and should only be changed while
+  // no distances are being computed. choose_distance_kernel times both
+  // kernels on a few images of the given set, switches to the faster one
+  // and returns it.
+  static void           set_distance_kernel( DistanceKernel kernel );
+  static DistanceKernel get_distance_kernel();
+  static DistanceKernel choose_distance_kernel( const Vector<Image>& vec );
+
   void print() const;
   void display() const;
 
@@ -36,14 +61,25 @@ class Image {
 
   const int& operator[]( int idx ) const;
 
+  // The pixels row by row, for loops that the compiler should vectorize
+  const int* pixels() const;
+
   friend std::ostream& operator<<( std::ostream& output, const Image& image );
 
  private:
-  Vector<int> m_vector;
-  int         m_cols;
-  int         m_rows;
-  int         m_intensity;
-  char        m_label;
+  int pixel_distance( const Image& other ) const;
+  int dense_distance( const Image& other ) const;
+  int sparse_distance( const Image& other ) const;
+
+  Vector<int>        m_vector;
+  int                m_cols;
+  int                m_rows;
+  int                m_intensity;
+  int                m_norm;    // sum of the squared pixels
+  Vector<int>        m_sparse;  // index and value of every nonzero pixel
+  unsigned long long m_curve_key;
+  Vector<int>        m_pyramid;  // region sums, coarsest level first
+  char               m_label;
 };
 
 // Include inline definitions
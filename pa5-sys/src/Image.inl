@@ -19,3 +19,12 @@
 // In other words, the executable size might be too big such that the
 // system may spend most of its time fetching the next chunk of code from
 // the disk.
+
+//------------------------------------------------------------------------
+// pixels
+//------------------------------------------------------------------------
+
+inline const int* Image::pixels() const
+{
+  return ( m_vector.size() > 0 ) ? &m_vector[0] : NULL;
+}
@@ -0,0 +1,230 @@
+//========================================================================
+// ImageDistorter.cc
+//========================================================================
+// Implementation of ImageDistorter.
+
+#include "ImageDistorter.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include <cmath>
+#include <utility>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int num_fields = 64;
+
+//------------------------------------------------------------------------
+// ImageDistorter
+//------------------------------------------------------------------------
+// The defaults are the ones Simard et al. used for MNIST, plus a small
+// shift and a little noise.
+
+ImageDistorter::ImageDistorter( unsigned int seed ) : m_rng( seed )
+{
+  m_alpha     = 34.0;
+  m_sigma     = 4.0;
+  m_max_shift = 2;
+  m_noise     = 8.0;
+  m_ncols     = 0;
+  m_nrows     = 0;
+}
+
+//------------------------------------------------------------------------
+// set_elastic / set_shift / set_noise
+//------------------------------------------------------------------------
+
+void ImageDistorter::set_elastic( double alpha, double sigma )
+{
+  if ( alpha < 0.0 || sigma < 0.0 ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "alpha and sigma must not be negative" );
+    throw e;
+  }
+  m_alpha = alpha;
+  m_sigma = sigma;
+
+  // The fields depend on both, so they are made again on the next image
+  m_ncols = 0;
+  m_nrows = 0;
+}
+
+void ImageDistorter::set_shift( int max_shift )
+{
+  if ( max_shift < 0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "max shift must not be negative" );
+    throw e;
+  }
+  m_max_shift = max_shift;
+}
+
+void ImageDistorter::set_noise( double stddev )
+{
+  if ( stddev < 0.0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "noise must not be negative" );
+    throw e;
+  }
+  m_noise = stddev;
+}
+
+//------------------------------------------------------------------------
+// make_fields
+//------------------------------------------------------------------------
+// Draws each displacement uniformly from [-1, 1], smooths the field with
+// a separable Gaussian (pixels beyond the border count as zero), and
+// scales it by alpha.
+
+static void smooth( std::vector<float>& field, int ncols, int nrows,
+                    const std::vector<float>& kernel )
+{
+  int                radius = (int) kernel.size() / 2;
+  std::vector<float> tmp( field.size(), 0.0f );
+
+  for ( int y = 0; y < nrows; y++ ) {
+    for ( int x = 0; x < ncols; x++ ) {
+      float sum = 0.0f;
+      for ( int k = -radius; k <= radius; k++ ) {
+        int xx = x + k;
+        if ( xx >= 0 && xx < ncols )
+          sum += kernel[(size_t) ( k + radius )] *
+                 field[(size_t) ( y * ncols + xx )];
+      }
+      tmp[(size_t) ( y * ncols + x )] = sum;
+    }
+  }
+
+  for ( int y = 0; y < nrows; y++ ) {
+    for ( int x = 0; x < ncols; x++ ) {
+      float sum = 0.0f;
+      for ( int k = -radius; k <= radius; k++ ) {
+        int yy = y + k;
+        if ( yy >= 0 && yy < nrows )
+          sum += kernel[(size_t) ( k + radius )] *
+                 tmp[(size_t) ( yy * ncols + x )];
+      }
+      field[(size_t) ( y * ncols + x )] = sum;
+    }
+  }
+}
+
+void ImageDistorter::make_fields( int ncols, int nrows )
+{
+  int size = ncols * nrows;
+
+  // Normalized Gaussian kernel that covers three standard deviations
+
+  int                radius = (int) std::ceil( 3.0 * m_sigma );
+  std::vector<float> kernel( (size_t) ( 2 * radius + 1 ), 1.0f );
+  if ( radius > 0 ) {
+    float total = 0.0f;
+    for ( int k = -radius; k <= radius; k++ ) {
+      float w = (float) std::exp( -(double) ( k * k ) /
+                                  ( 2.0 * m_sigma * m_sigma ) );
+      kernel[(size_t) ( k + radius )] = w;
+      total += w;
+    }
+    for ( size_t k = 0; k < kernel.size(); k++ )
+      kernel[k] /= total;
+  }
+
+  std::uniform_real_distribution<float> uniform( -1.0f, 1.0f );
+
+  m_dx.assign( (size_t) ( num_fields * size ), 0.0f );
+  m_dy.assign( (size_t) ( num_fields * size ), 0.0f );
+
+  std::vector<float> field( (size_t) size );
+  for ( int f = 0; f < num_fields; f++ ) {
+    for ( int d = 0; d < 2; d++ ) {
+      for ( int i = 0; i < size; i++ )
+        field[(size_t) i] = uniform( m_rng );
+      smooth( field, ncols, nrows, kernel );
+
+      std::vector<float>& out = ( d == 0 ) ? m_dx : m_dy;
+      for ( int i = 0; i < size; i++ )
+        out[(size_t) ( f * size + i )] = (float) m_alpha * field[(size_t) i];
+    }
+  }
+
+  m_ncols = ncols;
+  m_nrows = nrows;
+}
+
+//------------------------------------------------------------------------
+// distort
+//------------------------------------------------------------------------
+// Every output pixel samples the input at its own position moved by the
+// displacement and the shift, interpolating bilinearly between the four
+// nearest input pixels. Positions outside of the input read as zero.
+// The label is kept.
+
+Image ImageDistorter::distort( const Image& img )
+{
+  int ncols = img.get_ncols();
+  int nrows = img.get_nrows();
+  int size  = ncols * nrows;
+
+  if ( size == 0 )
+    return img;
+
+  if ( ncols != m_ncols || nrows != m_nrows )
+    make_fields( ncols, nrows );
+
+  // Pick a field and how to apply it
+
+  std::uniform_int_distribution<int>    pick( 0, num_fields - 1 );
+  std::uniform_int_distribution<int>    shift( -m_max_shift, m_max_shift );
+  std::uniform_int_distribution<int>    coin( 0, 1 );
+  std::uniform_real_distribution<float> amplitude( 0.5f, 1.0f );
+  std::normal_distribution<float>       noise(
+      0.0f, m_noise > 0.0 ? (float) m_noise : 1.0f );
+
+  const float* dx = &m_dx[(size_t) ( pick( m_rng ) * size )];
+  const float* dy = &m_dy[(size_t) ( pick( m_rng ) * size )];
+  if ( coin( m_rng ) )
+    std::swap( dx, dy );
+
+  float ax = amplitude( m_rng ) * ( coin( m_rng ) ? 1.0f : -1.0f );
+  float ay = amplitude( m_rng ) * ( coin( m_rng ) ? 1.0f : -1.0f );
+  int   sx = shift( m_rng );
+  int   sy = shift( m_rng );
+
+  Vector<int> pixels;
+  pixels.reserve( size );
+
+  for ( int y = 0; y < nrows; y++ ) {
+    for ( int x = 0; x < ncols; x++ ) {
+      int   i  = y * ncols + x;
+      float fx = (float) ( x - sx ) + ax * dx[i];
+      float fy = (float) ( y - sy ) + ay * dy[i];
+
+      int   x0 = (int) std::floor( fx );
+      int   y0 = (int) std::floor( fy );
+      float tx = fx - (float) x0;
+      float ty = fy - (float) y0;
+
+      float v = 0.0f;
+      for ( int k = 0; k < 4; k++ ) {
+        int xx = x0 + ( k & 1 );
+        int yy = y0 + ( k >> 1 );
+        if ( xx < 0 || xx >= ncols || yy < 0 || yy >= nrows )
+          continue;
+        float w = ( ( k & 1 ) ? tx : 1.0f - tx ) *
+                  ( ( k >> 1 ) ? ty : 1.0f - ty );
+        v += w * (float) img[yy * ncols + xx];
+      }
+
+      if ( m_noise > 0.0 )
+        v += noise( m_rng );
+
+      int p = (int) std::lround( v );
+      pixels.push_back( p < 0 ? 0 : ( p > 255 ? 255 : p ) );
+    }
+  }
+
+  Image result( pixels, ncols, nrows );
+  result.set_label( img.get_label() );
+  return result;
+}
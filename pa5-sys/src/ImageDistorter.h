@@ -0,0 +1,55 @@
+//========================================================================
+// ImageDistorter.h
+//========================================================================
+// Declarations for generating new images from existing ones.
+//
+// An ImageDistorter turns one image into a random variation of it, so
+// that a handful of real images can be grown into a dataset of any size
+// that still looks like handwriting. Each variation is
+//
+// - elastically distorted as in Simard et al., "Best Practices for
+//   Convolutional Neural Networks Applied to Visual Document Analysis":
+//   every pixel is moved by a random displacement field that has been
+//   smoothed with a Gaussian of width sigma and scaled by alpha,
+// - shifted by up to max_shift pixels in each direction, and
+// - noised by adding Gaussian noise with the given standard deviation,
+//   after which pixels are rounded and clamped to [0, 255].
+//
+// Smoothing a new displacement field for every image would dominate the
+// cost of generating millions of images, so a bank of smoothed fields is
+// made once per image size and every image picks one of them at random,
+// with a random amplitude, orientation and sign. The same seed always
+// produces the same images.
+
+#ifndef IMAGE_DISTORTER_H
+#define IMAGE_DISTORTER_H
+
+#include "Image.h"
+#include <random>
+#include <vector>
+
+class ImageDistorter {
+ public:
+  ImageDistorter( unsigned int seed = 0 );
+
+  // Methods
+  void  set_elastic( double alpha, double sigma );
+  void  set_shift( int max_shift );
+  void  set_noise( double stddev );
+  Image distort( const Image& img );
+
+ private:
+  void make_fields( int ncols, int nrows );
+
+  std::mt19937       m_rng;
+  double             m_alpha;
+  double             m_sigma;
+  int                m_max_shift;
+  double             m_noise;
+  int                m_ncols;  // size the fields were made for
+  int                m_nrows;
+  std::vector<float> m_dx;     // num_fields displacement fields
+  std::vector<float> m_dy;
+};
+
+#endif  // IMAGE_DISTORTER_H
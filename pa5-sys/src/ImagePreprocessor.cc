@@ -0,0 +1,334 @@
+//========================================================================
+// ImagePreprocessor.cc
+//========================================================================
+// Implementation of ImagePreprocessor.
+
+#include "ImagePreprocessor.h"
+#include "ece2400-stdlib.h"
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int default_box = 20;
+
+//------------------------------------------------------------------------
+// ImagePreprocessor
+//------------------------------------------------------------------------
+// By default images are put into the same form as MNIST digits, and
+// deskewed.
+
+ImagePreprocessor::ImagePreprocessor()
+{
+  m_box    = default_box;
+  m_center = true;
+  m_deskew = true;
+}
+
+//------------------------------------------------------------------------
+// set_crop / set_center / set_deskew
+//------------------------------------------------------------------------
+// A box larger than the image is limited to the image.
+
+void ImagePreprocessor::set_crop( int box )
+{
+  if ( box < 0 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "box must not be negative" );
+    throw e;
+  }
+  m_box = box;
+}
+
+void ImagePreprocessor::set_center( bool center )
+{
+  m_center = center;
+}
+
+void ImagePreprocessor::set_deskew( bool deskew )
+{
+  m_deskew = deskew;
+}
+
+//------------------------------------------------------------------------
+// Resampling
+//------------------------------------------------------------------------
+// A table maps every output pixel to the position start + step * i it
+// samples, as the index of the pixel before it counted from a zero
+// before the first pixel, and the weight of the pixel after it.
+// Positions that are entirely outside of the image are clamped to
+// either end with a weight of zero, so they read as zero.
+
+static void make_table( double start, double step, int n, int size,
+                        std::vector<int>& index, std::vector<float>& weight )
+{
+  index.resize( (size_t) n );
+  weight.resize( (size_t) n );
+  for ( int i = 0; i < n; i++ ) {
+    double pos = start + step * i;
+    double k   = std::floor( pos );
+    if ( k < -1.0 ) {
+      index[(size_t) i]  = 0;
+      weight[(size_t) i] = 0.0f;
+    }
+    else if ( k > size - 1 ) {
+      index[(size_t) i]  = size + 1;
+      weight[(size_t) i] = 0.0f;
+    }
+    else {
+      index[(size_t) i]  = (int) k + 1;
+      weight[(size_t) i] = (float) ( pos - k );
+    }
+  }
+}
+
+// Every output row blends two whole input rows
+static void resample_rows( const float* src, float* dst, int ncols,
+                           int nrows, const std::vector<int>& index,
+                           const std::vector<float>& weight,
+                           const float* zeros )
+{
+  for ( int y = 0; y < nrows; y++ ) {
+    int          r  = index[(size_t) y] - 1;
+    const float* a  = ( r >= 0 && r < nrows ) ? src + r * ncols : zeros;
+    const float* b  = ( r + 1 >= 0 && r + 1 < nrows ) ? src + ( r + 1 ) * ncols
+                                                      : zeros;
+    float        wb = weight[(size_t) y];
+    float        wa = 1.0f - wb;
+    float*       d  = dst + y * ncols;
+    for ( int x = 0; x < ncols; x++ )
+      d[x] = wa * a[x] + wb * b[x];
+  }
+}
+
+// Copies one row into the middle of row, which has ncols + 1 zeros on
+// both sides
+static const float* pad_row( const float* src, std::vector<float>& row,
+                             int ncols )
+{
+  std::copy( src, src + ncols, row.begin() + ( ncols + 1 ) );
+  return &row[(size_t) ( ncols + 1 )];
+}
+
+// Every row is resampled with the same table
+static void resample_cols( const float* src, float* dst, int ncols,
+                           int nrows, const std::vector<int>& index,
+                           const std::vector<float>& weight,
+                           std::vector<float>& row )
+{
+  for ( int y = 0; y < nrows; y++ ) {
+    const float* p = pad_row( src + y * ncols, row, ncols ) - 1;
+    float*       d = dst + y * ncols;
+    for ( int x = 0; x < ncols; x++ ) {
+      int   i = index[(size_t) x];
+      float w = weight[(size_t) x];
+      d[x]    = ( 1.0f - w ) * p[i] + w * p[i + 1];
+    }
+  }
+}
+
+// Row y is moved left by start + slope * y pixels, which keeps the inner
+// loop a blend of two contiguous runs
+static void shift_cols( const float* src, float* dst, int ncols, int nrows,
+                        double start, double slope, std::vector<float>& row )
+{
+  for ( int y = 0; y < nrows; y++ ) {
+    double shift = start + slope * y;
+    double k     = std::floor( shift );
+    float  w     = (float) ( shift - k );
+    k        = std::max( std::min( k, (double) ( ncols + 1 ) ),
+                         (double) -( ncols + 1 ) );
+
+    const float* p = pad_row( src + y * ncols, row, ncols ) + (int) k;
+    float*       d = dst + y * ncols;
+    for ( int x = 0; x < ncols; x++ )
+      d[x] = ( 1.0f - w ) * p[x] + w * p[x + 1];
+  }
+}
+
+//------------------------------------------------------------------------
+// column_sums
+//------------------------------------------------------------------------
+// Sums the ink, y times the ink and y squared times the ink of every
+// column. Accumulating whole rows keeps the loop free of reductions, so
+// it vectorizes without reordering floating point additions.
+
+static void column_sums( const float* pixels, int ncols, int nrows,
+                         std::vector<float>& sums )
+{
+  sums.assign( (size_t) ( 3 * ncols ), 0.0f );
+  float* s0 = &sums[0];
+  float* s1 = s0 + ncols;
+  float* s2 = s1 + ncols;
+  for ( int y = 0; y < nrows; y++ ) {
+    const float* p  = pixels + y * ncols;
+    float        fy = (float) y;
+    for ( int x = 0; x < ncols; x++ ) {
+      s0[x] += p[x];
+      s1[x] += fy * p[x];
+      s2[x] += fy * fy * p[x];
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// crop
+//------------------------------------------------------------------------
+
+void ImagePreprocessor::crop( Workspace& ws, int ncols, int nrows ) const
+{
+  float* pixels = &ws.pixels[0];
+
+  // Bounding box of the ink
+
+  column_sums( pixels, ncols, nrows, ws.sums );
+  int x0 = 0;
+  int x1 = ncols - 1;
+  while ( x0 < x1 && ws.sums[(size_t) x0] <= 0.0f )
+    x0++;
+  while ( x1 > x0 && ws.sums[(size_t) x1] <= 0.0f )
+    x1--;
+
+  int y0 = 0;
+  int y1 = nrows - 1;
+  while ( y0 < y1 && *std::max_element( pixels + y0 * ncols,
+                                        pixels + ( y0 + 1 ) * ncols ) <= 0.0f )
+    y0++;
+  while ( y1 > y0 && *std::max_element( pixels + y1 * ncols,
+                                        pixels + ( y1 + 1 ) * ncols ) <= 0.0f )
+    y1--;
+
+  // Scale the box so that its longer side fits and put it in the middle
+
+  int    box   = std::min( m_box, std::min( ncols, nrows ) );
+  double w     = x1 - x0 + 1;
+  double h     = y1 - y0 + 1;
+  double scale = box / std::max( w, h );
+  double offx  = ( ncols - w * scale ) / 2.0;
+  double offy  = ( nrows - h * scale ) / 2.0;
+
+  make_table( y0 + ( 0.5 - offy ) / scale - 0.5, 1.0 / scale, nrows, nrows,
+              ws.index, ws.weight );
+  resample_rows( pixels, &ws.tmp[0], ncols, nrows, ws.index, ws.weight,
+                 &ws.zeros[0] );
+
+  make_table( x0 + ( 0.5 - offx ) / scale - 0.5, 1.0 / scale, ncols, ncols,
+              ws.index, ws.weight );
+  resample_cols( &ws.tmp[0], pixels, ncols, nrows, ws.index, ws.weight,
+                 ws.row );
+}
+
+//------------------------------------------------------------------------
+// center_and_deskew
+//------------------------------------------------------------------------
+// Output pixel (x, y) samples the input at (x + dx + alpha (y + dy - cy),
+// y + dy), where (dx, dy) moves the center of mass (cx, cy) to the
+// middle and alpha is the slant. The vertical shift is the same for
+// every pixel and the horizontal shift is the same along a row, so this
+// is a pass over rows followed by a pass that shifts every row.
+
+void ImagePreprocessor::center_and_deskew( Workspace& ws, int ncols,
+                                           int nrows ) const
+{
+  float* pixels = &ws.pixels[0];
+
+  column_sums( pixels, ncols, nrows, ws.sums );
+  const float* s0 = &ws.sums[0];
+  const float* s1 = s0 + ncols;
+  const float* s2 = s1 + ncols;
+
+  double m   = 0.0;
+  double sx  = 0.0;
+  double sy  = 0.0;
+  double sxy = 0.0;
+  double syy = 0.0;
+  for ( int x = 0; x < ncols; x++ ) {
+    m += s0[x];
+    sx += (double) x * s0[x];
+    sy += s1[x];
+    sxy += (double) x * s1[x];
+    syy += s2[x];
+  }
+  if ( m <= 0.0 )
+    return;
+
+  double cx   = sx / m;
+  double cy   = sy / m;
+  double mu11 = sxy / m - cx * cy;
+  double mu02 = syy / m - cy * cy;
+
+  double dx    = m_center ? cx - ( ncols - 1 ) / 2.0 : 0.0;
+  double dy    = m_center ? cy - ( nrows - 1 ) / 2.0 : 0.0;
+  double alpha = ( m_deskew && mu02 > 1e-6 ) ? mu11 / mu02 : 0.0;
+
+  make_table( dy, 1.0, nrows, nrows, ws.index, ws.weight );
+  resample_rows( pixels, &ws.tmp[0], ncols, nrows, ws.index, ws.weight,
+                 &ws.zeros[0] );
+
+  shift_cols( &ws.tmp[0], pixels, ncols, nrows, dx + alpha * ( dy - cy ),
+              alpha, ws.row );
+}
+
+//------------------------------------------------------------------------
+// apply
+//------------------------------------------------------------------------
+
+Image ImagePreprocessor::process( const Image& img, Workspace& ws ) const
+{
+  int ncols = img.get_ncols();
+  int nrows = img.get_nrows();
+  int size  = ncols * nrows;
+
+  if ( size == 0 || ( m_box == 0 && !m_center && !m_deskew ) )
+    return img;
+
+  ws.pixels.resize( (size_t) size );
+  ws.tmp.resize( (size_t) size );
+  ws.result.resize( (size_t) size );
+  ws.zeros.assign( (size_t) ncols, 0.0f );
+  ws.row.assign( (size_t) ( 3 * ncols + 3 ), 0.0f );
+
+  const int* src    = &img[0];
+  float*     pixels = &ws.pixels[0];
+  int        ink    = 0;
+  for ( int i = 0; i < size; i++ ) {
+    pixels[i] = (float) src[i];
+    ink       = std::max( ink, src[i] );
+  }
+  if ( ink <= 0 )
+    return img;
+
+  if ( m_box > 0 )
+    crop( ws, ncols, nrows );
+  if ( m_center || m_deskew )
+    center_and_deskew( ws, ncols, nrows );
+
+  // Every pixel is a blend of pixels within [0, 255], so rounding is
+  // enough to bring it back to an int within [0, 255]
+
+  int* result = &ws.result[0];
+  for ( int i = 0; i < size; i++ )
+    result[i] = (int) ( pixels[i] + 0.5f );
+
+  Image out( Vector<int>( result, size ), ncols, nrows );
+  out.set_label( img.get_label() );
+  return out;
+}
+
+Image ImagePreprocessor::apply( const Image& img ) const
+{
+  Workspace ws;
+  return process( img, ws );
+}
+
+Vector<Image> ImagePreprocessor::apply( const Vector<Image>& vec ) const
+{
+  Workspace     ws;
+  Vector<Image> result;
+  result.reserve( vec.size() );
+  for ( int i = 0; i < vec.size(); i++ )
+    result.push_back( process( vec[i], ws ) );
+  return result;
+}
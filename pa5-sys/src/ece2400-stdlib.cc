@@ -8,9 +8,12 @@
 
 #include "ece2400-stdlib.h"
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <mutex>
 #include <string>
-#include <sys/time.h>
+#include <vector>
 
 const double ece2400::million = 1000000.0;
 
@@ -41,8 +44,12 @@ double ece2400::__double_expr1      = 0.0;
 // Timer variables
 //------------------------------------------------------------------------
 
-struct timeval ece2400::start_time;
-struct timeval ece2400::end_time;
+// Each thread has its own start time, so threads can time themselves
+// without interfering with each other.
+static thread_local long long timer_start_ns = 0;
+
+std::atomic<bool> ece2400::__profile_on(
+    std::getenv( "ECE2400_PROFILE" ) != nullptr );
 
 //------------------------------------------------------------------------
 // OutOfRange
@@ -127,7 +134,7 @@ void ece2400::sort( int* a, int size )
 
 void ece2400::timer_reset()
 {
-  gettimeofday( &ece2400::start_time, NULL );
+  timer_start_ns = ece2400::timer_now_ns();
 }
 
 //------------------------------------------------------------------------
@@ -137,13 +144,267 @@ void ece2400::timer_reset()
 
 double ece2400::timer_get_elapsed()
 {
-  gettimeofday( &ece2400::end_time, NULL );
-  double elapsed_sec =
-      (double) ( ece2400::end_time.tv_sec - ece2400::start_time.tv_sec );
-  double elapsed_usec =
-      (double) ( ece2400::end_time.tv_usec - ece2400::start_time.tv_usec );
-  double elapsed_time = elapsed_sec + ( elapsed_usec / ece2400::million );
-  return elapsed_time;
+  long long elapsed_ns = ece2400::timer_now_ns() - timer_start_ns;
+  return (double) elapsed_ns / ( ece2400::million * 1000.0 );
+}
+
+//------------------------------------------------------------------------
+// timer_now_ns
+//------------------------------------------------------------------------
+// CLOCK_MONOTONIC never jumps when the wall clock is adjusted, unlike
+// gettimeofday.
+
+long long ece2400::timer_now_ns()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (long long) ts.tv_sec * 1000000000LL + (long long) ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------
+// ProfileTree
+//------------------------------------------------------------------------
+// The regions recorded by one thread, as a tree of nodes linked by
+// index. Node 0 is an unnamed root that is never timed.
+
+namespace {
+
+struct ProfileNode {
+  const char*      name;
+  int              parent;
+  std::vector<int> children;
+  long long        calls;
+  long long        total_ns;
+};
+
+struct ProfileTree {
+  std::vector<ProfileNode> nodes;
+  int                      current;
+
+  ProfileTree();
+
+  int  child( int parent, const char* name );
+  void merge( const ProfileTree& tree, int node, int into );
+  void zero();
+};
+
+// The merged regions of every thread that has exited
+std::mutex  profile_mutex;
+ProfileTree profile_merged;
+
+// The regions of the calling thread. They are merged into
+// profile_merged when the thread exits. The main thread's copy goes
+// away before profile_merged does, so this is safe for every thread.
+struct ThreadProfile {
+  ProfileTree tree;
+
+  ~ThreadProfile()
+  {
+    std::lock_guard<std::mutex> lock( profile_mutex );
+    profile_merged.merge( tree, 0, 0 );
+  }
+};
+
+thread_local ThreadProfile profile_local;
+
+ProfileTree::ProfileTree()
+{
+  ProfileNode root;
+  root.name     = "";
+  root.parent   = -1;
+  root.calls    = 0;
+  root.total_ns = 0;
+  nodes.push_back( root );
+  current = 0;
+}
+
+// Returns the child of parent with the given name, creating it if this
+// is the first time the region is entered there. Most nodes have only
+// a few children, so a linear scan is fast.
+int ProfileTree::child( int parent, const char* name )
+{
+  const std::vector<int>& children = nodes[(size_t) parent].children;
+  for ( size_t i = 0; i < children.size(); i++ ) {
+    const char* child_name = nodes[(size_t) children[i]].name;
+    if ( child_name == name || std::strcmp( child_name, name ) == 0 )
+      return children[i];
+  }
+
+  ProfileNode node;
+  node.name     = name;
+  node.parent   = parent;
+  node.calls    = 0;
+  node.total_ns = 0;
+  nodes.push_back( node );
+
+  int idx = (int) nodes.size() - 1;
+  nodes[(size_t) parent].children.push_back( idx );
+  return idx;
+}
+
+// Adds the counts of the subtree of tree rooted at node to the subtree
+// of this tree rooted at into, matching regions by name.
+void ProfileTree::merge( const ProfileTree& tree, int node, int into )
+{
+  const ProfileNode& src = tree.nodes[(size_t) node];
+  for ( size_t i = 0; i < src.children.size(); i++ ) {
+    const ProfileNode& src_child = tree.nodes[(size_t) src.children[i]];
+    int                dst_child = child( into, src_child.name );
+    nodes[(size_t) dst_child].calls += src_child.calls;
+    nodes[(size_t) dst_child].total_ns += src_child.total_ns;
+    merge( tree, src.children[i], dst_child );
+  }
+}
+
+// Nodes are only zeroed, never removed, so regions that are open while
+// the profile is reset still have a node to record into.
+void ProfileTree::zero()
+{
+  for ( size_t i = 0; i < nodes.size(); i++ ) {
+    nodes[i].calls    = 0;
+    nodes[i].total_ns = 0;
+  }
+}
+
+// Merges the exited threads with the calling thread
+ProfileTree profile_snapshot()
+{
+  ProfileTree snapshot;
+  {
+    std::lock_guard<std::mutex> lock( profile_mutex );
+    snapshot.merge( profile_merged, 0, 0 );
+  }
+  snapshot.merge( profile_local.tree, 0, 0 );
+  return snapshot;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------
+// ScopedTimer
+//------------------------------------------------------------------------
+
+void ece2400::ScopedTimer::start( const char* name )
+{
+  ProfileTree& tree = profile_local.tree;
+  m_parent          = tree.current;
+  m_node            = tree.child( m_parent, name );
+  tree.current      = m_node;
+  m_start_ns        = ece2400::timer_now_ns();
+}
+
+void ece2400::ScopedTimer::stop()
+{
+  long long    elapsed = ece2400::timer_now_ns() - m_start_ns;
+  ProfileTree& tree    = profile_local.tree;
+  tree.nodes[(size_t) m_node].calls++;
+  tree.nodes[(size_t) m_node].total_ns += elapsed;
+  tree.current = m_parent;
+}
+
+//------------------------------------------------------------------------
+// profile_enable / profile_reset
+//------------------------------------------------------------------------
+
+void ece2400::profile_enable( bool enable )
+{
+  ece2400::__profile_on.store( enable );
+}
+
+bool ece2400::profile_enabled()
+{
+  return ece2400::__profile_on.load();
+}
+
+void ece2400::profile_reset()
+{
+  profile_local.tree.zero();
+  std::lock_guard<std::mutex> lock( profile_mutex );
+  profile_merged.zero();
+}
+
+//------------------------------------------------------------------------
+// profile_lookup
+//------------------------------------------------------------------------
+
+bool ece2400::profile_lookup( const std::string& path, long long* calls,
+                              long long* total_ns )
+{
+  ProfileTree tree = profile_snapshot();
+
+  int    node  = 0;
+  size_t begin = 0;
+  while ( begin <= path.size() ) {
+    size_t      end  = path.find( '/', begin );
+    std::string name = path.substr( begin, end - begin );
+
+    const std::vector<int>& children = tree.nodes[(size_t) node].children;
+    int                     next     = -1;
+    for ( size_t i = 0; i < children.size(); i++ ) {
+      if ( name == tree.nodes[(size_t) children[i]].name )
+        next = children[i];
+    }
+    if ( next < 0 )
+      return false;
+    node = next;
+
+    if ( end == std::string::npos )
+      break;
+    begin = end + 1;
+  }
+
+  const ProfileNode& found = tree.nodes[(size_t) node];
+  if ( calls != nullptr )
+    *calls = found.calls;
+  if ( total_ns != nullptr )
+    *total_ns = found.total_ns;
+  return found.calls > 0;
+}
+
+//------------------------------------------------------------------------
+// profile_print
+//------------------------------------------------------------------------
+
+static void profile_print_h( const ProfileTree& tree, int node, int depth,
+                             double total_ns )
+{
+  const ProfileNode& n = tree.nodes[(size_t) node];
+  if ( n.calls == 0 )
+    return;
+
+  long long children_ns = 0;
+  for ( size_t i = 0; i < n.children.size(); i++ )
+    children_ns += tree.nodes[(size_t) n.children[i]].total_ns;
+
+  // Children on other threads can add up to more than their parent
+  long long self_ns = std::max( 0LL, n.total_ns - children_ns );
+
+  std::string label = std::string( (size_t) ( 2 * depth ), ' ' ) + n.name;
+  std::printf( " %-32s %12lld %12.3f %12.3f %7.1f%%\n", label.c_str(),
+               n.calls, (double) n.total_ns / 1e6, (double) self_ns / 1e6,
+               ( total_ns > 0.0 ) ? 100.0 * (double) n.total_ns / total_ns
+                                  : 0.0 );
+
+  for ( size_t i = 0; i < n.children.size(); i++ )
+    profile_print_h( tree, n.children[i], depth + 1, total_ns );
+}
+
+void ece2400::profile_print()
+{
+  ProfileTree tree = profile_snapshot();
+
+  const std::vector<int>& top      = tree.nodes[0].children;
+  double                  total_ns = 0.0;
+  for ( size_t i = 0; i < top.size(); i++ )
+    total_ns += (double) tree.nodes[(size_t) top[i]].total_ns;
+
+  if ( total_ns <= 0.0 )
+    return;
+
+  std::printf( " %-32s %12s %12s %12s %8s\n", "region", "calls",
+               "total ms", "self ms", "share" );
+  for ( size_t i = 0; i < top.size(); i++ )
+    profile_print_h( tree, top[i], 0, total_ns );
 }
 
 //************************************************************************
@@ -9,16 +9,27 @@
 #ifndef ECE2400_STDLIB_H
 #define ECE2400_STDLIB_H
 
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <string>
-#include <sys/time.h>
 
 #define RED "\033[31m"
 #define GREEN "\033[32m"
 #define YELLOW "\033[33m"
 #define RESET "\033[0m"
 
+//------------------------------------------------------------------------
+// ECE2400_PROFILE_SCOPE( name_ )
+//------------------------------------------------------------------------
+// Times the rest of the enclosing scope as a profiling region with the
+// given name. See ece2400::ScopedTimer.
+
+#define ECE2400_PROFILE_CONCAT_( a_, b_ ) a_##b_
+#define ECE2400_PROFILE_CONCAT( a_, b_ ) ECE2400_PROFILE_CONCAT_( a_, b_ )
+#define ECE2400_PROFILE_SCOPE( name_ ) \
+  ece2400::ScopedTimer ECE2400_PROFILE_CONCAT( __scoped_timer_, __LINE__ )( name_ )
+
 //------------------------------------------------------------------------
 // ECE2400_UNUSED()
 //------------------------------------------------------------------------
@@ -175,11 +186,12 @@ extern double __double_expr0;
 extern double __double_expr1;
 
 //------------------------------------------------------------------------
-// Timer variables
+// Profiling variables
 //------------------------------------------------------------------------
 
-extern struct timeval start_time;
-extern struct timeval end_time;
+// Whether ScopedTimer records anything. Starts out true if the
+// ECE2400_PROFILE environment variable is set.
+extern std::atomic<bool> __profile_on;
 
 //------------------------------------------------------------------------
 // Exception
@@ -257,6 +269,85 @@ void timer_reset();
 
 double timer_get_elapsed();
 
+//------------------------------------------------------------------------
+// timer_now_ns
+//------------------------------------------------------------------------
+// Returns the time of a monotonic clock in nanoseconds. Only differences
+// between two readings are meaningful.
+
+long long timer_now_ns();
+
+//------------------------------------------------------------------------
+// ScopedTimer
+//------------------------------------------------------------------------
+// Times a named region from construction to destruction. Regions nest:
+// a region opened while another one is open on the same thread is
+// recorded as its child, so the same name can show up under different
+// parents (e.g., classify/distance and train/distance). Every thread
+// records into its own tree without locking, and a thread's tree is
+// merged into the process-wide profile when the thread exits. Regions
+// opened on a worker thread start at the top level of the profile.
+//
+// Names must be string literals (or otherwise outlive the program).
+// While profiling is disabled a ScopedTimer costs a single load.
+
+class ScopedTimer {
+ public:
+  explicit ScopedTimer( const char* name )
+      : m_node( -1 ), m_parent( -1 ), m_start_ns( 0 )
+  {
+    if ( __profile_on.load( std::memory_order_relaxed ) )
+      start( name );
+  }
+
+  ~ScopedTimer()
+  {
+    if ( m_node >= 0 )
+      stop();
+  }
+
+ private:
+  ScopedTimer( const ScopedTimer& );
+  ScopedTimer& operator=( const ScopedTimer& );
+
+  void start( const char* name );
+  void stop();
+
+  int       m_node;
+  int       m_parent;
+  long long m_start_ns;
+};
+
+//------------------------------------------------------------------------
+// profile_enable / profile_reset
+//------------------------------------------------------------------------
+// Turns recording on or off, and forgets everything recorded so far.
+// profile_reset only clears the calling thread and the regions of
+// threads that already exited.
+
+void profile_enable( bool enable );
+bool profile_enabled();
+void profile_reset();
+
+//------------------------------------------------------------------------
+// profile_lookup
+//------------------------------------------------------------------------
+// Looks up a region by its path (e.g., "classify/distance") and returns
+// how often it was entered and the total time spent in it. Returns false
+// if the region was never entered.
+
+bool profile_lookup( const std::string& path, long long* calls,
+                     long long* total_ns );
+
+//------------------------------------------------------------------------
+// profile_print
+//------------------------------------------------------------------------
+// Prints the aggregated profile as an indented tree with the number of
+// calls, the total and self time of each region, and its share of the
+// total time. Prints nothing if nothing was recorded.
+
+void profile_print();
+
 //------------------------------------------------------------------------
 // Check-macro helper functions
 //------------------------------------------------------------------------
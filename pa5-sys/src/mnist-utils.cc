@@ -10,12 +10,16 @@
 //   Date: Dec 31, 2020
 
 #include "mnist-utils.h"
+#include "Distance.h"
+#include "Histogram.h"
 #include "IHandwritingRecSys.h"
 #include "Image.h"
 #include "Vector.h"
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 //------------------------------------------------------------------------
 // constants
@@ -39,6 +43,8 @@ void read_labeled_images( const std::string& images_path,
                           const std::string& labels_path, Vector<Image>& vec,
                           int size )
 {
+  ECE2400_PROFILE_SCOPE( "load" );
+
   std::ifstream myifs;
 
   // MNIST has 4 misc values in image bin and 2 in label bin
@@ -49,8 +55,14 @@ void read_labeled_images( const std::string& images_path,
   // Read images
   //----------------------------------------------------------------------
 
-  Image* labeled_images = new Image[size];
-  int*   data           = new int[mnist_size];
+  // Images go straight into the vector, so a large dataset is only held
+  // in memory once
+
+  vec = Vector<Image>();  // Clear the data
+  vec.reserve( size );
+
+  unsigned char* bytes = new unsigned char[mnist_size];
+  int*           data  = new int[mnist_size];
 
   // Open binary file
 
@@ -64,19 +76,16 @@ void read_labeled_images( const std::string& images_path,
   for ( int i = 0; i < n_misc_in_image_file; i++ )
     myifs.read( (char*) &misc, 4 );
 
-  // Read each image (28 x 28 bytes) and add to the Image
+  // Read each image (28 x 28 bytes) with a single read and add it to the
+  // vector
 
   for ( int idx = 0; idx < size; idx++ ) {
-    for ( int i = 0; i < mnist_size; i++ ) {
-      int tmp = 0;
-      myifs.read( (char*) &tmp, 1 );
-      data[i] = tmp;
-    }
-
-    // Add this image to the array
+    myifs.read( (char*) bytes, mnist_size );
+    for ( int i = 0; i < mnist_size; i++ )
+      data[i] = bytes[i];
 
-    labeled_images[idx] =
-        Image( Vector<int>( data, mnist_size ), mnist_ncols, mnist_nrows );
+    vec.push_back(
+        Image( Vector<int>( data, mnist_size ), mnist_ncols, mnist_nrows ) );
   }
 
   // Close file
@@ -84,7 +93,7 @@ void read_labeled_images( const std::string& images_path,
   myifs.close();
 
   //----------------------------------------------------------------------
-  // Read images
+  // Read labels
   //----------------------------------------------------------------------
 
   // Open binary file
@@ -107,21 +116,368 @@ void read_labeled_images( const std::string& images_path,
     char label_char = (char) ( '0' + tmp );
 
     // Set label for the corresponding image
-    labeled_images[idx].set_label( label_char );
+    vec[idx].set_label( label_char );
   }
 
-  //----------------------------------------------------------------------
-  // Copy to the image vector
-  //----------------------------------------------------------------------
-
-  vec = Vector<Image>();  // Clear the data
-  for ( int i = 0; i < size; i++ )
-    vec.push_back( labeled_images[i] );
-
   // Clear dynamic memory
 
+  delete[] bytes;
   delete[] data;
-  delete[] labeled_images;
+}
+
+//------------------------------------------------------------------------
+// IDX headers
+//------------------------------------------------------------------------
+// IDX files start with a magic number that encodes the element type and
+// the number of dimensions, followed by the size of each dimension. All
+// of them are 4-byte big-endian integers.
+
+const int idx_images_magic = 0x00000803;  // unsigned bytes, 3 dimensions
+const int idx_labels_magic = 0x00000801;  // unsigned bytes, 1 dimension
+
+static void write_be32( std::ostream& os, int value )
+{
+  unsigned char bytes[4];
+  bytes[0] = (unsigned char) ( ( value >> 24 ) & 0xff );
+  bytes[1] = (unsigned char) ( ( value >> 16 ) & 0xff );
+  bytes[2] = (unsigned char) ( ( value >> 8 ) & 0xff );
+  bytes[3] = (unsigned char) ( value & 0xff );
+  os.write( (const char*) bytes, 4 );
+}
+
+static bool read_be32( std::istream& is, int& value )
+{
+  unsigned char bytes[4];
+  if ( !is.read( (char*) bytes, 4 ) )
+    return false;
+  value = (int) ( ( (unsigned) bytes[0] << 24 ) | ( (unsigned) bytes[1] << 16 ) |
+                  ( (unsigned) bytes[2] << 8 ) | (unsigned) bytes[3] );
+  return true;
+}
+
+//------------------------------------------------------------------------
+// count_labeled_images
+//------------------------------------------------------------------------
+
+int count_labeled_images( const std::string& images_path )
+{
+  std::ifstream ifs( images_path.c_str(), std::ios::in | std::ios::binary );
+
+  int magic = 0;
+  int count = 0;
+  if ( !read_be32( ifs, magic ) || magic != idx_images_magic ||
+       !read_be32( ifs, count ) || count < 0 )
+    return -1;
+  return count;
+}
+
+//------------------------------------------------------------------------
+// LabeledImageStream
+//------------------------------------------------------------------------
+
+LabeledImageStream::LabeledImageStream( const std::string& images_path,
+                                        const std::string& labels_path,
+                                        int                size )
+{
+  m_images.open( images_path.c_str(), std::ios::in | std::ios::binary );
+  m_labels.open( labels_path.c_str(), std::ios::in | std::ios::binary );
+
+  int magic  = 0;
+  int count  = 0;
+  int lmagic = 0;
+  int lcount = 0;
+  if ( !read_be32( m_images, magic ) || magic != idx_images_magic ||
+       !read_be32( m_images, count ) || !read_be32( m_images, m_nrows ) ||
+       !read_be32( m_images, m_ncols ) || !read_be32( m_labels, lmagic ) ||
+       lmagic != idx_labels_magic || !read_be32( m_labels, lcount ) ||
+       count != lcount || count < 0 || m_nrows < 1 || m_ncols < 1 ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "could not read matching IDX image and label files" );
+    throw e;
+  }
+
+  m_size = ( size >= 0 && size < count ) ? size : count;
+  m_read = 0;
+}
+
+int LabeledImageStream::size() const
+{
+  return m_size;
+}
+
+int LabeledImageStream::remaining() const
+{
+  return m_size - m_read;
+}
+
+//------------------------------------------------------------------------
+// LabeledImageStream::next_batch
+//------------------------------------------------------------------------
+// Replaces the contents of batch with the next batch_size images (fewer
+// at the end of the stream). Pixels and labels of the whole batch are
+// read with one read call each. Returns false once every image has been
+// read, leaving batch empty.
+
+bool LabeledImageStream::next_batch( Vector<Image>& batch, int batch_size )
+{
+  if ( batch_size < 1 ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "batch size must be positive" );
+    throw e;
+  }
+
+  batch = Vector<Image>();
+
+  int n = remaining() < batch_size ? remaining() : batch_size;
+  if ( n == 0 )
+    return false;
+
+  size_t img_size = (size_t) m_ncols * (size_t) m_nrows;
+  m_pixels.resize( (size_t) n * img_size );
+  m_tags.resize( (size_t) n );
+
+  if ( !m_images.read( (char*) &m_pixels[0],
+                       (std::streamsize) m_pixels.size() ) ||
+       !m_labels.read( (char*) &m_tags[0], n ) ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "IDX file ended early" );
+    throw e;
+  }
+
+  batch.reserve( n );
+
+  std::vector<int> data( img_size );
+  for ( int i = 0; i < n; i++ ) {
+    const unsigned char* src = &m_pixels[(size_t) i * img_size];
+    for ( size_t j = 0; j < img_size; j++ )
+      data[j] = src[j];
+
+    Image img( Vector<int>( &data[0], (int) img_size ), m_ncols, m_nrows );
+    img.set_label( (char) ( '0' + m_tags[(size_t) i] ) );
+    batch.push_back( img );
+  }
+
+  m_read += n;
+  return true;
+}
+
+//------------------------------------------------------------------------
+// write_labeled_images
+//------------------------------------------------------------------------
+// When appending, the count in both headers is patched in place and the
+// new images and labels are written at the end of the files, so a large
+// dataset can be written in batches that fit in memory.
+
+void write_labeled_images( const std::string& images_path,
+                           const std::string& labels_path,
+                           const Vector<Image>& vec, bool append )
+{
+  for ( int i = 0; i < vec.size(); i++ ) {
+    if ( vec[i].get_ncols() != mnist_ncols ||
+         vec[i].get_nrows() != mnist_nrows ) {
+      ece2400::InvalidArgument e =
+          ece2400::InvalidArgument( "images must be 28x28" );
+      throw e;
+    }
+    if ( vec[i].get_label() < '0' || vec[i].get_label() > '9' ) {
+      ece2400::InvalidArgument e =
+          ece2400::InvalidArgument( "labels must be digits" );
+      throw e;
+    }
+  }
+
+  std::ios::openmode mode = std::ios::in | std::ios::out | std::ios::binary;
+  if ( !append )
+    mode |= std::ios::trunc;
+
+  std::fstream images( images_path.c_str(), mode );
+  std::fstream labels( labels_path.c_str(), mode );
+
+  int count  = 0;
+  int lcount = 0;
+  int magic  = 0;
+  if ( append &&
+       ( !read_be32( images, magic ) || magic != idx_images_magic ||
+         !read_be32( images, count ) || !read_be32( labels, magic ) ||
+         magic != idx_labels_magic || !read_be32( labels, lcount ) ||
+         lcount != count ) ) {
+    ece2400::InvalidArgument e = ece2400::InvalidArgument(
+        "can only append to matching IDX image and label files" );
+    throw e;
+  }
+  if ( !images || !labels ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "could not open the output files" );
+    throw e;
+  }
+
+  // (Re)write the headers with the new count
+
+  count += vec.size();
+
+  images.seekp( 0, std::ios::beg );
+  write_be32( images, idx_images_magic );
+  write_be32( images, count );
+  write_be32( images, mnist_nrows );
+  write_be32( images, mnist_ncols );
+
+  labels.seekp( 0, std::ios::beg );
+  write_be32( labels, idx_labels_magic );
+  write_be32( labels, count );
+
+  // Write the images and labels after the existing ones
+
+  images.seekp( 0, std::ios::end );
+  labels.seekp( 0, std::ios::end );
+
+  unsigned char bytes[mnist_size];
+  for ( int idx = 0; idx < vec.size(); idx++ ) {
+    for ( int i = 0; i < mnist_size; i++ ) {
+      int v    = vec[idx][i];
+      bytes[i] = (unsigned char) ( v < 0 ? 0 : ( v > 255 ? 255 : v ) );
+    }
+    images.write( (const char*) bytes, mnist_size );
+
+    char label = (char) ( vec[idx].get_label() - '0' );
+    labels.write( &label, 1 );
+  }
+
+  if ( !images || !labels ) {
+    ece2400::InvalidArgument e =
+        ece2400::InvalidArgument( "could not write the output files" );
+    throw e;
+  }
+}
+
+//------------------------------------------------------------------------
+// dedup_images
+//------------------------------------------------------------------------
+// Finds duplicates with an open addressing hash table keyed on the pixel
+// hash, so only images with equal hashes are ever compared pixel by
+// pixel. Copies of the same image are chained together in input order,
+// and the label that reaches the highest count first wins.
+
+Vector<Image> dedup_images( const Vector<Image>& vec )
+{
+  ECE2400_PROFILE_SCOPE( "dedup" );
+
+  int size = vec.size();
+
+  int nslots = 1;
+  while ( nslots < 2 * size )
+    nslots *= 2;
+  unsigned int mask = (unsigned int) nslots - 1;
+
+  std::vector<unsigned int> hashes( (size_t) size );
+  std::vector<int>          slots( (size_t) nslots, -1 );
+  std::vector<int>          next( (size_t) size, -1 );
+  std::vector<int>          tail( (size_t) size, -1 );
+  std::vector<int>          firsts;
+
+  for ( int i = 0; i < size; i++ ) {
+    hashes[i]         = vec[i].hash();
+    unsigned int slot = hashes[i] & mask;
+
+    // Probe until we find a copy of this image or an empty slot
+
+    while ( slots[slot] != -1 ) {
+      int j = slots[slot];
+      if ( hashes[j] == hashes[i] && vec[j] == vec[i] )
+        break;
+      slot = ( slot + 1 ) & mask;
+    }
+
+    if ( slots[slot] == -1 ) {
+      slots[slot] = i;
+      tail[i]     = i;
+      firsts.push_back( i );
+    }
+    else {
+      int first         = slots[slot];
+      next[tail[first]] = i;
+      tail[first]       = i;
+    }
+  }
+
+  Vector<Image> unique;
+  unique.reserve( (int) firsts.size() );
+
+  for ( size_t i = 0; i < firsts.size(); i++ ) {
+    int   first = firsts[i];
+    Image img   = vec[first];
+
+    if ( next[first] != -1 ) {
+      int  counts[256] = {0};
+      int  best_count  = 0;
+      char best_label  = img.get_label();
+      for ( int j = first; j != -1; j = next[j] ) {
+        char label = vec[j].get_label();
+        int  count = ++counts[(unsigned char) label];
+        if ( count > best_count ) {
+          best_count = count;
+          best_label = label;
+        }
+      }
+      img.set_label( best_label );
+    }
+
+    unique.push_back( img );
+  }
+
+  return unique;
+}
+
+//------------------------------------------------------------------------
+// condense_images
+//------------------------------------------------------------------------
+// Hart's rule: start with a single prototype, then keep sweeping over
+// the images that are not prototypes yet and absorb every image the
+// current prototypes misclassify, until a whole sweep absorbs nothing.
+// The nearest prototype search is a parallel linear search, which is
+// where nearly all of the time goes, so its distances are cut short with
+// CascadeDistance.
+
+Vector<Image> condense_images( const Vector<Image>& vec )
+{
+  Vector<Image> protos;
+  condense_images_into( vec, protos );
+  return protos;
+}
+
+//------------------------------------------------------------------------
+// condense_images_into
+//------------------------------------------------------------------------
+// Same sweeps as above, except that the prototypes may already hold
+// images from an earlier batch.
+
+void condense_images_into( const Vector<Image>& vec, Vector<Image>& protos )
+{
+  ECE2400_PROFILE_SCOPE( "condense" );
+
+  if ( vec.size() == 0 )
+    return;
+
+  std::vector<bool> absorbed( (size_t) vec.size(), false );
+  if ( protos.size() == 0 ) {
+    protos.push_back( vec[0] );
+    absorbed[0] = true;
+  }
+
+  bool changed = true;
+  while ( changed ) {
+    changed = false;
+    for ( int i = 0; i < vec.size(); i++ ) {
+      if ( absorbed[i] )
+        continue;
+      Image nearest =
+          protos.parallel_linear_search( vec[i], CascadeDistance() );
+      if ( nearest.get_label() != vec[i].get_label() ) {
+        protos.push_back( vec[i] );
+        absorbed[i] = true;
+        changed     = true;
+      }
+    }
+  }
 }
 
 //------------------------------------------------------------------------
@@ -181,10 +537,14 @@ double train_and_classify( IHandwritingRecSys&  hrs,
 // classify_with_progress_bar
 //------------------------------------------------------------------------
 // Takes a handwriting recognition system, runs classfication on the given
-// testing set and prints a progress bar, and returns the accuracy.
+// testing set and prints a progress bar unless show_progress is false,
+// and returns the accuracy.
 
 double classify_with_progress_bar( IHandwritingRecSys&  hrs,
-                                   const Vector<Image>& v_test )
+                                   const Vector<Image>& v_test,
+                                   Histogram*           latency_ns,
+                                   Histogram*           distances,
+                                   bool                 show_progress )
 {
   // Return 0 if testing set is empty to avoid devide by 0
 
@@ -209,15 +569,23 @@ double classify_with_progress_bar( IHandwritingRecSys&  hrs,
     Image test_image = v_test[i];
     test_image.set_label( '?' );
 
+    long long start_ns    = ece2400::timer_now_ns();
+    HRSStats  start_stats = hrs_stats_local();
+
     Image clf_result = hrs.classify( test_image );
 
+    if ( latency_ns != nullptr )
+      latency_ns->record( ece2400::timer_now_ns() - start_ns );
+    if ( distances != nullptr )
+      distances->record( hrs_stats_since( start_stats ).distance_calls );
+
     char predicted_lable = clf_result.get_label();
     char correct_label   = v_test[i].get_label();
     if ( predicted_lable == correct_label )
       num_correct++;
 
     // Progress bar
-    if ( i % frac_size == 0 ) {
+    if ( show_progress && i % frac_size == 0 ) {
       int n_markers = i / frac_size;
 
       std::cout << "[ ";
@@ -247,8 +615,46 @@ double classify_with_progress_bar( IHandwritingRecSys&  hrs,
   }
 
   // Delete output and reset cursor
-  std::cout << cursor_e << cursor_d << cursor_e << cursor_d << cursor_e
-            << cursor_u << cursor_u;
+  if ( show_progress )
+    std::cout << cursor_e << cursor_d << cursor_e << cursor_d << cursor_e
+              << cursor_u << cursor_u;
 
   return (double) num_correct / (double) test_size;
 }
+
+//------------------------------------------------------------------------
+// take_flag
+//------------------------------------------------------------------------
+
+bool take_flag( int& argc, char** argv, const char* flag )
+{
+  bool found = false;
+  int  j     = 1;
+  for ( int i = 1; i < argc; i++ ) {
+    if ( std::strcmp( argv[i], flag ) == 0 )
+      found = true;
+    else
+      argv[j++] = argv[i];
+  }
+  argc = j;
+  return found;
+}
+
+//------------------------------------------------------------------------
+// take_option
+//------------------------------------------------------------------------
+
+std::string take_option( int& argc, char** argv, const char* name )
+{
+  std::string value;
+  size_t      len = std::strlen( name );
+  int         j   = 1;
+  for ( int i = 1; i < argc; i++ ) {
+    if ( std::strncmp( argv[i], name, len ) == 0 && argv[i][len] == '=' )
+      value = argv[i] + len + 1;
+    else
+      argv[j++] = argv[i];
+  }
+  argc = j;
+  return value;
+}
@@ -15,9 +15,12 @@
 #include "Image.h"
 #include "Vector.h"
 #include <cstddef>
+#include <fstream>
 #include <string>
+#include <vector>
 
 class IHandwritingRecSys;
+class Histogram;
 
 //------------------------------------------------------------------------
 // read_labeled_images
@@ -29,6 +32,92 @@ void read_labeled_images( const std::string& images_path,
                           const std::string& labels_path, Vector<Image>& vec,
                           int size );
 
+//------------------------------------------------------------------------
+// LabeledImageStream
+//------------------------------------------------------------------------
+// Reads labeled images from an images and a labels file in the IDX
+// format a batch at a time, so a dataset never has to be in memory all
+// at once. If size is not negative, only the first size images are
+// read. Throws InvalidArgument if the files cannot be opened, are not
+// IDX files, hold different numbers of images and labels, or end early.
+
+class LabeledImageStream {
+ public:
+  LabeledImageStream( const std::string& images_path,
+                      const std::string& labels_path, int size = -1 );
+
+  // Methods
+  int  size() const;
+  int  remaining() const;
+  bool next_batch( Vector<Image>& batch, int batch_size );
+
+ private:
+  // Streams cannot be copied
+  LabeledImageStream( const LabeledImageStream& );
+  LabeledImageStream& operator=( const LabeledImageStream& );
+
+  std::ifstream              m_images;
+  std::ifstream              m_labels;
+  int                        m_size;
+  int                        m_read;
+  int                        m_ncols;
+  int                        m_nrows;
+  std::vector<unsigned char> m_pixels;  // pixels of the current batch
+  std::vector<unsigned char> m_tags;    // labels of the current batch
+};
+
+//------------------------------------------------------------------------
+// count_labeled_images
+//------------------------------------------------------------------------
+// Returns the number of images in an IDX images file according to its
+// header, or -1 if the file cannot be read or is not an IDX images file.
+
+int count_labeled_images( const std::string& images_path );
+
+//------------------------------------------------------------------------
+// write_labeled_images
+//------------------------------------------------------------------------
+// Writes 28x28 labeled images in the IDX format read by
+// read_labeled_images. Pixels are clamped to [0, 255] and labels must
+// be the characters '0' to '9'. If append is true, the images are added
+// to the end of existing files written by this function instead.
+
+void write_labeled_images( const std::string& images_path,
+                           const std::string& labels_path,
+                           const Vector<Image>& vec, bool append = false );
+
+//------------------------------------------------------------------------
+// dedup_images
+//------------------------------------------------------------------------
+// Returns a copy of the given images with pixel-identical images
+// collapsed into one. Each remaining image carries the most common label
+// among its copies, and images keep the order of their first occurrence.
+
+Vector<Image> dedup_images( const Vector<Image>& vec );
+
+//------------------------------------------------------------------------
+// condense_images
+//------------------------------------------------------------------------
+// Selects a subset of prototypes from the given labeled images using
+// Hart's condensed nearest neighbor rule. Classifying any of the given
+// images by its nearest prototype yields the image's own label, so a
+// 1-NN classifier trained on the subset behaves like one trained on all
+// images while scanning far fewer of them.
+
+Vector<Image> condense_images( const Vector<Image>& vec );
+
+//------------------------------------------------------------------------
+// condense_images_into
+//------------------------------------------------------------------------
+// Condenses the given images into an existing set of prototypes. Only
+// images the current prototypes misclassify are added, and afterwards
+// every one of the given images is classified correctly. Images that
+// were condensed into the prototypes earlier are not checked again, so
+// a new prototype with another label can end up closest to some of them;
+// only the current batch is guaranteed to be classified correctly.
+
+void condense_images_into( const Vector<Image>& vec, Vector<Image>& protos );
+
 //------------------------------------------------------------------------
 // train_and_classify
 //------------------------------------------------------------------------
@@ -45,9 +134,35 @@ double train_and_classify( IHandwritingRecSys&  hrs,
 // classify_with_progress_bar
 //------------------------------------------------------------------------
 // Takes a handwriting recognition system, runs classfication on the given
-// testing set and prints a progress bar.
+// testing set and prints a progress bar. If given, the latency of every
+// classify call in nanoseconds and the number of distances it computed
+// are recorded into the histograms. Distances are counted by HRSStats,
+// so they read as zero when configured with -DHRS_STATS=OFF. Without show_progress nothing is
+// printed, so that programs which classify the same testing set many
+// times (e.g., hrs-sweep) can keep their output machine readable.
 
 double classify_with_progress_bar( IHandwritingRecSys&  hrs,
-                                   const Vector<Image>& v_test );
+                                   const Vector<Image>& v_test,
+                                   Histogram*           latency_ns    = nullptr,
+                                   Histogram*           distances     = nullptr,
+                                   bool                 show_progress = true );
+
+//------------------------------------------------------------------------
+// take_flag
+//------------------------------------------------------------------------
+// Removes every occurrence of the given flag (e.g., "--perf-counters")
+// from the command line arguments and returns whether there was one, so
+// that the eval programs can keep parsing their positional arguments
+// by position.
+
+bool take_flag( int& argc, char** argv, const char* flag );
+
+//------------------------------------------------------------------------
+// take_option
+//------------------------------------------------------------------------
+// Like take_flag, but for options of the form <name>=<value>. Returns
+// the value of the last occurrence, or an empty string if there is none.
+
+std::string take_option( int& argc, char** argv, const char* name );
 
 #endif  // MNIST_UTILS_H
@@ -0,0 +1,202 @@
+//========================================================================
+// arena-directed-test.cc
+//========================================================================
+// This file contains directed tests for Arena<int> and Arena<Image>
+
+#include "Arena.h"
+#include "Image.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// mk_1x1
+//------------------------------------------------------------------------
+
+Image mk_1x1( int value )
+{
+  int         data[] = {value};
+  Vector<int> vec( data, 1 );
+  return Image( vec, 1, 1 );
+}
+
+//------------------------------------------------------------------------
+// test_case_1_alloc
+//------------------------------------------------------------------------
+// Handles are handed out in order and refer to the allocated values.
+
+void test_case_1_alloc()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Arena<int> arena( 4 );
+  ECE2400_CHECK_INT_EQ( arena.size(), 0 );
+
+  for ( int i = 0; i < 3; i++ )
+    ECE2400_CHECK_INT_EQ( arena.alloc( 10 * i ), i );
+
+  ECE2400_CHECK_INT_EQ( arena.size(), 3 );
+  ECE2400_CHECK_INT_EQ( arena[0], 0 );
+  ECE2400_CHECK_INT_EQ( arena[1], 10 );
+  ECE2400_CHECK_INT_EQ( arena[2], 20 );
+
+  arena[1] = 42;
+  ECE2400_CHECK_INT_EQ( arena[1], 42 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_many_slabs
+//------------------------------------------------------------------------
+// Allocating across many slabs keeps every value in place. The slab
+// size is not a power of two to test rounding.
+
+void test_case_2_many_slabs()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Arena<int> arena( 3 );
+
+  int* first = nullptr;
+  for ( int i = 0; i < 1000; i++ ) {
+    arena.alloc( i );
+    if ( i == 0 )
+      first = &arena[0];
+  }
+
+  ECE2400_CHECK_INT_EQ( arena.size(), 1000 );
+
+  // Objects never move once allocated
+  ECE2400_CHECK_TRUE( first == &arena[0] );
+
+  for ( int i = 0; i < 1000; i++ )
+    ECE2400_CHECK_INT_EQ( arena[i], i );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_clear
+//------------------------------------------------------------------------
+// Clearing frees everything and the arena can be reused.
+
+void test_case_3_clear()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Arena<Image> arena( 2 );
+
+  for ( int i = 0; i < 7; i++ )
+    arena.alloc( mk_1x1( i ) );
+
+  arena.clear();
+  ECE2400_CHECK_INT_EQ( arena.size(), 0 );
+
+  for ( int i = 0; i < 5; i++ )
+    ECE2400_CHECK_INT_EQ( arena.alloc( mk_1x1( 100 + i ) ), i );
+
+  for ( int i = 0; i < 5; i++ )
+    ECE2400_CHECK_INT_EQ( arena[i].get_intensity(), 100 + i );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_copy
+//------------------------------------------------------------------------
+// Copies are deep and keep every value under the same handle.
+
+void test_case_4_copy()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Arena<Image> arena0( 4 );
+  for ( int i = 0; i < 10; i++ )
+    arena0.alloc( mk_1x1( i ) );
+
+  // Copy constructor
+
+  Arena<Image> arena1( arena0 );
+
+  // Assignment operator
+
+  Arena<Image> arena2( 16 );
+  arena2.alloc( mk_1x1( 42 ) );
+  arena2 = arena0;
+
+  // Self assignment
+
+  arena2 = arena2;
+
+  // Modify the original
+
+  arena0.clear();
+  arena0.alloc( mk_1x1( 99 ) );
+
+  ECE2400_CHECK_INT_EQ( arena1.size(), 10 );
+  ECE2400_CHECK_INT_EQ( arena2.size(), 10 );
+
+  for ( int i = 0; i < 10; i++ ) {
+    ECE2400_CHECK_INT_EQ( arena1[i].get_intensity(), i );
+    ECE2400_CHECK_INT_EQ( arena2[i].get_intensity(), i );
+  }
+
+  // The copies can keep growing
+
+  ECE2400_CHECK_INT_EQ( arena1.alloc( mk_1x1( 10 ) ), 10 );
+  ECE2400_CHECK_INT_EQ( arena1[10].get_intensity(), 10 );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_copy_empty
+//------------------------------------------------------------------------
+
+void test_case_5_copy_empty()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Arena<int> arena0;
+  Arena<int> arena1( arena0 );
+  ECE2400_CHECK_INT_EQ( arena1.size(), 0 );
+
+  ECE2400_CHECK_INT_EQ( arena1.alloc( 7 ), 0 );
+  ECE2400_CHECK_INT_EQ( arena1[0], 7 );
+  ECE2400_CHECK_INT_EQ( arena0.size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_6_invalid_slab_size
+//------------------------------------------------------------------------
+
+void test_case_6_invalid_slab_size()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  bool flag = false;
+  try {
+    Arena<int> arena( 0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_alloc();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_many_slabs();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_clear();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_copy();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_copy_empty();
+  if ( ( __n == 0 ) || ( __n == 6 ) ) test_case_6_invalid_slab_size();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
@@ -0,0 +1,234 @@
+//========================================================================
+// batching-classifier-directed-test.cc
+//========================================================================
+// This file contains directed tests for BatchingClassifier
+
+#include "BatchingClassifier.h"
+#include "HRSLinearSearch.h"
+#include "IHandwritingRecSys.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+//------------------------------------------------------------------------
+// mk_img
+//------------------------------------------------------------------------
+// Creates a 4x4 image whose pixels are all the given value
+
+Image mk_img( int value, char label )
+{
+  int data[16];
+  for ( int i = 0; i < 16; i++ )
+    data[i] = value;
+
+  Image img( Vector<int>( data, 16 ), 4, 4 );
+  img.set_label( label );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// GatedHRS
+//------------------------------------------------------------------------
+// An HRS that returns every query as it is, but does not return from
+// classify_batch until it is opened, so a test can hold a worker busy.
+// The index of every result is its first pixel.
+
+class GatedHRS : public IHandwritingRecSys {
+ public:
+  GatedHRS() : entered( 0 ), open( false ) {}
+
+  void  train( const Vector<Image>& ) {}
+  void  add_samples( const Vector<Image>& ) {}
+  Image classify( const Image& img ) { return img; }
+
+  Vector<Image> classify_batch( const Vector<Image>& images )
+  {
+    entered++;
+    while ( !open )
+      std::this_thread::yield();
+    return images;
+  }
+
+  Vector<Image> classify_batch( const Vector<Image>& images,
+                                Vector<int>&         indices )
+  {
+    indices = Vector<int>();
+    for ( int i = 0; i < images.size(); i++ )
+      indices.push_back( images[i][0] );
+    return classify_batch( images );
+  }
+
+  std::atomic<int>  entered;
+  std::atomic<bool> open;
+};
+
+//------------------------------------------------------------------------
+// test_case_1_classify
+//------------------------------------------------------------------------
+// Results are the ones of the HRS, whether they are waited for one at a
+// time or all submitted first. HRSLinearSearch does not know the index
+// of a result in memory.
+
+void test_case_1_classify()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> train;
+  for ( int i = 0; i < 10; i++ )
+    train.push_back( mk_img( i * 20, (char) ( '0' + i ) ) );
+
+  HRSLinearSearch hrs;
+  hrs.train( train );
+
+  BatchingClassifier server( hrs, 2, 16, 4, 1000 );
+
+  for ( int i = 0; i < 10; i++ ) {
+    Image result = server.classify( mk_img( i * 20 + 3, '?' ) );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), (char) ( '0' + i ) );
+  }
+
+  std::future<Image> results[10];
+  int                indices[10];
+  for ( int i = 0; i < 10; i++ )
+    ECE2400_CHECK_TRUE( server.try_submit( mk_img( i * 20 - 3, '?' ),
+                                           results[i], &indices[i] ) );
+  for ( int i = 0; i < 10; i++ ) {
+    ECE2400_CHECK_CHAR_EQ( results[i].get().get_label(),
+                           (char) ( '0' + i ) );
+    ECE2400_CHECK_INT_EQ( indices[i], -1 );
+  }
+
+  ECE2400_CHECK_INT_EQ( (int) server.requests(), 20 );
+  ECE2400_CHECK_INT_EQ( (int) server.rejected(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_batching
+//------------------------------------------------------------------------
+// Requests that queue up while the worker is busy are served as one
+// batch, and each gets back its own index.
+
+void test_case_2_batching()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  GatedHRS           hrs;
+  BatchingClassifier server( hrs, 1, 64, 64, 0 );
+
+  std::future<Image> first;
+  ECE2400_CHECK_TRUE( server.try_submit( mk_img( 0, 'a' ), first ) );
+  while ( hrs.entered == 0 )
+    std::this_thread::yield();
+
+  std::future<Image> rest[10];
+  int                rest_indices[10];
+  for ( int i = 0; i < 10; i++ )
+    ECE2400_CHECK_TRUE(
+        server.try_submit( mk_img( i, 'b' ), rest[i], &rest_indices[i] ) );
+
+  hrs.open = true;
+  ECE2400_CHECK_CHAR_EQ( first.get().get_label(), 'a' );
+  for ( int i = 0; i < 10; i++ ) {
+    ECE2400_CHECK_INT_EQ( rest[i].get()[0], i );
+    ECE2400_CHECK_INT_EQ( rest_indices[i], i );
+  }
+
+  ECE2400_CHECK_INT_EQ( (int) server.requests(), 11 );
+  ECE2400_CHECK_INT_EQ( (int) server.batches(), 2 );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_backpressure
+//------------------------------------------------------------------------
+// Once the queue is full, requests are turned away right away, and the
+// queued ones are still served.
+
+void test_case_3_backpressure()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  GatedHRS           hrs;
+  BatchingClassifier server( hrs, 1, 4, 64, 0 );
+
+  std::future<Image> results[5];
+  ECE2400_CHECK_TRUE( server.try_submit( mk_img( 0, 'a' ), results[0] ) );
+  while ( hrs.entered == 0 )
+    std::this_thread::yield();
+
+  for ( int i = 1; i < 5; i++ )
+    ECE2400_CHECK_TRUE( server.try_submit( mk_img( i, 'a' ), results[i] ) );
+
+  std::future<Image> turned_away;
+  ECE2400_CHECK_FALSE( server.try_submit( mk_img( 5, 'a' ), turned_away ) );
+  ECE2400_CHECK_INT_EQ( (int) server.rejected(), 1 );
+
+  bool flag = false;
+  try {
+    server.classify( mk_img( 6, 'a' ) );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  hrs.open = true;
+  for ( int i = 0; i < 5; i++ )
+    ECE2400_CHECK_INT_EQ( results[i].get()[0], i );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_errors
+//------------------------------------------------------------------------
+// Exceptions of the HRS reach the caller, and bad settings are refused.
+
+void test_case_4_errors()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  HRSLinearSearch    hrs;
+  BatchingClassifier server( hrs );
+
+  bool flag = false;
+  try {
+    server.classify( mk_img( 0, '?' ) );
+  }
+  catch ( ece2400::OutOfRange e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  flag = false;
+  try {
+    BatchingClassifier bad( hrs, 0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_classify();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_batching();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_backpressure();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_errors();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
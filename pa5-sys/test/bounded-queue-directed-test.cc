@@ -0,0 +1,150 @@
+//========================================================================
+// bounded-queue-directed-test.cc
+//========================================================================
+// This file contains directed tests for BoundedQueue
+
+#include "BoundedQueue.h"
+#include "ece2400-stdlib.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+// test_case_1_fifo
+//------------------------------------------------------------------------
+// Values come out in the order they went in, a full queue refuses
+// pushes, and an empty one refuses pops, lap after lap.
+
+void test_case_1_fifo()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  BoundedQueue<int> queue( 4 );
+  ECE2400_CHECK_INT_EQ( queue.capacity(), 4 );
+
+  int value = -1;
+  ECE2400_CHECK_FALSE( queue.try_pop( value ) );
+
+  for ( int lap = 0; lap < 3; lap++ ) {
+    for ( int i = 0; i < 4; i++ )
+      ECE2400_CHECK_TRUE( queue.try_push( lap * 10 + i ) );
+    ECE2400_CHECK_FALSE( queue.try_push( 99 ) );
+
+    for ( int i = 0; i < 4; i++ ) {
+      ECE2400_CHECK_TRUE( queue.try_pop( value ) );
+      ECE2400_CHECK_INT_EQ( value, lap * 10 + i );
+    }
+    ECE2400_CHECK_FALSE( queue.try_pop( value ) );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_2_capacity
+//------------------------------------------------------------------------
+
+void test_case_2_capacity()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  BoundedQueue<int> one( 1 );
+  ECE2400_CHECK_INT_EQ( one.capacity(), 2 );
+  ECE2400_CHECK_TRUE( one.try_push( 7 ) );
+  ECE2400_CHECK_TRUE( one.try_push( 8 ) );
+  ECE2400_CHECK_FALSE( one.try_push( 9 ) );
+
+  BoundedQueue<int> five( 5 );
+  ECE2400_CHECK_INT_EQ( five.capacity(), 8 );
+
+  bool flag = false;
+  try {
+    BoundedQueue<int> zero( 0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_mpmc
+//------------------------------------------------------------------------
+// Several producers and consumers share a small queue. Every value is
+// popped exactly once.
+
+const int num_threads = 4;
+const int num_values  = 20000;
+
+void produce( BoundedQueue<int>* queue, int first )
+{
+  for ( int i = first; i < num_values; i += num_threads ) {
+    while ( !queue->try_push( i ) )
+      std::this_thread::yield();
+  }
+}
+
+void consume( BoundedQueue<int>* queue, std::atomic<int>* popped,
+              std::vector<std::atomic<int>>* seen )
+{
+  while ( *popped < num_values ) {
+    int value;
+    if ( queue->try_pop( value ) ) {
+      ( *seen )[(size_t) value]++;
+      ( *popped )++;
+    }
+    else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void test_case_3_mpmc()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  BoundedQueue<int>             queue( 16 );
+  std::atomic<int>              popped( 0 );
+  std::vector<std::atomic<int>> seen( (size_t) num_values );
+  for ( int i = 0; i < num_values; i++ )
+    seen[(size_t) i] = 0;
+
+  std::vector<std::thread> threads;
+  for ( int t = 0; t < num_threads; t++ ) {
+    threads.push_back( std::thread( produce, &queue, t ) );
+    threads.push_back( std::thread( consume, &queue, &popped, &seen ) );
+  }
+  for ( size_t t = 0; t < threads.size(); t++ )
+    threads[t].join();
+
+  int wrong = 0;
+  for ( int i = 0; i < num_values; i++ )
+    if ( seen[(size_t) i] != 1 )
+      wrong++;
+  ECE2400_CHECK_INT_EQ( wrong, 0 );
+  ECE2400_CHECK_INT_EQ( popped.load(), num_values );
+
+  int value;
+  ECE2400_CHECK_FALSE( queue.try_pop( value ) );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_fifo();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_capacity();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_mpmc();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
@@ -0,0 +1,240 @@
+//========================================================================
+// distance-directed-test.cc
+//========================================================================
+// This file contains directed tests for the distance functors in
+// Distance.h
+
+#include "Distance.h"
+#include "HRSStats.h"
+#include "Image.h"
+#include "Tree.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// Inputs
+//------------------------------------------------------------------------
+
+Image mk_img_2x2( int p0, int p1, int p2, int p3 )
+{
+  int data[] = { p0, p1, p2, p3 };
+  return Image( Vector<int>( data, 4 ), 2, 2 );
+}
+
+// A smooth blob of ink centered at (x, y) on a 28x28 image
+Image mk_blob( double x, double y )
+{
+  int data[28 * 28];
+  for ( int r = 0; r < 28; r++ ) {
+    for ( int c = 0; c < 28; c++ ) {
+      double d2        = ( c - x ) * ( c - x ) + ( r - y ) * ( r - y );
+      data[r * 28 + c] = (int) ( 255.0 * std::exp( -d2 / 18.0 ) );
+    }
+  }
+  return Image( Vector<int>( data, 28 * 28 ), 28, 28 );
+}
+
+bool less_intensity( const Image& a, const Image& b )
+{
+  return a.get_intensity() < b.get_intensity();
+}
+
+//------------------------------------------------------------------------
+// test_case_1_pixel_metrics
+//------------------------------------------------------------------------
+
+void test_case_1_pixel_metrics()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Image a = mk_img_2x2( 1, 2, 3, 4 );
+  Image b = mk_img_2x2( 4, 2, 0, 5 );
+
+  ECE2400_CHECK_INT_EQ( L2Distance()( a, b ), 19 );
+  ECE2400_CHECK_INT_EQ( L1Distance()( a, b ), 7 );
+  ECE2400_CHECK_INT_EQ( ChebyshevDistance()( a, b ), 3 );
+  ECE2400_CHECK_INT_EQ( L1Distance()( b, a ), 7 );
+  ECE2400_CHECK_INT_EQ( ChebyshevDistance()( b, a ), 3 );
+  ECE2400_CHECK_INT_EQ( L1Distance()( a, a ), 0 );
+  ECE2400_CHECK_INT_EQ( ChebyshevDistance()( a, a ), 0 );
+
+  CascadeDistance cascade;
+  ECE2400_CHECK_INT_EQ( cascade( a, b ), 19 );
+  ECE2400_CHECK_INT_EQ( cascade( a, a ), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_cosine
+//------------------------------------------------------------------------
+
+void test_case_2_cosine()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Image a     = mk_img_2x2( 1, 2, 3, 4 );
+  Image blank = mk_img_2x2( 0, 0, 0, 0 );
+
+  CosineDistance cosine;
+  ECE2400_CHECK_INT_EQ( cosine( a, mk_img_2x2( 2, 4, 6, 8 ) ), 0 );
+  ECE2400_CHECK_INT_EQ( cosine( mk_img_2x2( 1, 0, 0, 0 ),
+                                mk_img_2x2( 0, 5, 0, 0 ) ),
+                        cosine_scale );
+  ECE2400_CHECK_INT_EQ( cosine( a, mk_img_2x2( -1, -2, -3, -4 ) ),
+                        2 * cosine_scale );
+  ECE2400_CHECK_INT_EQ( cosine( blank, blank ), 0 );
+  ECE2400_CHECK_INT_EQ( cosine( a, blank ), cosine_scale );
+  ECE2400_CHECK_INT_EQ( cosine( blank, a ), cosine_scale );
+
+  // Closer in angle means closer in distance
+  ECE2400_CHECK_TRUE( cosine( a, mk_img_2x2( 1, 2, 3, 5 ) ) <
+                      cosine( a, mk_img_2x2( 4, 3, 2, 1 ) ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_tangent
+//------------------------------------------------------------------------
+// A blob shifted by a pixel is far in euclidean distance but close in
+// tangent distance, which is never more than the euclidean distance.
+
+void test_case_3_tangent()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  TangentDistance tangent;
+  Image           a = mk_blob( 13.5, 13.5 );
+
+  ECE2400_CHECK_INT_EQ( tangent( a, a ), 0 );
+
+  Image shifted = mk_blob( 14.5, 13.0 );
+  ECE2400_CHECK_TRUE( tangent( a, shifted ) * 10 < a.distance( shifted ) );
+
+  Image other = mk_blob( 5.0, 20.0 );
+  ECE2400_CHECK_TRUE( tangent( a, other ) <= a.distance( other ) );
+  ECE2400_CHECK_TRUE( tangent( a, shifted ) < tangent( a, other ) );
+
+  // Without ink there is nothing to transform
+
+  Image blank = mk_blob( -100.0, -100.0 );
+  ECE2400_CHECK_INT_EQ( tangent( blank, a ), blank.distance( a ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_searches
+//------------------------------------------------------------------------
+// Every functor works as the DistFunc of the linear, binary and tree
+// searches. With a window covering every value, all of them return the
+// value a linear search with the same metric returns.
+
+template <typename DistFunc>
+bool same_closest( const Vector<Image>& vec, const Image& query )
+{
+  Tree<Image, bool ( * )( const Image&, const Image& )> tree(
+      vec.size(), less_intensity );
+  Vector<Image> sorted;
+  for ( int i = 0; i < vec.size(); i++ ) {
+    tree.add( vec[i] );
+    sorted.push_back( vec[i] );
+  }
+  sorted.sort( less_intensity );
+
+  // The closest value by brute force
+  int best = 0;
+  for ( int i = 1; i < vec.size(); i++ ) {
+    if ( DistFunc()( query, vec[i] ) < DistFunc()( query, vec[best] ) )
+      best = i;
+  }
+
+  Image linear  = vec.find_closest_linear( query, DistFunc() );
+  Image binary  = sorted.find_closest_binary( query, 2 * vec.size(),
+                                              DistFunc(), less_intensity );
+  Image closest = tree.find_closest( query, DistFunc() );
+
+  int d = DistFunc()( query, vec[best] );
+  return DistFunc()( query, linear ) == d &&
+         DistFunc()( query, binary ) == d &&
+         DistFunc()( query, closest ) == d;
+}
+
+void test_case_4_searches()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 12; i++ )
+    vec.push_back( mk_blob( 3.0 + 2.0 * i, 25.0 - 1.5 * i ) );
+  Image query = mk_blob( 12.2, 17.9 );
+
+  ECE2400_CHECK_TRUE( same_closest<L2Distance>( vec, query ) );
+  ECE2400_CHECK_TRUE( same_closest<CascadeDistance>( vec, query ) );
+  ECE2400_CHECK_TRUE( same_closest<L1Distance>( vec, query ) );
+  ECE2400_CHECK_TRUE( same_closest<ChebyshevDistance>( vec, query ) );
+  ECE2400_CHECK_TRUE( same_closest<CosineDistance>( vec, query ) );
+  ECE2400_CHECK_TRUE( same_closest<TangentDistance>( vec, query ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_count_and_mismatch
+//------------------------------------------------------------------------
+// Every functor counts one distance per call (when configured with
+// HRS_STATS) and throws for images of different dimensions.
+
+template <typename DistFunc>
+bool counts_and_throws()
+{
+  Image a = mk_img_2x2( 1, 2, 3, 4 );
+  Image b = mk_blob( 1.0, 1.0 );
+
+  bool counted = true;
+#ifdef HRS_STATS
+  HRSStats start = hrs_stats_local();
+  DistFunc()( a, a );
+  counted = hrs_stats_since( start ).distance_calls == 1;
+#endif
+
+  bool thrown = false;
+  try {
+    DistFunc()( a, b );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    thrown = true;
+  }
+  return counted && thrown;
+}
+
+void test_case_5_count_and_mismatch()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ECE2400_CHECK_TRUE( counts_and_throws<L2Distance>() );
+  ECE2400_CHECK_TRUE( counts_and_throws<CascadeDistance>() );
+  ECE2400_CHECK_TRUE( counts_and_throws<L1Distance>() );
+  ECE2400_CHECK_TRUE( counts_and_throws<ChebyshevDistance>() );
+  ECE2400_CHECK_TRUE( counts_and_throws<CosineDistance>() );
+  ECE2400_CHECK_TRUE( counts_and_throws<TangentDistance>() );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_pixel_metrics();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_cosine();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_tangent();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_searches();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_count_and_mismatch();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
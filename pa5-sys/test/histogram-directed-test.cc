@@ -0,0 +1,158 @@
+//========================================================================
+// histogram-directed-test.cc
+//========================================================================
+// This file contains directed tests for Histogram
+
+#include "Histogram.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// test_case_1_empty
+//------------------------------------------------------------------------
+
+void test_case_1_empty()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Histogram hist;
+  ECE2400_CHECK_INT_EQ( (int) hist.count(), 0 );
+  ECE2400_CHECK_INT_EQ( (int) hist.percentile( 50.0 ), 0 );
+  ECE2400_CHECK_TRUE( hist.mean() == 0.0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_small_values
+//------------------------------------------------------------------------
+// Small values each get their own bucket, so percentiles are exact.
+
+void test_case_2_small_values()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Histogram hist;
+  for ( int i = 1; i <= 50; i++ )
+    hist.record( i );
+
+  ECE2400_CHECK_INT_EQ( (int) hist.count(), 50 );
+  ECE2400_CHECK_INT_EQ( (int) hist.min(), 1 );
+  ECE2400_CHECK_INT_EQ( (int) hist.max(), 50 );
+  ECE2400_CHECK_INT_EQ( (int) hist.percentile( 0.0 ), 1 );
+  ECE2400_CHECK_INT_EQ( (int) hist.percentile( 50.0 ), 25 );
+  ECE2400_CHECK_INT_EQ( (int) hist.percentile( 90.0 ), 45 );
+  ECE2400_CHECK_INT_EQ( (int) hist.percentile( 100.0 ), 50 );
+  ECE2400_CHECK_APPROX_EQ( hist.mean(), 25.5, 1e-9 );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_relative_error
+//------------------------------------------------------------------------
+// Large values are only known to within 2^-precision of their value,
+// but never more than the largest value recorded.
+
+void test_case_3_relative_error()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Histogram hist;
+  for ( long long i = 1; i <= 100000; i++ )
+    hist.record( i * 1000 );
+
+  const double ps[] = { 10.0, 50.0, 99.0, 99.9 };
+  for ( int i = 0; i < 4; i++ ) {
+    double exact = ps[i] / 100.0 * 1e8;
+    double got   = (double) hist.percentile( ps[i] );
+    ECE2400_CHECK_TRUE( got >= exact );
+    ECE2400_CHECK_TRUE( got <= exact * ( 1.0 + 1.0 / 32 ) );
+  }
+  ECE2400_CHECK_INT_EQ( (int) ( hist.percentile( 100.0 ) / 1000 ), 100000 );
+
+  // Even with a single bit of precision, every power of two lands in a
+  // bucket of its own
+
+  Histogram pow2( 1 );
+  for ( int i = 0; i < 62; i++ )
+    pow2.record( 1LL << i );
+  ECE2400_CHECK_TRUE( pow2.percentile( 100.0 ) == ( 1LL << 61 ) );
+  ECE2400_CHECK_TRUE( pow2.percentile( 50.0 ) >= ( 1LL << 30 ) );
+  ECE2400_CHECK_TRUE( pow2.percentile( 50.0 ) < ( 1LL << 31 ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_merge
+//------------------------------------------------------------------------
+
+void test_case_4_merge()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Histogram a;
+  Histogram b;
+  for ( int i = 0; i < 10; i++ )
+    a.record( i );
+  for ( int i = 1000; i < 1010; i++ )
+    b.record( i );
+
+  a.merge( b );
+  ECE2400_CHECK_INT_EQ( (int) a.count(), 20 );
+  ECE2400_CHECK_INT_EQ( (int) a.min(), 0 );
+  ECE2400_CHECK_INT_EQ( (int) a.max(), 1009 );
+  ECE2400_CHECK_INT_EQ( (int) a.percentile( 50.0 ), 9 );
+  ECE2400_CHECK_TRUE( a.percentile( 55.0 ) >= 1000 );
+
+  a.clear();
+  ECE2400_CHECK_INT_EQ( (int) a.count(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_invalid
+//------------------------------------------------------------------------
+
+void test_case_5_invalid()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Histogram hist;
+  bool      flag = false;
+  try {
+    hist.record( -1 );
+  } catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  flag = false;
+  try {
+    Histogram other( 3 );
+    hist.merge( other );
+  } catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  ECE2400_CHECK_INT_EQ( (int) hist.count(), 0 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_empty();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_small_values();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_relative_error();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_merge();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_invalid();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
@@ -4,6 +4,7 @@
 // Directed test cases for HRSAlternative.
 
 #include "HRSAlternative.h"
+#include "HRSLinearSearch.h"
 #include "Image.h"
 #include "Vector.h"
 #include "ece2400-stdlib.h"
@@ -11,6 +12,8 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 //------------------------------------------------------------------------
 // Inputs
@@ -133,6 +136,177 @@ void test_case_2_small_accuracy()
   ECE2400_CHECK_TRUE( accuracy >= expected_accuracy );
 }
 
+//------------------------------------------------------------------------
+// test_case_3_add_samples
+//------------------------------------------------------------------------
+// Trains with the first half of the digits in digits.dat and adds the
+// second half with add_samples. Every digit must then be found exactly.
+
+void test_case_3_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSAlternative clf;
+  clf.train( first_half );
+  clf.add_samples( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_4_workers
+//------------------------------------------------------------------------
+// Any number of workers, including more workers than images, finds the
+// same images as HRSLinearSearch, also after adding samples.
+
+void test_case_4_workers()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> digits;
+  Vector<Image> train;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    digits.push_back( img );
+    if ( i < 8 )
+      train.push_back( img );
+  }
+
+  HRSLinearSearch ref;
+  ref.train( train );
+
+  int nworkers[] = { 1, 2, 3, 20 };
+  for ( int n = 0; n < 4; n++ ) {
+    HRSAlternative clf( nworkers[n] );
+    clf.train( train );
+
+    for ( int i = 0; i < num_digits; i++ ) {
+      Image expected = ref.classify( digits[i] );
+      Image result   = clf.classify( digits[i] );
+      ECE2400_CHECK_TRUE( result == expected );
+      ECE2400_CHECK_CHAR_EQ( result.get_label(), expected.get_label() );
+    }
+
+    Vector<Image> rest;
+    for ( int i = 8; i < num_digits; i++ )
+      rest.push_back( digits[i] );
+    clf.add_samples( rest );
+
+    for ( int i = 0; i < num_digits; i++ ) {
+      Image result = clf.classify( digits[i] );
+      ECE2400_CHECK_INT_EQ( result.distance( digits[i] ), 0 );
+    }
+
+    // Training again replaces the workers along with their slices
+    clf.train( digits );
+    for ( int i = 0; i < num_digits; i++ ) {
+      Image result = clf.classify( digits[i] );
+      ECE2400_CHECK_INT_EQ( result.distance( digits[i] ), 0 );
+    }
+  }
+
+  bool flag = false;
+  try {
+    HRSAlternative clf( -1 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_concurrent_stats
+//------------------------------------------------------------------------
+// Queries that run at the same time on several threads, each split
+// across several workers, count exactly their own work: one distance
+// and one candidate per training image each.
+
+void test_case_5_concurrent_stats()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  const int num_digits = 14;
+
+  Vector<Image> digits;
+  for ( int i = 0; i < num_digits; i++ )
+    digits.push_back(
+        Image( Vector<int>( images[i], img_size ), ncols, nrows ) );
+
+  HRSAlternative clf( 3 );
+  clf.train( digits );
+
+  const int nthreads = 4;
+  const int rounds   = 5;
+
+  std::vector<std::thread> threads;
+  for ( int t = 0; t < nthreads; t++ ) {
+    threads.push_back( std::thread( [&clf, &digits]() {
+      for ( int r = 0; r < rounds; r++ ) {
+        for ( int i = 0; i < digits.size(); i++ )
+          clf.classify( digits[i] );
+      }
+    } ) );
+  }
+  for ( size_t t = 0; t < threads.size(); t++ )
+    threads[t].join();
+
+#ifdef HRS_STATS
+  int queries = nthreads * rounds * num_digits;
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().queries, queries );
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().distance_calls,
+                        queries * num_digits );
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().candidates,
+                        queries * num_digits );
+#endif
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -146,6 +320,9 @@ int main( int argc, char** argv )
 
   if ( ( __n == 0 ) || ( __n == 1  ) ) test_case_1_tiny_accuracy();
   if ( ( __n == 0 ) || ( __n == 2  ) ) test_case_2_small_accuracy();
+  if ( ( __n == 0 ) || ( __n == 3  ) ) test_case_3_add_samples();
+  if ( ( __n == 0 ) || ( __n == 4  ) ) test_case_4_workers();
+  if ( ( __n == 0 ) || ( __n == 5  ) ) test_case_5_concurrent_stats();
 
   return __failed;
 }
@@ -7,6 +7,7 @@
 #include "Image.h"
 #include "Vector.h"
 #include "ece2400-stdlib.h"
+#include "hrs-directed-test.h"
 #include "mnist-utils.h"
 #include <cstdlib>
 #include <iostream>
@@ -207,6 +208,152 @@ void test_case_4_small_accuracy()
   ECE2400_CHECK_TRUE( accuracy >= expected_accuracy );
 }
 
+//------------------------------------------------------------------------
+// test_case_5_add_samples
+//------------------------------------------------------------------------
+// Trains with the first half of the digits in digits.dat and adds the
+// second half with add_samples. Every digit must then be found exactly.
+
+void test_case_5_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSBinarySearch clf;
+  clf.train( first_half );
+  clf.add_samples( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_6_set_k
+//------------------------------------------------------------------------
+// K can be changed after training. Once it covers the whole training set
+// every query is compared against every training image, and K must stay
+// positive.
+
+void test_case_6_set_k()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+
+  HRSBinarySearch clf( 1 );
+  clf.train( vec );
+  clf.set_k( 2 * num_digits );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image result = clf.classify( vec[i] );
+    ECE2400_CHECK_INT_EQ( result.distance( vec[i] ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().candidates,
+                        num_digits * num_digits );
+#endif
+
+  bool flag = false;
+  try {
+    clf.set_k( 0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_7_train_stream
+//------------------------------------------------------------------------
+// Training from a stream in small batches merges the sorted batches into
+// one sorted training set, so every digit is still found exactly.
+
+void test_case_7_train_stream()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+
+  const std::string images_path = "hrs-binary-search-test-images.bin";
+  const std::string labels_path = "hrs-binary-search-test-labels.bin";
+  write_labeled_images( images_path, labels_path, vec );
+
+  LabeledImageStream stream( images_path, labels_path );
+  HRSBinarySearch    clf( 2 );
+  clf.train_stream( stream, 3 );
+
+  std::remove( images_path.c_str() );
+  std::remove( labels_path.c_str() );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image result = clf.classify( vec[i] );
+    ECE2400_CHECK_INT_EQ( result.distance( vec[i] ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -222,6 +369,10 @@ int main( int argc, char** argv )
   if ( ( __n == 0 ) || ( __n == 2  ) ) test_case_2_classify_seven();
   if ( ( __n == 0 ) || ( __n == 3  ) ) test_case_3_tiny_accuracy();
   if ( ( __n == 0 ) || ( __n == 4  ) ) test_case_4_small_accuracy();
+  if ( ( __n == 0 ) || ( __n == 5  ) ) test_case_5_add_samples();
+  if ( ( __n == 0 ) || ( __n == 6  ) ) test_case_6_set_k();
+  if ( ( __n == 0 ) || ( __n == 7  ) ) test_case_7_train_stream();
+  if ( ( __n == 0 ) || ( __n == 8  ) ) test_case_curve_order<HRSBinarySearch>( 8 );
 
   return __failed;
 }
@@ -0,0 +1,68 @@
+//========================================================================
+// hrs-directed-test.h
+//========================================================================
+// This file contains generic directed tests for handwriting recognition
+// systems. All of the generic test functions are templated by the HRS
+// class, which must have a constructor that takes the number of nearest
+// neighbors K.
+
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include <cstdio>
+
+//------------------------------------------------------------------------
+// mk_block
+//------------------------------------------------------------------------
+// Returns a 28x28 image with a 4x4 block in region (gx, gy) of a 3x3
+// grid of regions, moved right and down by shift pixels, and labeled
+// with the number of its region.
+
+inline Image mk_block( int gx, int gy, int shift )
+{
+  const int n = 28;
+
+  int data[n * n] = { 0 };
+  for ( int i = 0; i < 4; i++ )
+    for ( int j = 0; j < 4; j++ )
+      data[( 3 + 9 * gy + shift + i ) * n + 3 + 9 * gx + shift + j] = 200;
+
+  Image img( Vector<int>( data, n * n ), n, n );
+  img.set_label( (char) ( '1' + gy * 3 + gx ) );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// test_case_curve_order
+//------------------------------------------------------------------------
+// Training images are ordered by where their ink is and not only by how
+// much ink they have. A block in every one of the nine regions of the
+// image has the same intensity, so only the curve key tells them apart,
+// and with K = 1 a block moved by one pixel within its region must
+// still find its own block.
+
+template < typename HRS >
+void test_case_curve_order( int test_case_num )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  Vector<Image> vec;
+  for ( int gy = 0; gy < 3; gy++ )
+    for ( int gx = 0; gx < 3; gx++ )
+      vec.push_back( mk_block( gx, gy, 0 ) );
+
+  ECE2400_CHECK_TRUE( mk_block( 1, 2, 0 ).curve_key() == vec[7].curve_key() );
+  for ( int i = 1; i < vec.size(); i++ ) {
+    ECE2400_CHECK_INT_EQ( vec[i].get_intensity(), vec[0].get_intensity() );
+    ECE2400_CHECK_TRUE( vec[i].curve_key() != vec[i - 1].curve_key() );
+  }
+
+  HRS clf( 1 );
+  clf.train( vec );
+
+  for ( int i = 0; i < vec.size(); i++ ) {
+    Image query = mk_block( i % 3, i / 3, 1 );
+    ECE2400_CHECK_CHAR_EQ( clf.classify( query ).get_label(),
+                           vec[i].get_label() );
+  }
+}
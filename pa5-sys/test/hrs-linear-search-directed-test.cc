@@ -254,6 +254,292 @@ void test_case_5_small_accuracy()
   ECE2400_CHECK_APPROX_EQ( accuracy / expected_accuracy, 1.0, tolerance );
 }
 
+//------------------------------------------------------------------------
+// test_case_6_add_samples
+//------------------------------------------------------------------------
+// Trains with the first half of the digits in digits.dat and adds the
+// second half with add_samples. Every digit must then be found exactly.
+
+void test_case_6_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSLinearSearch clf;
+  clf.train( first_half );
+  clf.add_samples( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_7_condense
+//------------------------------------------------------------------------
+// A condensed classifier still classifies every digit it was trained on
+// correctly, and after adding samples, every added digit. Digits of
+// earlier batches are not checked again when samples are added, so they
+// may end up closer to a new prototype with another label.
+
+void test_case_7_condense()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSLinearSearch clf( true );
+  clf.train( first_half );
+  for ( int i = 0; i < first_half.size(); i++ ) {
+    ECE2400_CHECK_CHAR_EQ( clf.classify( first_half[i] ).get_label(),
+                           first_half[i].get_label() );
+  }
+
+  clf.add_samples( second_half );
+  for ( int i = 0; i < second_half.size(); i++ ) {
+    ECE2400_CHECK_CHAR_EQ( clf.classify( second_half[i] ).get_label(),
+                           second_half[i].get_label() );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_8_stats
+//------------------------------------------------------------------------
+// Linear search computes the distance to every training image, but only
+// reads the pixels of those that the region sums cannot rule out.
+
+void test_case_8_stats()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ )
+    vec.push_back( Image( Vector<int>( images[i], img_size ), ncols, nrows ) );
+
+  HRSLinearSearch clf;
+  clf.train( vec );
+
+  for ( int i = 0; i < num_digits; i++ )
+    clf.classify( vec[i] );
+
+  HRSStats stats = clf.stats();
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) stats.queries, num_digits );
+  ECE2400_CHECK_INT_EQ( (int) stats.distance_calls, num_digits * num_digits );
+  ECE2400_CHECK_INT_EQ( (int) stats.candidates, num_digits * num_digits );
+  ECE2400_CHECK_INT_EQ( (int) stats.nodes_visited, 0 );
+  ECE2400_CHECK_TRUE( stats.pruned > 0 );
+  ECE2400_CHECK_TRUE( stats.bytes_touched <
+                      (long long) num_digits * num_digits * img_size *
+                          (long long) sizeof( int ) );
+  ECE2400_CHECK_TRUE( stats.bytes_touched >=
+                      ( num_digits * num_digits - stats.pruned ) * img_size *
+                          (long long) sizeof( int ) );
+#else
+  ECE2400_CHECK_INT_EQ( (int) stats.queries, 0 );
+#endif
+
+  clf.reset_stats();
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().queries, 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_9_train_stream
+//------------------------------------------------------------------------
+// The default train_stream trains with the first batch and adds the
+// others, so every digit ends up in the training set.
+
+void test_case_9_train_stream()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+
+  const std::string images_path = "hrs-linear-search-test-images.bin";
+  const std::string labels_path = "hrs-linear-search-test-labels.bin";
+  write_labeled_images( images_path, labels_path, vec );
+
+  LabeledImageStream stream( images_path, labels_path );
+  HRSLinearSearch    clf;
+  clf.train_stream( stream, 3 );
+
+  std::remove( images_path.c_str() );
+  std::remove( labels_path.c_str() );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image result = clf.classify( vec[i] );
+    ECE2400_CHECK_INT_EQ( result.distance( vec[i] ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_10_mapped
+//------------------------------------------------------------------------
+// A mapped training set classifies like the same images in memory, one
+// query or a batch at a time, and cannot be added to.
+
+void test_case_10_mapped()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+
+  const std::string images_path = "hrs-linear-search-test-images.bin";
+  const std::string labels_path = "hrs-linear-search-test-labels.bin";
+  write_labeled_images( images_path, labels_path, vec );
+
+  // Map only the first 10 digits, so the others are classified as one of
+  // them
+
+  HRSLinearSearch mapped;
+  HRSLinearSearch ref;
+  mapped.map_training_set( images_path, labels_path, 10 );
+
+  Vector<Image> train;
+  for ( int i = 0; i < 10; i++ )
+    train.push_back( vec[i] );
+  ref.train( train );
+
+  Vector<int>   indices;
+  Vector<Image> batch = mapped.classify_batch( vec, indices );
+  ECE2400_CHECK_INT_EQ( batch.size(), num_digits );
+  ECE2400_CHECK_INT_EQ( indices.size(), num_digits );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image expected = ref.classify( vec[i] );
+    Image result   = mapped.classify( vec[i] );
+    ECE2400_CHECK_TRUE( result == expected );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), expected.get_label() );
+    ECE2400_CHECK_TRUE( batch[i] == expected );
+    ECE2400_CHECK_CHAR_EQ( batch[i].get_label(), expected.get_label() );
+    ECE2400_CHECK_TRUE( indices[i] >= 0 && indices[i] < 10 );
+    ECE2400_CHECK_TRUE( vec[indices[i]] == expected );
+    if ( i < 10 )
+      ECE2400_CHECK_INT_EQ( indices[i], i );
+  }
+
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) mapped.stats().queries, 2 * num_digits );
+  ECE2400_CHECK_INT_EQ( (int) mapped.stats().distance_calls,
+                        2 * num_digits * 10 );
+#endif
+
+  bool flag = false;
+  try {
+    mapped.add_samples( vec );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  // Training again replaces the mapped set
+
+  mapped.train( vec );
+  Image result = mapped.classify( vec[12] );
+  ECE2400_CHECK_INT_EQ( result.distance( vec[12] ), 0 );
+
+  std::remove( images_path.c_str() );
+  std::remove( labels_path.c_str() );
+
+  flag = false;
+  try {
+    mapped.map_training_set( images_path, labels_path );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -270,6 +556,11 @@ int main( int argc, char** argv )
   if ( ( __n == 0 ) || ( __n == 3  ) ) test_case_3_multiple_digits();
   if ( ( __n == 0 ) || ( __n == 4  ) ) test_case_4_tiny_accuracy();
   if ( ( __n == 0 ) || ( __n == 5  ) ) test_case_5_small_accuracy();
+  if ( ( __n == 0 ) || ( __n == 6  ) ) test_case_6_add_samples();
+  if ( ( __n == 0 ) || ( __n == 7  ) ) test_case_7_condense();
+  if ( ( __n == 0 ) || ( __n == 8  ) ) test_case_8_stats();
+  if ( ( __n == 0 ) || ( __n == 9  ) ) test_case_9_train_stream();
+  if ( ( __n == 0 ) || ( __n == 10 ) ) test_case_10_mapped();
 
   return __failed;
 }
@@ -0,0 +1,305 @@
+//========================================================================
+// hrs-sharded-search-directed-test.cc
+//========================================================================
+// Directed test cases for HRSShardedSearch.
+
+#include "HRSLinearSearch.h"
+#include "HRSShardedSearch.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+// Inputs
+//------------------------------------------------------------------------
+
+#include "digits.dat"
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const int ncols    = 28;
+const int nrows    = 28;
+const int img_size = nrows * ncols;
+
+//------------------------------------------------------------------------
+// load_digits
+//------------------------------------------------------------------------
+
+Vector<Image> load_digits()
+{
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+  return vec;
+}
+
+//------------------------------------------------------------------------
+// test_case_1_same_as_linear
+//------------------------------------------------------------------------
+// Any number of shards, including more shards than images, finds the
+// same images as HRSLinearSearch.
+
+void test_case_1_same_as_linear()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> digits = load_digits();
+  Vector<Image> train;
+  for ( int i = 0; i < 8; i++ )
+    train.push_back( digits[i] );
+
+  HRSLinearSearch ref;
+  ref.train( train );
+
+  int nshards[] = { 1, 2, 3, 20 };
+  for ( int n = 0; n < 4; n++ ) {
+    HRSShardedSearch clf( nshards[n] );
+    ECE2400_CHECK_INT_EQ( clf.num_shards(), nshards[n] );
+    clf.train( train );
+
+    for ( int i = 0; i < digits.size(); i++ ) {
+      Image expected = ref.classify( digits[i] );
+      Image result   = clf.classify( digits[i] );
+      ECE2400_CHECK_TRUE( result == expected );
+      ECE2400_CHECK_CHAR_EQ( result.get_label(), expected.get_label() );
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_2_add_samples
+//------------------------------------------------------------------------
+// Added samples are found, retraining replaces them, and adding to an
+// untrained system trains it.
+
+void test_case_2_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> digits = load_digits();
+  Vector<Image> first;
+  Vector<Image> second;
+  for ( int i = 0; i < digits.size(); i++ ) {
+    if ( i < 5 )
+      first.push_back( digits[i] );
+    else
+      second.push_back( digits[i] );
+  }
+
+  HRSShardedSearch clf( 3 );
+  clf.add_samples( first );
+  clf.add_samples( second );
+
+  for ( int i = 0; i < digits.size(); i++ ) {
+    Image result = clf.classify( digits[i] );
+    ECE2400_CHECK_INT_EQ( result.distance( digits[i] ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), digits[i].get_label() );
+  }
+
+  clf.train( first );
+  ECE2400_CHECK_TRUE( clf.classify( digits[12] ).distance( digits[12] ) > 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_stats
+//------------------------------------------------------------------------
+// The distances computed by the workers are counted here.
+
+void test_case_3_stats()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> digits = load_digits();
+
+  HRSShardedSearch clf( 4 );
+  clf.train( digits );
+
+  clf.classify( digits[3] );
+
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().queries, 1 );
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().distance_calls, digits.size() );
+#endif
+}
+
+//------------------------------------------------------------------------
+// test_case_4_invalid
+//------------------------------------------------------------------------
+
+void test_case_4_invalid()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  bool flag = false;
+  try {
+    HRSShardedSearch clf( -1 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  // Classifying without any training images
+
+  Vector<Image> digits = load_digits();
+
+  HRSShardedSearch clf( 2 );
+  flag = false;
+  try {
+    clf.classify( digits[0] );
+  }
+  catch ( ece2400::OutOfRange e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  clf.train( Vector<Image>() );
+  flag = false;
+  try {
+    clf.classify( digits[0] );
+  }
+  catch ( ece2400::OutOfRange e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_worker_failure
+//------------------------------------------------------------------------
+// Once a worker has died, the query that finds out fails, and so does
+// every later one instead of reading replies left over from it, until
+// training starts new workers.
+
+// The workers are forked by the main thread, so they are its children
+std::vector<pid_t> child_pids()
+{
+  std::ostringstream path;
+  path << "/proc/self/task/" << getpid() << "/children";
+  std::ifstream      in( path.str().c_str() );
+  std::vector<pid_t> pids;
+  pid_t              pid;
+  while ( in >> pid )
+    pids.push_back( pid );
+  return pids;
+}
+
+void test_case_5_worker_failure()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> digits = load_digits();
+
+  HRSShardedSearch clf( 3 );
+  clf.train( digits );
+
+  std::vector<pid_t> pids = child_pids();
+  ECE2400_CHECK_INT_EQ( (int) pids.size(), 3 );
+  if ( pids.size() != 3 )
+    return;
+  kill( pids[1], SIGKILL );
+  waitpid( pids[1], nullptr, 0 );
+
+  for ( int i = 0; i < 2; i++ ) {
+    bool flag = false;
+    try {
+      clf.classify( digits[0] );
+    }
+    catch ( ece2400::InvalidArgument e ) {
+      flag = true;
+    }
+    ECE2400_CHECK_TRUE( flag );
+  }
+
+  bool flag = false;
+  try {
+    clf.add_samples( digits );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+  ECE2400_CHECK_INT_EQ( (int) child_pids().size(), 0 );
+
+  clf.train( digits );
+  for ( int i = 0; i < digits.size(); i++ )
+    ECE2400_CHECK_INT_EQ( clf.classify( digits[i] ).distance( digits[i] ), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_6_two_instances
+//------------------------------------------------------------------------
+// The workers of a newer instance must not hold on to the sockets of an
+// older one, or destroying the older one waits for its workers forever.
+
+void test_case_6_two_instances()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> digits = load_digits();
+
+  HRSShardedSearch* a = new HRSShardedSearch( 2 );
+  a->train( digits );
+  HRSShardedSearch* b = new HRSShardedSearch( 2 );
+  b->train( digits );
+  ECE2400_CHECK_INT_EQ( (int) child_pids().size(), 4 );
+
+  delete a;
+  ECE2400_CHECK_INT_EQ( (int) child_pids().size(), 2 );
+  for ( int i = 0; i < digits.size(); i++ )
+    ECE2400_CHECK_INT_EQ( b->classify( digits[i] ).distance( digits[i] ), 0 );
+
+  delete b;
+  ECE2400_CHECK_INT_EQ( (int) child_pids().size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_same_as_linear();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_add_samples();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_stats();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_invalid();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_worker_failure();
+  if ( ( __n == 0 ) || ( __n == 6 ) ) test_case_6_two_instances();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
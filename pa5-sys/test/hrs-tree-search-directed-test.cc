@@ -7,6 +7,7 @@
 #include "Image.h"
 #include "Vector.h"
 #include "ece2400-stdlib.h"
+#include "hrs-directed-test.h"
 #include "mnist-utils.h"
 #include <cstdlib>
 #include <iostream>
@@ -207,6 +208,185 @@ void test_case_4_small_accuracy()
   ECE2400_CHECK_TRUE( accuracy >= expected_accuracy );
 }
 
+//------------------------------------------------------------------------
+// test_case_5_add_samples
+//------------------------------------------------------------------------
+// Trains with the first half of the digits in digits.dat and adds the
+// second half with add_samples. Every digit must then be found exactly.
+
+void test_case_5_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSTreeSearch clf;
+  clf.train( first_half );
+  clf.add_samples( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_6_retrain
+//------------------------------------------------------------------------
+// Training again replaces the previous training set, so none of the
+// digits from the first training set can be found exactly afterwards.
+
+void test_case_6_retrain()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSTreeSearch clf;
+  clf.train( first_half );
+  clf.train( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    if ( i < num_digits / 2 )
+      ECE2400_CHECK_TRUE( result.distance( test_img ) > 0 );
+    else
+      ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_7_stats
+//------------------------------------------------------------------------
+// The tree only scans the candidates in the subtree it stops at, and
+// computes one distance per candidate.
+
+void test_case_7_stats()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ )
+    vec.push_back( Image( Vector<int>( images[i], img_size ), ncols, nrows ) );
+
+  HRSTreeSearch clf( 2 );
+  clf.train( vec );
+
+  for ( int i = 0; i < num_digits; i++ )
+    clf.classify( vec[i] );
+
+  HRSStats stats = clf.stats();
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) stats.queries, num_digits );
+  ECE2400_CHECK_TRUE( stats.candidates == stats.distance_calls );
+  ECE2400_CHECK_TRUE( stats.distance_calls < num_digits * num_digits );
+  ECE2400_CHECK_TRUE( stats.nodes_visited > 0 );
+  ECE2400_CHECK_TRUE( stats.bytes_touched > 0 );
+#else
+  ECE2400_CHECK_INT_EQ( (int) stats.queries, 0 );
+#endif
+}
+
+//------------------------------------------------------------------------
+// test_case_8_set_k
+//------------------------------------------------------------------------
+// K can be changed after training. Once it covers the whole training set
+// every query is compared against every training image, and K must stay
+// positive.
+
+void test_case_8_set_k()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> vec;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    vec.push_back( img );
+  }
+
+  HRSTreeSearch clf( 1 );
+  clf.train( vec );
+  clf.set_k( 2 * num_digits );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image result = clf.classify( vec[i] );
+    ECE2400_CHECK_INT_EQ( result.distance( vec[i] ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+#ifdef HRS_STATS
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().distance_calls,
+                        num_digits * num_digits );
+#endif
+
+  bool flag = false;
+  try {
+    clf.set_k( 0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -222,6 +402,11 @@ int main( int argc, char** argv )
   if ( ( __n == 0 ) || ( __n == 2  ) ) test_case_2_classify_seven();
   if ( ( __n == 0 ) || ( __n == 3  ) ) test_case_3_tiny_accuracy();
   if ( ( __n == 0 ) || ( __n == 4  ) ) test_case_4_small_accuracy();
+  if ( ( __n == 0 ) || ( __n == 5  ) ) test_case_5_add_samples();
+  if ( ( __n == 0 ) || ( __n == 6  ) ) test_case_6_retrain();
+  if ( ( __n == 0 ) || ( __n == 7  ) ) test_case_7_stats();
+  if ( ( __n == 0 ) || ( __n == 8  ) ) test_case_8_set_k();
+  if ( ( __n == 0 ) || ( __n == 9  ) ) test_case_curve_order<HRSTreeSearch>( 9 );
 
   return __failed;
 }
@@ -0,0 +1,376 @@
+//========================================================================
+// hrs-vptree-search-directed-test.cc
+//========================================================================
+// Directed test cases for HRSVPTreeSearch.
+
+#include "HRSLinearSearch.h"
+#include "HRSVPTreeSearch.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+#include <cstdlib>
+#include <iostream>
+
+//------------------------------------------------------------------------
+// Inputs
+//------------------------------------------------------------------------
+
+#include "digits.dat"
+
+// The data included is as follows:
+//
+//     Digit    | Label
+//     ---------+-------
+//     digit0   | 5
+//     digit1   | 3
+//     digit2   | 2
+//     digit3   | 1
+//     digit4   | 1
+//     digit5   | 6
+//     digit6   | 5
+//     digit7   | 8
+//     digit8   | 9
+//     digit9   | 7
+//     digit10  | 0
+//     digit11  | 7
+//     digit12  | 4
+//     digit13  | 0
+//
+
+//------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------
+
+const std::string mnsit_dir = "/classes/ece2400/mnist/";
+const int         ncols     = 28;
+const int         nrows     = 28;
+const int         img_size  = nrows * ncols;
+
+//------------------------------------------------------------------------
+// test_case_1_classify_zero
+//------------------------------------------------------------------------
+
+void test_case_1_classify_zero()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Image test_img( Vector<int>( digit10_image, img_size ), ncols, nrows );
+
+  // Train with the first 5 MNIST training images
+
+  Vector<Image> img_vec;
+
+  std::string image_path = mnsit_dir + "training-images-tiny.bin";
+  std::string label_path = mnsit_dir + "training-labels-tiny.bin";
+
+  read_labeled_images( image_path, label_path, img_vec, 5 );
+
+  // You may uncommment these prints to see the images
+
+  // std::cout << "training images" << std::endl;
+  // for ( int i = 0; i < 5; i++ ){
+  //   img_vec[i].print();
+  //   std::cout << "label:" << img_vec[i].get_label() << std::endl;
+  // }
+  // std::cout << "\ntesting image" << std::endl;
+  // test_img.print();
+
+  // Train the classifier
+  HRSVPTreeSearch clf( 1 );
+  clf.train( img_vec );
+
+  // Check the predicted result
+  ECE2400_CHECK_CHAR_EQ( clf.classify( test_img ).get_label(), digit10_label );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_classify_seven
+//------------------------------------------------------------------------
+
+void test_case_2_classify_seven()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Image test_img = Image( Vector<int>( digit9_image, img_size ), ncols, nrows );
+
+  // Train with the first 20 MNIST training images
+
+  Vector<Image> img_vec;
+
+  std::string image_path = mnsit_dir + "training-images-small.bin";
+  std::string label_path = mnsit_dir + "training-labels-small.bin";
+
+  read_labeled_images( image_path, label_path, img_vec, 20 );
+
+  // You may uncommment these prints to see the images
+
+  // std::cout << "training images" << std::endl;
+  // for ( int i = 0; i < 20; i++ ){
+  //   img_vec[i].print();
+  //   std::cout << "label:" << img_vec[i].get_label() << std::endl;
+  // }
+  // std::cout << "\ntesting image" << std::endl;
+  // test_img.print();
+
+  // Train the classifier
+
+  HRSVPTreeSearch clf( 4 );
+  clf.train( img_vec );
+
+  // Check the predicted result
+  ECE2400_CHECK_CHAR_EQ( clf.classify( test_img ).get_label(), digit9_label );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_multiple_digits
+//------------------------------------------------------------------------
+
+void test_case_3_multiple_digits()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  // Train with the first 1000 MNIST training images
+
+  Vector<Image> img_vec;
+
+  std::string image_path = mnsit_dir + "training-images-small.bin";
+  std::string label_path = mnsit_dir + "training-labels-small.bin";
+
+  read_labeled_images( image_path, label_path, img_vec, 1000 );
+
+  // Get all digits from the .dat file
+
+  Image img0( Vector<int>( digit0_image, img_size ), ncols, nrows );
+  Image img1( Vector<int>( digit1_image, img_size ), ncols, nrows );
+  Image img2( Vector<int>( digit2_image, img_size ), ncols, nrows );
+  Image img3( Vector<int>( digit3_image, img_size ), ncols, nrows );
+  Image img4( Vector<int>( digit4_image, img_size ), ncols, nrows );
+  Image img5( Vector<int>( digit5_image, img_size ), ncols, nrows );
+  Image img6( Vector<int>( digit6_image, img_size ), ncols, nrows );
+  Image img7( Vector<int>( digit7_image, img_size ), ncols, nrows );
+
+  // Train the classifier
+
+  HRSVPTreeSearch clf( 8 );
+  clf.train( img_vec );
+
+  // Classify and check the predicted results
+
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img0 ).get_label(), digit0_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img1 ).get_label(), digit1_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img2 ).get_label(), digit2_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img3 ).get_label(), digit3_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img4 ).get_label(), digit4_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img5 ).get_label(), digit5_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img6 ).get_label(), digit6_label );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( img7 ).get_label(), digit7_label );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_tiny_accuracy
+//------------------------------------------------------------------------
+
+void test_case_4_tiny_accuracy()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  const int training_size = 10;
+  const int testing_size  = 10;
+
+  // Read the training images
+
+  Vector<Image> v_train;
+
+  std::string image_path = mnsit_dir + "training-images-tiny.bin";
+  std::string label_path = mnsit_dir + "training-labels-tiny.bin";
+
+  read_labeled_images( image_path, label_path, v_train, training_size );
+
+  // Read the testing images
+
+  Vector<Image> v_test;
+
+  image_path = mnsit_dir + "testing-images-tiny.bin";
+  label_path = mnsit_dir + "testing-labels-tiny.bin";
+
+  read_labeled_images( image_path, label_path, v_test, testing_size );
+
+  // Train and classify
+
+  HRSVPTreeSearch clf( 2 );
+
+  double accuracy = train_and_classify( clf, v_train, v_test );
+  std::cout << "Accuracy: " << accuracy << std::endl;
+
+  // Accuracy should be...
+
+  double expected_accuracy = 0.59;
+
+  ECE2400_CHECK_TRUE( accuracy > expected_accuracy );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_small_accuracy
+//------------------------------------------------------------------------
+
+void test_case_5_small_accuracy()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  const int training_size = 600;
+  const int testing_size  = 100;
+
+  // Read the training images
+
+  Vector<Image> v_train;
+
+  std::string image_path = mnsit_dir + "training-images-small.bin";
+  std::string label_path = mnsit_dir + "training-labels-small.bin";
+
+  read_labeled_images( image_path, label_path, v_train, training_size );
+
+  // Read the testing images
+
+  Vector<Image> v_test;
+
+  image_path = mnsit_dir + "testing-images-small.bin";
+  label_path = mnsit_dir + "testing-labels-small.bin";
+
+  read_labeled_images( image_path, label_path, v_test, testing_size );
+
+  // Train and classify
+
+  HRSVPTreeSearch clf( 16 );
+
+  double accuracy = train_and_classify( clf, v_train, v_test );
+  std::cout << "Accuracy: " << accuracy << std::endl;
+
+  // Accuracy should be...
+
+  double expected_accuracy = 0.82;
+
+  ECE2400_CHECK_TRUE( accuracy >= expected_accuracy );
+}
+
+//------------------------------------------------------------------------
+// test_case_6_match_linear_search
+//------------------------------------------------------------------------
+// Leave-one-out over the digits in digits.dat. The search is exact, so
+// the closest training image must be exactly as close as the one found
+// by HRSLinearSearch for every held out digit and every leaf size.
+
+void test_case_6_match_linear_search()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  for ( int leaf_size = 1; leaf_size <= 4; leaf_size++ ) {
+    for ( int i = 0; i < num_digits; i++ ) {
+
+      // Train with every digit except the held out one
+
+      Vector<Image> img_vec;
+      for ( int j = 0; j < num_digits; j++ ) {
+        if ( j == i )
+          continue;
+        Image img( Vector<int>( images[j], img_size ), ncols, nrows );
+        img.set_label( labels[j] );
+        img_vec.push_back( img );
+      }
+
+      HRSLinearSearch ref;
+      ref.train( img_vec );
+
+      HRSVPTreeSearch clf( leaf_size );
+      clf.train( img_vec );
+
+      Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+
+      Image ref_img = ref.classify( test_img );
+      Image clf_img = clf.classify( test_img );
+
+      ECE2400_CHECK_INT_EQ( clf_img.distance( test_img ),
+                            ref_img.distance( test_img ) );
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_7_add_samples
+//------------------------------------------------------------------------
+// Trains with the first half of the digits in digits.dat and adds the
+// second half with add_samples. Every digit must then be found exactly.
+
+void test_case_7_add_samples()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int* images[] = { digit0_image,  digit1_image,  digit2_image,
+                    digit3_image,  digit4_image,  digit5_image,
+                    digit6_image,  digit7_image,  digit8_image,
+                    digit9_image,  digit10_image, digit11_image,
+                    digit12_image, digit13_image };
+  char labels[] = { digit0_label,  digit1_label,  digit2_label,
+                    digit3_label,  digit4_label,  digit5_label,
+                    digit6_label,  digit7_label,  digit8_label,
+                    digit9_label,  digit10_label, digit11_label,
+                    digit12_label, digit13_label };
+  const int num_digits = 14;
+
+  Vector<Image> first_half;
+  Vector<Image> second_half;
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image img( Vector<int>( images[i], img_size ), ncols, nrows );
+    img.set_label( labels[i] );
+    if ( i < num_digits / 2 )
+      first_half.push_back( img );
+    else
+      second_half.push_back( img );
+  }
+
+  HRSVPTreeSearch clf;
+  clf.train( first_half );
+  clf.add_samples( second_half );
+
+  for ( int i = 0; i < num_digits; i++ ) {
+    Image test_img( Vector<int>( images[i], img_size ), ncols, nrows );
+    Image result = clf.classify( test_img );
+    ECE2400_CHECK_INT_EQ( result.distance( test_img ), 0 );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), labels[i] );
+  }
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1  ) ) test_case_1_classify_zero();
+  if ( ( __n == 0 ) || ( __n == 2  ) ) test_case_2_classify_seven();
+  if ( ( __n == 0 ) || ( __n == 3  ) ) test_case_3_multiple_digits();
+  if ( ( __n == 0 ) || ( __n == 4  ) ) test_case_4_tiny_accuracy();
+  if ( ( __n == 0 ) || ( __n == 5  ) ) test_case_5_small_accuracy();
+  if ( ( __n == 0 ) || ( __n == 6  ) ) test_case_6_match_linear_search();
+  if ( ( __n == 0 ) || ( __n == 7  ) ) test_case_7_add_samples();
+
+  return __failed;
+}
+// clang-format on
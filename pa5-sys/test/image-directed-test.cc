@@ -3,11 +3,15 @@
 //========================================================================
 // Test program that includes directed tests for Image.
 
+#include "Distance.h"
+#include "HRSStats.h"
 #include "Image.h"
 #include "ece2400-stdlib.h"
 
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
 
 //------------------------------------------------------------------------
 // test_case_1_basic
@@ -718,6 +722,160 @@ void test_case_20_bracket_read()
 /*   ECE2400_CHECK_INT_EQ( img[5], 64 ); */
 /* } */
 
+//------------------------------------------------------------------------
+// test_case_22_distance_count
+//------------------------------------------------------------------------
+// Every distance evaluation is counted by the thread that computes it.
+// The distances of a worker thread count for the calling thread only
+// once the worker hands them back.
+
+void count_distances( const Image* a, const Image* b, int n,
+                      HRSStats* stats )
+{
+  HRSStats start = hrs_stats_local();
+  for ( int i = 0; i < n; i++ )
+    a->distance( *b );
+  *stats = hrs_stats_since( start );
+}
+
+void test_case_22_distance_count()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int   data[] = {1, 2, 3, 4};
+  Image a( Vector<int>( data, 4 ), 2, 2 );
+  Image b( Vector<int>( data, 4 ), 2, 2 );
+
+#ifdef HRS_STATS
+  HRSStats start = hrs_stats_local();
+  HRSStats stats;
+  count_distances( &a, &b, 5, &stats );
+
+  HRSStats    worker_stats;
+  std::thread worker( count_distances, &a, &b, 7, &worker_stats );
+  worker.join();
+
+  ECE2400_CHECK_INT_EQ( (int) stats.distance_calls, 5 );
+  ECE2400_CHECK_INT_EQ( (int) hrs_stats_since( start ).distance_calls, 5 );
+  ECE2400_CHECK_INT_EQ( (int) worker_stats.distance_calls, 7 );
+
+  hrs_stats_local() += worker_stats;
+  ECE2400_CHECK_INT_EQ( (int) hrs_stats_since( start ).distance_calls, 12 );
+#endif
+}
+
+//------------------------------------------------------------------------
+// test_case_23_distance_within
+//------------------------------------------------------------------------
+// distance_within is exact below the bound and never below the bound
+// otherwise, and a linear search with CascadeDistance finds the same
+// closest image as one with the full distance.
+
+Image random_digit( int ink )
+{
+  int data[28 * 28] = { 0 };
+  for ( int i = 0; i < 28 * 28; i++ ) {
+    if ( std::rand() % 100 < ink )
+      data[i] = std::rand() % 256;
+  }
+  return Image( Vector<int>( data, 28 * 28 ), 28, 28 );
+}
+
+int full_distance( const Image& a, const Image& b )
+{
+  return a.distance( b );
+}
+
+void test_case_23_distance_within()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::srand( 0x2400 );
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 200; i++ )
+    vec.push_back( random_digit( 5 + i % 30 ) );
+
+  bool exact = true;
+  for ( int i = 1; i < vec.size(); i++ ) {
+    int d        = vec[0].distance( vec[i] );
+    int bounds[] = { 1, d / 2, d, d + 1, d * 2 };
+    for ( int j = 0; j < 5; j++ ) {
+      int within = vec[0].distance_within( vec[i], bounds[j] );
+      if ( d < bounds[j] )
+        exact = exact && within == d;
+      else
+        exact = exact && within >= bounds[j] && within <= d;
+    }
+  }
+  ECE2400_CHECK_TRUE( exact );
+
+  for ( int q = 0; q < 20; q++ ) {
+    Image query = random_digit( 20 );
+    ECE2400_CHECK_TRUE( vec.find_closest_linear( query, CascadeDistance() ) ==
+                        vec.find_closest_linear( query, full_distance ) );
+  }
+
+  // A uniform image against a blank one: the bound of every level is
+  // the distance itself
+
+  int ones[28 * 28];
+  for ( int i = 0; i < 28 * 28; i++ )
+    ones[i] = 100;
+  Image lit( Vector<int>( ones, 28 * 28 ), 28, 28 );
+  Image blank = random_digit( 0 );
+  int   d     = lit.distance( blank );
+  ECE2400_CHECK_INT_EQ( lit.distance_within( blank, d ), d );
+  ECE2400_CHECK_INT_EQ( lit.distance_within( blank, d - 1 ), d );
+  ECE2400_CHECK_INT_EQ( lit.distance_within( blank, INT_MAX ), d );
+}
+
+//------------------------------------------------------------------------
+// test_case_24_distance_kernel
+//------------------------------------------------------------------------
+// The sparse kernel gives exactly the same distances as the dense one,
+// whichever image has fewer nonzero pixels, and choose_distance_kernel
+// switches to the kernel it returns.
+
+void test_case_24_distance_kernel()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::srand( 0x2400 );
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 50; i++ )
+    vec.push_back( random_digit( i * 2 ) );
+
+  int   data[]  = { -3, 0, 7, 0 };
+  int   zeros[] = { 0, 0, 0, 0 };
+  Image a( Vector<int>( data, 4 ), 2, 2 );
+  Image b( Vector<int>( zeros, 4 ), 2, 2 );
+
+  Image::set_distance_kernel( Image::DENSE );
+  Vector<int> expected;
+  for ( int i = 0; i < vec.size(); i++ )
+    expected.push_back( vec[0].distance( vec[i] ) );
+
+  Image::set_distance_kernel( Image::SPARSE );
+  ECE2400_CHECK_TRUE( Image::get_distance_kernel() == Image::SPARSE );
+  bool same = true;
+  for ( int i = 0; i < vec.size(); i++ ) {
+    same = same && vec[0].distance( vec[i] ) == expected[i];
+    same = same && vec[i].distance( vec[0] ) == expected[i];
+  }
+  ECE2400_CHECK_TRUE( same );
+  ECE2400_CHECK_INT_EQ( a.distance( b ), 58 );
+  ECE2400_CHECK_INT_EQ( b.distance( a ), 58 );
+  ECE2400_CHECK_INT_EQ( a.distance( a ), 0 );
+  ECE2400_CHECK_INT_EQ( b.distance( b ), 0 );
+
+  Image::DistanceKernel kernel = Image::choose_distance_kernel( vec );
+  ECE2400_CHECK_TRUE( Image::get_distance_kernel() == kernel );
+
+  Image::set_distance_kernel( Image::DENSE );
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -750,6 +908,9 @@ int main( int argc, char** argv )
   if ( ( __n == 0 ) || ( __n == 19 ) ) test_case_19_assignment_empty();
   if ( ( __n == 0 ) || ( __n == 20 ) ) test_case_20_bracket_read();
   /* if ( ( __n == 0 ) || ( __n == 21 ) ) test_case_21_bracket_write(); */
+  if ( ( __n == 0 ) || ( __n == 22 ) ) test_case_22_distance_count();
+  if ( ( __n == 0 ) || ( __n == 23 ) ) test_case_23_distance_within();
+  if ( ( __n == 0 ) || ( __n == 24 ) ) test_case_24_distance_kernel();
 
   std::printf("\n");
 
@@ -0,0 +1,175 @@
+//========================================================================
+// image-distorter-directed-test.cc
+//========================================================================
+// This file contains directed tests for ImageDistorter
+
+#include "Image.h"
+#include "ImageDistorter.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// mk_img
+//------------------------------------------------------------------------
+// Creates an 8x8 image with a 2x2 square of the given brightness whose
+// top-left corner is at (x, y)
+
+Image mk_img( int x, int y, int value )
+{
+  int data[64] = { 0 };
+  for ( int dy = 0; dy < 2; dy++ )
+    for ( int dx = 0; dx < 2; dx++ )
+      data[( y + dy ) * 8 + x + dx] = value;
+
+  Image img( Vector<int>( data, 64 ), 8, 8 );
+  img.set_label( '3' );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// test_case_1_identity
+//------------------------------------------------------------------------
+// Without any distortion, shift or noise the image is unchanged.
+
+void test_case_1_identity()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImageDistorter distorter( 1 );
+  distorter.set_elastic( 0.0, 0.0 );
+  distorter.set_shift( 0 );
+  distorter.set_noise( 0.0 );
+
+  Image img = mk_img( 3, 3, 200 );
+  for ( int i = 0; i < 10; i++ ) {
+    Image result = distorter.distort( img );
+    ECE2400_CHECK_TRUE( result == img );
+    ECE2400_CHECK_CHAR_EQ( result.get_label(), '3' );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_2_shift
+//------------------------------------------------------------------------
+// A shift alone moves the square by whole pixels without changing it.
+
+void test_case_2_shift()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImageDistorter distorter( 2 );
+  distorter.set_elastic( 0.0, 0.0 );
+  distorter.set_shift( 1 );
+  distorter.set_noise( 0.0 );
+
+  Image img   = mk_img( 3, 3, 200 );
+  int   moved = 0;
+  for ( int i = 0; i < 20; i++ ) {
+    Image result = distorter.distort( img );
+    ECE2400_CHECK_INT_EQ( result.get_intensity(), img.get_intensity() );
+
+    bool found = false;
+    for ( int y = 2; y <= 4; y++ )
+      for ( int x = 2; x <= 4; x++ )
+        if ( result == mk_img( x, y, 200 ) )
+          found = true;
+    ECE2400_CHECK_TRUE( found );
+
+    if ( !( result == img ) )
+      moved++;
+  }
+  ECE2400_CHECK_TRUE( moved > 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_seed
+//------------------------------------------------------------------------
+// The same seed gives the same images and pixels stay within [0, 255].
+
+void test_case_3_seed()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImageDistorter a( 7 );
+  ImageDistorter b( 7 );
+  ImageDistorter c( 8 );
+
+  Image img       = mk_img( 3, 3, 250 );
+  bool  different = false;
+  for ( int i = 0; i < 10; i++ ) {
+    Image ra = a.distort( img );
+    Image rb = b.distort( img );
+    Image rc = c.distort( img );
+    ECE2400_CHECK_TRUE( ra == rb );
+    if ( !( ra == rc ) )
+      different = true;
+
+    for ( int j = 0; j < 64; j++ ) {
+      ECE2400_CHECK_TRUE( ra[j] >= 0 );
+      ECE2400_CHECK_TRUE( ra[j] <= 255 );
+    }
+  }
+  ECE2400_CHECK_TRUE( different );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_invalid
+//------------------------------------------------------------------------
+
+void test_case_4_invalid()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImageDistorter distorter;
+
+  bool flag = false;
+  try {
+    distorter.set_elastic( -1.0, 4.0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  flag = false;
+  try {
+    distorter.set_shift( -1 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  flag = false;
+  try {
+    distorter.set_noise( -1.0 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_identity();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_shift();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_seed();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_invalid();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
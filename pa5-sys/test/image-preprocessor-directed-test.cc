@@ -0,0 +1,251 @@
+//========================================================================
+// image-preprocessor-directed-test.cc
+//========================================================================
+// This file contains directed tests for ImagePreprocessor and
+// HRSPreprocessed
+
+#include "HRSLinearSearch.h"
+#include "HRSPreprocessed.h"
+#include "Image.h"
+#include "ImagePreprocessor.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// mk_img
+//------------------------------------------------------------------------
+// Creates a 28x28 image with a w x h rectangle of brightness 200 whose
+// top-left corner is at (x, y). With slant s, row y + i of the rectangle
+// is moved right by s * i pixels.
+
+Image mk_img( int x, int y, int w, int h, double s = 0.0 )
+{
+  int data[28 * 28] = { 0 };
+  for ( int i = 0; i < h; i++ )
+    for ( int j = 0; j < w; j++ )
+      data[( y + i ) * 28 + x + j + (int) ( s * i )] = 200;
+
+  Image img( Vector<int>( data, 28 * 28 ), 28, 28 );
+  img.set_label( '7' );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// Moments
+//------------------------------------------------------------------------
+// Center of mass, slant (covariance of x and y over the variance of y)
+// and bounding box of the ink of an image. Resampling blurs edges, so
+// the bounding box only counts pixels that are at least half lit.
+
+struct Moments {
+  double cx, cy, slant;
+  int    x0, x1, y0, y1;
+};
+
+Moments moments( const Image& img )
+{
+  double  m = 0, sx = 0, sy = 0, sxy = 0, syy = 0;
+  Moments r = { 0, 0, 0, 28, -1, 28, -1 };
+  for ( int y = 0; y < 28; y++ ) {
+    for ( int x = 0; x < 28; x++ ) {
+      double p = img.at( x, y );
+      if ( p <= 0 )
+        continue;
+      m += p;
+      sx += p * x;
+      sy += p * y;
+      sxy += p * x * y;
+      syy += p * y * y;
+      if ( p < 100 )
+        continue;
+      r.x0 = ( x < r.x0 ) ? x : r.x0;
+      r.x1 = ( x > r.x1 ) ? x : r.x1;
+      r.y0 = ( y < r.y0 ) ? y : r.y0;
+      r.y1 = ( y > r.y1 ) ? y : r.y1;
+    }
+  }
+  r.cx    = sx / m;
+  r.cy    = sy / m;
+  r.slant = ( sxy / m - r.cx * r.cy ) / ( syy / m - r.cy * r.cy );
+  return r;
+}
+
+//------------------------------------------------------------------------
+// test_case_1_crop
+//------------------------------------------------------------------------
+// The longer side of the bounding box is scaled to the box, keeping the
+// aspect ratio, and the box ends up in the middle.
+
+void test_case_1_crop()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImagePreprocessor pre;
+  pre.set_center( false );
+  pre.set_deskew( false );
+
+  Moments m = moments( pre.apply( mk_img( 1, 2, 8, 4 ) ) );
+  ECE2400_CHECK_TRUE( m.x1 - m.x0 + 1 >= 20 && m.x1 - m.x0 + 1 <= 21 );
+  ECE2400_CHECK_TRUE( m.y1 - m.y0 + 1 >= 10 && m.y1 - m.y0 + 1 <= 11 );
+  ECE2400_CHECK_TRUE( m.cx > 13.0 && m.cx < 14.0 );
+  ECE2400_CHECK_TRUE( m.cy > 13.0 && m.cy < 14.0 );
+
+  pre.set_crop( 10 );
+  m = moments( pre.apply( mk_img( 1, 2, 20, 20 ) ) );
+  ECE2400_CHECK_TRUE( m.x1 - m.x0 + 1 >= 10 && m.x1 - m.x0 + 1 <= 11 );
+  ECE2400_CHECK_TRUE( m.y1 - m.y0 + 1 >= 10 && m.y1 - m.y0 + 1 <= 11 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_center
+//------------------------------------------------------------------------
+// The center of mass moves to the middle without changing the ink.
+
+void test_case_2_center()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImagePreprocessor pre;
+  pre.set_crop( 0 );
+  pre.set_deskew( false );
+
+  Image   img = mk_img( 2, 17, 5, 3 );
+  Image   out = pre.apply( img );
+  Moments m   = moments( out );
+  ECE2400_CHECK_TRUE( m.cx > 13.4 && m.cx < 13.6 );
+  ECE2400_CHECK_TRUE( m.cy > 13.4 && m.cy < 13.6 );
+  ECE2400_CHECK_TRUE( out.get_intensity() > img.get_intensity() - 10 &&
+                      out.get_intensity() < img.get_intensity() + 10 );
+
+  // Whole pixel shifts move the image exactly
+
+  img = mk_img( 4, 5, 2, 2 );
+  ECE2400_CHECK_TRUE( pre.apply( img ) == mk_img( 13, 13, 2, 2 ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_deskew
+//------------------------------------------------------------------------
+// A slanted bar stands upright afterwards.
+
+void test_case_3_deskew()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImagePreprocessor pre;
+  pre.set_crop( 0 );
+
+  Image img = mk_img( 4, 4, 2, 20, 0.5 );
+  ECE2400_CHECK_TRUE( moments( img ).slant > 0.4 );
+
+  Moments m = moments( pre.apply( img ) );
+  ECE2400_CHECK_TRUE( m.slant > -0.05 && m.slant < 0.05 );
+  ECE2400_CHECK_TRUE( m.x1 - m.x0 + 1 <= 4 );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_unchanged
+//------------------------------------------------------------------------
+// Labels are kept, and images without ink or with every stage turned off
+// are returned as they are.
+
+void test_case_4_unchanged()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ImagePreprocessor pre;
+
+  Image img = mk_img( 3, 3, 4, 8, 0.25 );
+  ECE2400_CHECK_CHAR_EQ( pre.apply( img ).get_label(), '7' );
+
+  Image blank = mk_img( 0, 0, 0, 0 );
+  ECE2400_CHECK_TRUE( pre.apply( blank ) == blank );
+
+  Vector<Image> vec;
+  vec.push_back( img );
+  vec.push_back( blank );
+  Vector<Image> out = pre.apply( vec );
+  ECE2400_CHECK_INT_EQ( out.size(), 2 );
+  ECE2400_CHECK_TRUE( out[0] == pre.apply( img ) );
+  ECE2400_CHECK_TRUE( out[1] == blank );
+
+  pre.set_crop( 0 );
+  pre.set_center( false );
+  pre.set_deskew( false );
+  ECE2400_CHECK_TRUE( pre.apply( img ) == img );
+
+  bool flag = false;
+  try {
+    pre.set_crop( -1 );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_hrs
+//------------------------------------------------------------------------
+// A small bar in a corner is closer to a small square in the middle than
+// to a long bar, until both are preprocessed.
+
+void test_case_5_hrs()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Image bar    = mk_img( 12, 4, 3, 20 );
+  Image square = mk_img( 12, 12, 4, 4 );
+  bar.set_label( '1' );
+  square.set_label( '0' );
+
+  Vector<Image> vec;
+  vec.push_back( bar );
+  vec.push_back( square );
+
+  Image query = mk_img( 1, 1, 1, 7 );
+
+  HRSLinearSearch plain;
+  plain.train( vec );
+  ECE2400_CHECK_CHAR_EQ( plain.classify( query ).get_label(), '0' );
+
+  HRSLinearSearch inner;
+  HRSPreprocessed clf( inner );
+  clf.train( vec );
+  ECE2400_CHECK_CHAR_EQ( clf.classify( query ).get_label(), '1' );
+
+  Vector<Image> queries;
+  queries.push_back( query );
+  ECE2400_CHECK_CHAR_EQ( clf.classify_batch( queries )[0].get_label(), '1' );
+
+#ifdef HRS_STATS
+  clf.reset_stats();
+  clf.classify( query );
+  ECE2400_CHECK_INT_EQ( (int) clf.stats().distance_calls, 2 );
+#endif
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_crop();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_center();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_deskew();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_unchanged();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_hrs();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
@@ -0,0 +1,441 @@
+//========================================================================
+// mnist-utils-directed-test.cc
+//========================================================================
+// This file contains directed tests for the MNIST utility functions
+
+#include "HRSLinearSearch.h"
+#include "Histogram.h"
+#include "Image.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include "mnist-utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// mk_img
+//------------------------------------------------------------------------
+// Creates a 2x2 image with the given top-left pixel and label
+
+Image mk_img( int value, char label )
+{
+  int   data[] = {value, 1, 2, 3};
+  Image img( Vector<int>( data, 4 ), 2, 2 );
+  img.set_label( label );
+  return img;
+}
+
+//------------------------------------------------------------------------
+// test_case_1_hash
+//------------------------------------------------------------------------
+// Equal images have equal hashes, and these different images do not.
+
+void test_case_1_hash()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ECE2400_CHECK_TRUE( mk_img( 5, 'a' ).hash() == mk_img( 5, 'b' ).hash() );
+  ECE2400_CHECK_TRUE( mk_img( 5, 'a' ).hash() != mk_img( 6, 'a' ).hash() );
+
+  int   data0[] = {1, 2, 3, 4};
+  int   data1[] = {4, 3, 2, 1};
+  Image img0( Vector<int>( data0, 4 ), 2, 2 );
+  Image img1( Vector<int>( data1, 4 ), 2, 2 );
+  ECE2400_CHECK_TRUE( img0.hash() != img1.hash() );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_dedup_no_duplicates
+//------------------------------------------------------------------------
+
+void test_case_2_dedup_no_duplicates()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 100; i++ )
+    vec.push_back( mk_img( i, 'x' ) );
+
+  Vector<Image> unique = dedup_images( vec );
+
+  ECE2400_CHECK_INT_EQ( unique.size(), 100 );
+  for ( int i = 0; i < 100; i++ )
+    ECE2400_CHECK_TRUE( unique[i] == vec[i] );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_dedup_majority_label
+//------------------------------------------------------------------------
+// Copies are collapsed into their first occurrence, which gets the most
+// common label among them.
+
+void test_case_3_dedup_majority_label()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> vec;
+  vec.push_back( mk_img( 7, '1' ) );
+  vec.push_back( mk_img( 8, '3' ) );
+  vec.push_back( mk_img( 7, '2' ) );
+  vec.push_back( mk_img( 9, '5' ) );
+  vec.push_back( mk_img( 7, '2' ) );
+  vec.push_back( mk_img( 8, '3' ) );
+
+  Vector<Image> unique = dedup_images( vec );
+
+  ECE2400_CHECK_INT_EQ( unique.size(), 3 );
+  ECE2400_CHECK_TRUE( unique[0] == mk_img( 7, '?' ) );
+  ECE2400_CHECK_TRUE( unique[1] == mk_img( 8, '?' ) );
+  ECE2400_CHECK_TRUE( unique[2] == mk_img( 9, '?' ) );
+  ECE2400_CHECK_CHAR_EQ( unique[0].get_label(), '2' );
+  ECE2400_CHECK_CHAR_EQ( unique[1].get_label(), '3' );
+  ECE2400_CHECK_CHAR_EQ( unique[2].get_label(), '5' );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_dedup_empty
+//------------------------------------------------------------------------
+
+void test_case_4_dedup_empty()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> vec;
+  ECE2400_CHECK_INT_EQ( dedup_images( vec ).size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_5_condense
+//------------------------------------------------------------------------
+// Two well separated clusters condense into a handful of prototypes, and
+// the prototypes still classify every training image correctly.
+
+int image_dist( const Image& a, const Image& b )
+{
+  return a.distance( b );
+}
+
+void test_case_5_condense()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::srand( 0xdeadbeef );
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 200; i++ ) {
+    bool high = ( std::rand() % 2 ) == 1;
+    int  base = high ? 200 : 0;
+    vec.push_back( mk_img( base + std::rand() % 50, high ? 'h' : 'l' ) );
+  }
+
+  Vector<Image> protos = condense_images( vec );
+
+  ECE2400_CHECK_TRUE( protos.size() >= 2 );
+  ECE2400_CHECK_TRUE( protos.size() <= 10 );
+
+  for ( int i = 0; i < vec.size(); i++ ) {
+    Image nearest = protos.find_closest_linear( vec[i], image_dist );
+    ECE2400_CHECK_CHAR_EQ( nearest.get_label(), vec[i].get_label() );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_6_condense_into
+//------------------------------------------------------------------------
+// Only misclassified images are added to existing prototypes.
+
+void test_case_6_condense_into()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> protos;
+  protos.push_back( mk_img( 0, 'l' ) );
+
+  Vector<Image> vec;
+  vec.push_back( mk_img( 10, 'l' ) );
+  vec.push_back( mk_img( 250, 'h' ) );
+  vec.push_back( mk_img( 240, 'h' ) );
+  vec.push_back( mk_img( 20, 'l' ) );
+
+  condense_images_into( vec, protos );
+
+  ECE2400_CHECK_INT_EQ( protos.size(), 2 );
+  ECE2400_CHECK_TRUE( protos[1] == mk_img( 250, 'h' ) );
+
+  // Condensing nothing does nothing
+
+  ECE2400_CHECK_INT_EQ( condense_images( Vector<Image>() ).size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_7_take_flag
+//------------------------------------------------------------------------
+// The flag is removed wherever it appears, and the other arguments keep
+// their order.
+
+void test_case_7_take_flag()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  char  prog[]  = "eval";
+  char  train[] = "100";
+  char  flag0[] = "--perf-counters";
+  char  test[]  = "10";
+  char  flag1[] = "--perf-counters";
+  char* argv[]  = { prog, train, flag0, test, flag1 };
+  int   argc    = 5;
+
+  ECE2400_CHECK_TRUE( take_flag( argc, argv, "--perf-counters" ) );
+  ECE2400_CHECK_INT_EQ( argc, 3 );
+  ECE2400_CHECK_TRUE( argv[1] == train );
+  ECE2400_CHECK_TRUE( argv[2] == test );
+
+  ECE2400_CHECK_FALSE( take_flag( argc, argv, "--perf-counters" ) );
+  ECE2400_CHECK_INT_EQ( argc, 3 );
+}
+
+//------------------------------------------------------------------------
+// test_case_8_take_option
+//------------------------------------------------------------------------
+// The last value wins, and options that only share a prefix are kept.
+
+void test_case_8_take_option()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  char  prog[]  = "sweep";
+  char  opt0[]  = "--csv=a.csv";
+  char  train[] = "100";
+  char  other[] = "--csvx=b.csv";
+  char  opt1[]  = "--csv=c.csv";
+  char* argv[]  = { prog, opt0, train, other, opt1 };
+  int   argc    = 5;
+
+  ECE2400_CHECK_TRUE( take_option( argc, argv, "--csv" ) == "c.csv" );
+  ECE2400_CHECK_INT_EQ( argc, 3 );
+  ECE2400_CHECK_TRUE( argv[1] == train );
+  ECE2400_CHECK_TRUE( argv[2] == other );
+
+  ECE2400_CHECK_TRUE( take_option( argc, argv, "--csv" ).empty() );
+  ECE2400_CHECK_INT_EQ( argc, 3 );
+}
+
+//------------------------------------------------------------------------
+// test_case_9_classify_quietly
+//------------------------------------------------------------------------
+// Classifying without a progress bar records every query once.
+
+void test_case_9_classify_quietly()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  Vector<Image> train;
+  train.push_back( mk_img( 0, 'l' ) );
+  train.push_back( mk_img( 250, 'h' ) );
+
+  Vector<Image> test;
+  test.push_back( mk_img( 10, 'l' ) );
+  test.push_back( mk_img( 240, 'h' ) );
+  test.push_back( mk_img( 200, 'l' ) );
+  test.push_back( mk_img( 0, 'l' ) );
+
+  HRSLinearSearch clf;
+  clf.train( train );
+
+  Histogram latency_ns;
+  Histogram distances;
+  double accuracy =
+      classify_with_progress_bar( clf, test, &latency_ns, &distances, false );
+  ECE2400_CHECK_TRUE( accuracy == 0.75 );
+  ECE2400_CHECK_INT_EQ( (int) latency_ns.count(), 4 );
+  ECE2400_CHECK_INT_EQ( (int) distances.count(), 4 );
+  ECE2400_CHECK_INT_EQ( (int) distances.max(), 2 );
+
+  ECE2400_CHECK_TRUE( classify_with_progress_bar( clf, Vector<Image>(),
+                                                  nullptr, nullptr,
+                                                  false ) == 0.0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_10_write_read
+//------------------------------------------------------------------------
+// Written images read back unchanged, also after appending more, except
+// that pixels are clamped to a byte.
+
+Image mk_mnist_img( int seed, char label )
+{
+  int data[28 * 28];
+  for ( int i = 0; i < 28 * 28; i++ )
+    data[i] = ( i * 7 + seed * 13 ) % 256;
+  data[0] = 300;
+  Image img( Vector<int>( data, 28 * 28 ), 28, 28 );
+  img.set_label( label );
+  return img;
+}
+
+void test_case_10_write_read()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  const std::string images_path = "mnist-utils-test-images.bin";
+  const std::string labels_path = "mnist-utils-test-labels.bin";
+
+  Vector<Image> first;
+  first.push_back( mk_mnist_img( 0, '0' ) );
+  first.push_back( mk_mnist_img( 1, '9' ) );
+  first.push_back( mk_mnist_img( 2, '4' ) );
+
+  Vector<Image> second;
+  second.push_back( mk_mnist_img( 3, '7' ) );
+  second.push_back( mk_mnist_img( 4, '7' ) );
+
+  write_labeled_images( images_path, labels_path, first );
+  ECE2400_CHECK_INT_EQ( count_labeled_images( images_path ), 3 );
+
+  write_labeled_images( images_path, labels_path, second, true );
+  ECE2400_CHECK_INT_EQ( count_labeled_images( images_path ), 5 );
+
+  Vector<Image> vec;
+  read_labeled_images( images_path, labels_path, vec, 5 );
+  ECE2400_CHECK_INT_EQ( vec.size(), 5 );
+  for ( int i = 0; i < 5; i++ ) {
+    Image expected = ( i < 3 ) ? first[i] : second[i - 3];
+    ECE2400_CHECK_CHAR_EQ( vec[i].get_label(), expected.get_label() );
+    ECE2400_CHECK_INT_EQ( vec[i][0], 255 );
+    bool same = true;
+    for ( int j = 1; j < 28 * 28; j++ )
+      if ( vec[i][j] != expected[j] )
+        same = false;
+    ECE2400_CHECK_TRUE( same );
+  }
+
+  // Labels files are not images files, and missing files have no count
+
+  ECE2400_CHECK_INT_EQ( count_labeled_images( labels_path ), -1 );
+  ECE2400_CHECK_INT_EQ( count_labeled_images( "no-such-file.bin" ), -1 );
+
+  std::remove( images_path.c_str() );
+  std::remove( labels_path.c_str() );
+
+  // Only 28x28 images with digit labels can be written
+
+  bool flag = false;
+  try {
+    Vector<Image> bad;
+    bad.push_back( mk_img( 0, '1' ) );
+    write_labeled_images( images_path, labels_path, bad );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  flag = false;
+  try {
+    Vector<Image> bad;
+    bad.push_back( mk_mnist_img( 0, '?' ) );
+    write_labeled_images( images_path, labels_path, bad );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_11_stream
+//------------------------------------------------------------------------
+// A stream yields the images in order in batches of the given size, and
+// can stop early.
+
+void test_case_11_stream()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  const std::string images_path = "mnist-utils-test-images.bin";
+  const std::string labels_path = "mnist-utils-test-labels.bin";
+
+  Vector<Image> vec;
+  for ( int i = 0; i < 7; i++ )
+    vec.push_back( mk_mnist_img( i, (char) ( '0' + i ) ) );
+  write_labeled_images( images_path, labels_path, vec );
+
+  LabeledImageStream stream( images_path, labels_path );
+  ECE2400_CHECK_INT_EQ( stream.size(), 7 );
+
+  Vector<Image> batch;
+  int           sizes[] = { 3, 3, 1 };
+  int           n       = 0;
+  for ( int b = 0; b < 3; b++ ) {
+    ECE2400_CHECK_TRUE( stream.next_batch( batch, 3 ) );
+    ECE2400_CHECK_INT_EQ( batch.size(), sizes[b] );
+    for ( int i = 0; i < batch.size(); i++ ) {
+      ECE2400_CHECK_CHAR_EQ( batch[i].get_label(), (char) ( '0' + n ) );
+      ECE2400_CHECK_INT_EQ( batch[i][1], vec[n][1] );
+      n++;
+    }
+  }
+  ECE2400_CHECK_FALSE( stream.next_batch( batch, 3 ) );
+  ECE2400_CHECK_INT_EQ( batch.size(), 0 );
+  ECE2400_CHECK_INT_EQ( stream.remaining(), 0 );
+
+  // Only the first size images are read
+
+  LabeledImageStream head( images_path, labels_path, 2 );
+  ECE2400_CHECK_INT_EQ( head.size(), 2 );
+  ECE2400_CHECK_TRUE( head.next_batch( batch, 10 ) );
+  ECE2400_CHECK_INT_EQ( batch.size(), 2 );
+  ECE2400_CHECK_FALSE( head.next_batch( batch, 10 ) );
+
+  // Missing or mismatched files cannot be streamed
+
+  bool flag = false;
+  try {
+    LabeledImageStream bad( labels_path, images_path );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+
+  std::remove( images_path.c_str() );
+  std::remove( labels_path.c_str() );
+
+  flag = false;
+  try {
+    LabeledImageStream bad( images_path, labels_path );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_hash();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_dedup_no_duplicates();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_dedup_majority_label();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_dedup_empty();
+  if ( ( __n == 0 ) || ( __n == 5 ) ) test_case_5_condense();
+  if ( ( __n == 0 ) || ( __n == 6 ) ) test_case_6_condense_into();
+  if ( ( __n == 0 ) || ( __n == 7 ) ) test_case_7_take_flag();
+  if ( ( __n == 0 ) || ( __n == 8 ) ) test_case_8_take_option();
+  if ( ( __n == 0 ) || ( __n == 9 ) ) test_case_9_classify_quietly();
+  if ( ( __n == 0 ) || ( __n == 10 ) ) test_case_10_write_read();
+  if ( ( __n == 0 ) || ( __n == 11 ) ) test_case_11_stream();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
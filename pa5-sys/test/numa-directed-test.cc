@@ -0,0 +1,115 @@
+//========================================================================
+// numa-directed-test.cc
+//========================================================================
+// This file contains directed tests for the NUMA helpers
+
+#include "Numa.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sched.h>
+#include <thread>
+
+//------------------------------------------------------------------------
+// test_case_1_parse_cpu_list
+//------------------------------------------------------------------------
+
+void test_case_1_parse_cpu_list()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::vector<int> cpus = parse_cpu_list( "0-3,8,10-11\n" );
+  ECE2400_CHECK_INT_EQ( (int) cpus.size(), 7 );
+  ECE2400_CHECK_INT_EQ( cpus[0], 0 );
+  ECE2400_CHECK_INT_EQ( cpus[3], 3 );
+  ECE2400_CHECK_INT_EQ( cpus[4], 8 );
+  ECE2400_CHECK_INT_EQ( cpus[6], 11 );
+
+  ECE2400_CHECK_INT_EQ( (int) parse_cpu_list( "" ).size(), 0 );
+  ECE2400_CHECK_INT_EQ( (int) parse_cpu_list( "3-1" ).size(), 0 );
+  ECE2400_CHECK_INT_EQ( (int) parse_cpu_list( "a" ).size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_topology
+//------------------------------------------------------------------------
+// There is at least one node, no CPU is on two nodes, and every worker
+// gets a usable CPU, with neighboring workers on the same node or the
+// next one.
+
+void test_case_2_topology()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::vector<std::vector<int>> nodes = numa_node_cpus();
+  ECE2400_CHECK_TRUE( nodes.size() >= 1 );
+
+  for ( size_t i = 0; i < nodes.size(); i++ ) {
+    ECE2400_CHECK_TRUE( !nodes[i].empty() );
+    for ( size_t j = 0; j < nodes[i].size(); j++ )
+      ECE2400_CHECK_INT_EQ( numa_node_of_cpu( nodes[i][j] ), (int) i );
+  }
+
+  int              nworkers = 9;
+  std::vector<int> cpus     = numa_worker_cpus( nworkers );
+  ECE2400_CHECK_INT_EQ( (int) cpus.size(), nworkers );
+
+  int last_node = 0;
+  for ( int k = 0; k < nworkers; k++ ) {
+    int node = numa_node_of_cpu( cpus[(size_t) k] );
+    ECE2400_CHECK_TRUE( node >= last_node );
+    ECE2400_CHECK_TRUE( node <= last_node + 1 );
+    last_node = node;
+  }
+
+  ECE2400_CHECK_INT_EQ( (int) numa_worker_cpus( 0 ).size(), 0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_pin_thread
+//------------------------------------------------------------------------
+// A pinned thread runs on its CPU, and invalid CPUs are refused.
+
+void pin_and_check( int cpu, bool* pinned, int* ran_on )
+{
+  *pinned = pin_thread( cpu );
+  *ran_on = sched_getcpu();
+}
+
+void test_case_3_pin_thread()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  std::vector<int> cpus = numa_worker_cpus( 1 );
+  ECE2400_CHECK_INT_EQ( (int) cpus.size(), 1 );
+
+  bool        pinned = false;
+  int         ran_on = -1;
+  std::thread t( pin_and_check, cpus[0], &pinned, &ran_on );
+  t.join();
+  ECE2400_CHECK_TRUE( pinned );
+  ECE2400_CHECK_INT_EQ( ran_on, cpus[0] );
+
+  ECE2400_CHECK_FALSE( pin_thread( -1 ) );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_parse_cpu_list();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_topology();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_pin_thread();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
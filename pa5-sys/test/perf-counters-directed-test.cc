@@ -0,0 +1,83 @@
+//========================================================================
+// perf-counters-directed-test.cc
+//========================================================================
+// This file contains directed tests for PerfCounters. Whether hardware
+// counters are permitted depends on the machine, so the tests check for
+// sensible results either way.
+
+#include "PerfCounters.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// test_case_1_closed
+//------------------------------------------------------------------------
+// Counters that were never opened count nothing.
+
+void test_case_1_closed()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  PerfCounters counters;
+  counters.start();
+  counters.stop();
+
+  ECE2400_CHECK_FALSE( counters.available() );
+  for ( int i = 0; i < PerfCounters::NUM_EVENTS; i++ ) {
+    PerfCounters::Event event = (PerfCounters::Event) i;
+    ECE2400_CHECK_TRUE( counters.get( event ) == -1 );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_2_count_loop
+//------------------------------------------------------------------------
+// A loop of a million iterations retires at least a million
+// instructions. If the counters are not permitted, there is an error
+// message instead.
+
+void test_case_2_count_loop()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  PerfCounters counters;
+  bool         available = counters.open();
+  ECE2400_CHECK_TRUE( available == counters.available() );
+
+  if ( !available ) {
+    std::printf( " - %s\n", counters.error().c_str() );
+    ECE2400_CHECK_FALSE( counters.error().empty() );
+    return;
+  }
+
+  volatile int sum = 0;
+  counters.start();
+  for ( int i = 0; i < 1000000; i++ )
+    sum = sum + i;
+  counters.stop();
+
+  long long instructions = counters.get( PerfCounters::INSTRUCTIONS );
+  if ( instructions >= 0 )
+    ECE2400_CHECK_TRUE( instructions >= 1000000 );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_closed();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_count_loop();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
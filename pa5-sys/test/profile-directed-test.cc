@@ -0,0 +1,157 @@
+//========================================================================
+// profile-directed-test.cc
+//========================================================================
+// This file contains directed tests for the timer and profiling
+// functions in ece2400-stdlib
+
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+// test_case_1_monotonic
+//------------------------------------------------------------------------
+// The clock never goes backwards, and the elapsed time is never
+// negative.
+
+void test_case_1_monotonic()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  long long prev = ece2400::timer_now_ns();
+  bool      ok   = true;
+  for ( int i = 0; i < 1000; i++ ) {
+    long long now = ece2400::timer_now_ns();
+    if ( now < prev )
+      ok = false;
+    prev = now;
+  }
+  ECE2400_CHECK_TRUE( ok );
+
+  ece2400::timer_reset();
+  ECE2400_CHECK_TRUE( ece2400::timer_get_elapsed() >= 0.0 );
+}
+
+//------------------------------------------------------------------------
+// test_case_2_nested
+//------------------------------------------------------------------------
+// Regions opened inside another region are recorded as its children,
+// separately from regions with the same name at the top level.
+
+void test_case_2_nested()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ece2400::profile_enable( true );
+  ece2400::profile_reset();
+
+  {
+    ECE2400_PROFILE_SCOPE( "outer" );
+    for ( int i = 0; i < 3; i++ ) {
+      ECE2400_PROFILE_SCOPE( "inner" );
+    }
+  }
+  {
+    ECE2400_PROFILE_SCOPE( "inner" );
+  }
+
+  long long outer_calls = 0;
+  long long outer_ns    = 0;
+  long long inner_calls = 0;
+  long long inner_ns    = 0;
+
+  ECE2400_CHECK_TRUE(
+      ece2400::profile_lookup( "outer", &outer_calls, &outer_ns ) );
+  ECE2400_CHECK_TRUE(
+      ece2400::profile_lookup( "outer/inner", &inner_calls, &inner_ns ) );
+  ECE2400_CHECK_INT_EQ( (int) outer_calls, 1 );
+  ECE2400_CHECK_INT_EQ( (int) inner_calls, 3 );
+  ECE2400_CHECK_TRUE( outer_ns >= inner_ns );
+
+  ECE2400_CHECK_TRUE( ece2400::profile_lookup( "inner", &inner_calls, 0 ) );
+  ECE2400_CHECK_INT_EQ( (int) inner_calls, 1 );
+
+  ECE2400_CHECK_FALSE( ece2400::profile_lookup( "outer/none", 0, 0 ) );
+  ECE2400_CHECK_FALSE( ece2400::profile_lookup( "inner/outer", 0, 0 ) );
+
+  // Resetting forgets everything
+
+  ece2400::profile_reset();
+  ECE2400_CHECK_FALSE( ece2400::profile_lookup( "outer", 0, 0 ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_3_disabled
+//------------------------------------------------------------------------
+// Nothing is recorded while profiling is disabled.
+
+void test_case_3_disabled()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ece2400::profile_enable( false );
+  ece2400::profile_reset();
+
+  {
+    ECE2400_PROFILE_SCOPE( "ignored" );
+  }
+
+  ECE2400_CHECK_FALSE( ece2400::profile_enabled() );
+  ECE2400_CHECK_FALSE( ece2400::profile_lookup( "ignored", 0, 0 ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_4_threads
+//------------------------------------------------------------------------
+// Regions recorded by threads are added up once the threads exit.
+
+void worker()
+{
+  for ( int i = 0; i < 10; i++ ) {
+    ECE2400_PROFILE_SCOPE( "worker" );
+  }
+}
+
+void test_case_4_threads()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  ece2400::profile_enable( true );
+  ece2400::profile_reset();
+
+  std::vector<std::thread> threads;
+  for ( int i = 0; i < 4; i++ )
+    threads.push_back( std::thread( worker ) );
+  for ( size_t i = 0; i < threads.size(); i++ )
+    threads[i].join();
+
+  long long calls = 0;
+  ECE2400_CHECK_TRUE( ece2400::profile_lookup( "worker", &calls, 0 ) );
+  ECE2400_CHECK_INT_EQ( (int) calls, 40 );
+
+  ece2400::profile_enable( false );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( ( __n == 0 ) || ( __n == 1 ) ) test_case_1_monotonic();
+  if ( ( __n == 0 ) || ( __n == 2 ) ) test_case_2_nested();
+  if ( ( __n == 0 ) || ( __n == 3 ) ) test_case_3_disabled();
+  if ( ( __n == 0 ) || ( __n == 4 ) ) test_case_4_threads();
+
+  std::printf( "\n" );
+  return __failed;
+}
+// clang-format on
@@ -706,6 +706,130 @@ void test_case_copy_v2( int test_case_num, Func f, CmpFunc cmp )
   }
 }
 
+//------------------------------------------------------------------------
+// test_case_copy_unbalanced
+//------------------------------------------------------------------------
+// Copies a tree that was built from values added in increasing order,
+// i.e., a tree that is as deep as it is large.
+
+template < typename T, typename Func, typename CmpFunc >
+void test_case_copy_unbalanced( int test_case_num, Func f, CmpFunc cmp )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  int size = 5000;
+
+  Tree<T,CmpFunc> tree0( 42, cmp );
+  for ( int i = 0; i < size; i++ )
+    tree0.add( f(i) );
+
+  // Copy constructor and assignment operator
+
+  Tree<T,CmpFunc> tree1( tree0 );
+  Tree<T,CmpFunc> tree2( 42, cmp );
+  tree2.add( f(size) );
+  tree2 = tree0;
+
+  // Add a different value to each tree
+
+  tree0.add( f(size + 1) );
+  tree1.add( f(size + 2) );
+  tree2.add( f(size + 3) );
+
+  ECE2400_CHECK_INT_EQ( tree1.size(), size + 1 );
+  ECE2400_CHECK_INT_EQ( tree2.size(), size + 1 );
+
+  ECE2400_CHECK_FALSE( tree1.contains( f(size) ) );
+  ECE2400_CHECK_FALSE( tree1.contains( f(size + 1) ) );
+  ECE2400_CHECK_TRUE ( tree1.contains( f(size + 2) ) );
+  ECE2400_CHECK_FALSE( tree2.contains( f(size) ) );
+  ECE2400_CHECK_TRUE ( tree2.contains( f(size + 3) ) );
+
+  // The copies hold the same values in the same order
+
+  Vector<T> vec0 = tree0.to_vector();
+  Vector<T> vec1 = tree1.to_vector();
+  Vector<T> vec2 = tree2.to_vector();
+
+  for ( int i = 0; i < size; i++ ) {
+    ECE2400_CHECK_TRUE( vec0[i] == f(i) );
+    ECE2400_CHECK_TRUE( vec1[i] == f(i) );
+    ECE2400_CHECK_TRUE( vec2[i] == f(i) );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_clear
+//------------------------------------------------------------------------
+// Clears a tree and reuses it.
+
+template < typename T, typename Func, typename CmpFunc >
+void test_case_clear( int test_case_num, Func f, CmpFunc cmp )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  Tree<T,CmpFunc> tree( 42, cmp );
+
+  // Clearing an empty tree does nothing
+
+  tree.clear();
+  ECE2400_CHECK_INT_EQ( tree.size(), 0 );
+
+  for ( int i = 0; i < 100; i++ )
+    tree.add( f(i) );
+
+  tree.clear();
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 0 );
+  ECE2400_CHECK_INT_EQ( tree.to_vector().size(), 0 );
+  ECE2400_CHECK_FALSE( tree.contains( f(0) ) );
+
+  // Add new values after clearing
+
+  for ( int i = 200; i > 100; i-- )
+    tree.add( f(i) );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 100 );
+
+  for ( int i = 0; i <= 100; i++ )
+    ECE2400_CHECK_FALSE( tree.contains( f(i) ) );
+
+  for ( int i = 101; i <= 200; i++ )
+    ECE2400_CHECK_TRUE( tree.contains( f(i) ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_add_sorted
+//------------------------------------------------------------------------
+// Adds values in increasing and then decreasing order. The tree
+// rebalances itself as values are added, so exact matches are found no
+// matter where in the tree they ended up.
+
+template < typename T, typename Func, typename CmpFunc, typename DistFunc >
+void test_case_add_sorted( int test_case_num, Func f, CmpFunc cmp, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  Tree<T,CmpFunc> tree( 4, cmp );
+
+  for ( int i = 1000; i < 2000; i++ )
+    tree.add( f(i) );
+
+  for ( int i = 999; i >= 0; i-- )
+    tree.add( f(i) );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 2000 );
+
+  Vector<T> vec = tree.to_vector();
+  for ( int i = 0; i < 2000; i++ )
+    ECE2400_CHECK_TRUE( vec[i] == f(i) );
+
+  for ( int i = 0; i < 2000; i += 7 ) {
+    ECE2400_CHECK_TRUE( tree.contains( f(i) ) );
+    ECE2400_CHECK_TRUE( tree.find_closest( f(i), dist ) == f(i) );
+  }
+}
+
 //------------------------------------------------------------------------
 // test_case_copy_empty
 //------------------------------------------------------------------------
@@ -76,6 +76,62 @@ class LessIntensity {
   }
 };
 
+//------------------------------------------------------------------------
+// test_case_56_equal_intensity
+//------------------------------------------------------------------------
+// Different images with the same intensity share a key, but they are
+// still different values, so the tree has to keep all of them.
+
+void test_case_56_equal_intensity()
+{
+  std::printf( "\n%s\n", __func__ );
+
+  int data[][9] = {
+      {6, 0, 0, 0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 6, 0, 0, 0, 0},
+      {0, 0, 0, 0, 0, 0, 0, 0, 6}, {2, 2, 2, 0, 0, 0, 0, 0, 0},
+      {1, 0, 0, 0, 0, 0, 0, 0, 0}, {9, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+  Image images[] = {Image( Vector<int>( data[0], 9 ), 3, 3 ),
+                    Image( Vector<int>( data[1], 9 ), 3, 3 ),
+                    Image( Vector<int>( data[2], 9 ), 3, 3 ),
+                    Image( Vector<int>( data[3], 9 ), 3, 3 ),
+                    Image( Vector<int>( data[4], 9 ), 3, 3 ),
+                    Image( Vector<int>( data[5], 9 ), 3, 3 )};
+
+  Tree<Image, bool ( * )( const Image&, const Image& )> tree(
+      1, less_intensity );
+
+  // Add everything twice; only the true duplicates are dropped
+
+  for ( int i = 0; i < 2; i++ )
+    for ( int j = 0; j < 6; j++ )
+      tree.add( images[j] );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 6 );
+
+  for ( int j = 0; j < 6; j++ )
+    ECE2400_CHECK_TRUE( tree.contains( images[j] ) );
+
+  int   other_data[9] = {0, 6, 0, 0, 0, 0, 0, 0, 0};
+  Image other         = Image( Vector<int>( other_data, 9 ), 3, 3 );
+  ECE2400_CHECK_FALSE( tree.contains( other ) );
+
+  // Values with equal keys come out next to each other
+
+  Vector<Image> vec = tree.to_vector();
+  ECE2400_CHECK_INT_EQ( vec.size(), 6 );
+  ECE2400_CHECK_INT_EQ( vec[0].get_intensity(), 1 );
+  for ( int i = 1; i < 5; i++ )
+    ECE2400_CHECK_INT_EQ( vec[i].get_intensity(), 6 );
+  ECE2400_CHECK_INT_EQ( vec[5].get_intensity(), 9 );
+
+  // Every one of them can be found
+
+  for ( int j = 0; j < 6; j++ )
+    ECE2400_CHECK_TRUE( tree.find_closest( images[j], distance_euclidean ) ==
+                        images[j] );
+}
+
 //------------------------------------------------------------------------
 // main
 //------------------------------------------------------------------------
@@ -151,6 +207,10 @@ int main( int argc, char** argv )
   if ( !__n || ( __n == 50 ) ) test_case_two_nodes<Image,ImgFunc,ImgCmp,ImgDist>(50,&mk_1x1,less_intensity,distance_euclidean);
   if ( !__n || ( __n == 51 ) ) test_case_three_nodes<Image,ImgFunc,ImgCmp,ImgDist>(51,&mk_1x1,less_intensity,distance_euclidean);
   if ( !__n || ( __n == 52 ) ) test_case_four_nodes<Image,ImgFunc,ImgCmp,ImgDist>(52,&mk_1x1,less_intensity,distance_euclidean);
+  if ( !__n || ( __n == 53 ) ) test_case_copy_unbalanced<Image,ImgFunc,ImgCmp>(53,&mk_3x3,less_intensity);
+  if ( !__n || ( __n == 54 ) ) test_case_clear<Image,ImgFunc,ImgCmp>(54,&mk_3x3,less_intensity);
+  if ( !__n || ( __n == 55 ) ) test_case_add_sorted<Image,ImgFunc,ImgCmp,ImgDist>(55,&mk_1x1,less_intensity,distance_euclidean);
+  if ( !__n || ( __n == 56 ) ) test_case_56_equal_intensity();
 
   std::printf("\n");
   return __failed;
@@ -83,6 +83,9 @@ int main( int argc, char** argv )
   if ( !__n || ( __n == 23 ) ) test_case_two_nodes<int,IntFunc,IntCmp,IntDist>(23,&mk_int,int_less,int_dist);
   if ( !__n || ( __n == 24 ) ) test_case_three_nodes<int,IntFunc,IntCmp,IntDist>(24,&mk_int,int_less,int_dist);
   if ( !__n || ( __n == 25 ) ) test_case_four_nodes<int,IntFunc,IntCmp,IntDist>(25,&mk_int,int_less,int_dist);
+  if ( !__n || ( __n == 26 ) ) test_case_copy_unbalanced<int,IntFunc,IntCmp>(26,&mk_int,int_less);
+  if ( !__n || ( __n == 27 ) ) test_case_clear<int,IntFunc,IntCmp>(27,&mk_int,int_less);
+  if ( !__n || ( __n == 28 ) ) test_case_add_sorted<int,IntFunc,IntCmp,IntDist>(28,&mk_int,int_less,int_dist);
 
   std::printf("\n");
   return __failed;
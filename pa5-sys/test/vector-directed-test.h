@@ -438,6 +438,43 @@ void test_case_subscript( int test_case_num, Func f )
     ECE2400_CHECK_TRUE( vec[i] == data[i] );
 }
 
+//------------------------------------------------------------------------
+// test_case_reserve
+//------------------------------------------------------------------------
+// A simple test case that tests reserving room before and after pushing
+// back values.
+
+template < typename T, typename Func >
+void test_case_reserve( int test_case_num, Func f )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  Vector<T> vec;
+
+  // Reserving on an empty vector does not change its size
+
+  vec.reserve( 100 );
+  ECE2400_CHECK_INT_EQ( vec.size(), 0 );
+
+  for ( int i = 0; i < 50; i++ )
+    vec.push_back( f(i) );
+
+  // Growing and shrinking the reservation keeps the values
+
+  vec.reserve( 1000 );
+  vec.reserve( 1 );
+
+  ECE2400_CHECK_INT_EQ( vec.size(), 50 );
+
+  for ( int i = 50; i < 1200; i++ )
+    vec.push_back( f(i) );
+
+  ECE2400_CHECK_INT_EQ( vec.size(), 1200 );
+
+  for ( int i = 0; i < 1200; i++ )
+    ECE2400_CHECK_TRUE( vec.at(i) == f(i) );
+}
+
 //------------------------------------------------------------------------
 // test_case_copy_v1
 //------------------------------------------------------------------------
@@ -188,6 +188,7 @@ int main( int argc, char** argv )
   if ( !__n || ( __n == 48 ) ) test_case_assignment_self<Image>(48,&mk_3x3);
   if ( !__n || ( __n == 49 ) ) test_case_general<Image,ImgFunc,ImgDist,ImgCmp>(49,&mk_3x3,4,distance_euclidean,less_intensity);
   if ( !__n || ( __n == 50 ) ) test_case_50_find_closest_different();
+  if ( !__n || ( __n == 51 ) ) test_case_reserve<Image>(51,&mk_3x3);
 
   std::printf("\n");
   return __failed;
@@ -80,6 +80,7 @@ int main( int argc, char** argv )
   if ( !__n || ( __n ==  8 ) ) test_case_construct_random<Image>(8,&mk_3x3);
   if ( !__n || ( __n ==  9 ) ) test_case_find_closest_linear_random<Image,ImgFunc,ImgDist>(9,&mk_3x3,distance_euclidean);
   if ( !__n || ( __n == 10 ) ) test_case_general_random<Image,ImgFunc,ImgDist,ImgCmp>(10,&mk_3x3,4,distance_euclidean,less_intensity);
+  if ( !__n || ( __n == 11 ) ) test_case_parallel_linear_search_random<Image,ImgFunc,ImgDist>(11,&mk_3x3,distance_euclidean);
 
   std::printf("\n");
   return __failed;
@@ -115,6 +115,7 @@ int main( int argc, char** argv )
   if ( !__n || ( __n == 24 ) ) test_case_assignment_empty<int>(24,&mk_int);
   if ( !__n || ( __n == 25 ) ) test_case_assignment_self<int>(25,&mk_int);
   if ( !__n || ( __n == 26 ) ) test_case_general<int,IntFunc,IntDist,IntCmp>(26,&mk_int,4,int_dist,int_less);
+  if ( !__n || ( __n == 27 ) ) test_case_reserve<int>(27,&mk_int);
 
   std::printf("\n");
   return __failed;
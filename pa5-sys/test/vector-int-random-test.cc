@@ -64,6 +64,7 @@ int main( int argc, char** argv )
   if ( !__n || ( __n ==  4 ) ) test_case_find_closest_linear_random<int,IntFunc,IntDist>(4,&mk_int,int_dist);
   if ( !__n || ( __n ==  5 ) ) test_case_find_closest_binary_random<int,IntFunc,IntDist,IntCmp>(5,&mk_int,4,int_dist,int_less);
   if ( !__n || ( __n ==  6 ) ) test_case_general_random<int,IntFunc,IntDist,IntCmp>(6,&mk_int,4,int_dist,int_less);
+  if ( !__n || ( __n ==  7 ) ) test_case_parallel_linear_search_random<int,IntFunc,IntDist>(7,&mk_int,int_dist);
 
   printf("\n");
   return __failed;
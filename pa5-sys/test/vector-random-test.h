@@ -295,3 +295,46 @@ void test_case_general_random( int test_case_num, Func f, int k,
   }
 }
 
+
+//------------------------------------------------------------------------
+// test_case_parallel_linear_search_random
+//------------------------------------------------------------------------
+// A random test case that checks parallel_linear_search against
+// find_closest_linear for different numbers of threads, including more
+// threads than values.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_parallel_linear_search_random( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+  std::srand( 0xdeadbeef );
+
+  for ( int i = 0; i < 20; i++ ) {
+
+    int size = 1 + std::rand() % 300;
+
+    Vector<T> vec;
+    for ( int j = 0; j < size; j++ )
+      vec.push_back( f( std::rand() % 1000 ) );
+
+    for ( int nthreads = 0; nthreads <= 5; nthreads++ ) {
+      for ( int j = 0; j < 10; j++ ) {
+        T value = f( std::rand() % 1000 );
+        ECE2400_CHECK_TRUE( vec.parallel_linear_search( value, dist, nthreads ) ==
+                            vec.find_closest_linear( value, dist ) );
+      }
+    }
+  }
+
+  // Searching an empty vector throws
+
+  bool      flag = false;
+  Vector<T> empty;
+  try {
+    empty.parallel_linear_search( f(0), dist, 4 );
+  }
+  catch ( ece2400::OutOfRange e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
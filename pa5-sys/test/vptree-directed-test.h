@@ -0,0 +1,309 @@
+//========================================================================
+// vptree-directed-tests.h
+//========================================================================
+// This file contains generic directed tests for vantage-point trees. All
+// of the generic test functions are templated by an "object creation"
+// function which should take as a parameter an integer and return a
+// newly created object. For integers, the object creation function can
+// just be the identity function. For images, the object creation
+// function can create a small image and initialize the pixels based on
+// the given integer.
+
+#include "VPTree.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+#include <cmath>
+#include <cstdio>
+
+//------------------------------------------------------------------------
+// test_case_build_simple
+//------------------------------------------------------------------------
+// A simple test case that tests the constructor, build, and contains.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_build_simple( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 1, dist );
+
+  // Check size of empty tree
+  ECE2400_CHECK_INT_EQ( tree.size(), 0 );
+
+  // Build from some values
+  Vector<T> vec;
+  T data[] = { f(10), f(11), f(12) };
+  for ( T v : data )
+    vec.push_back( v );
+
+  tree.build( vec );
+
+  // Check size
+  ECE2400_CHECK_INT_EQ( tree.size(), 3 );
+
+  // Check values
+  for ( int i = 0; i < 3; i++ )
+    ECE2400_CHECK_TRUE( tree.contains( data[i] ) );
+
+  ECE2400_CHECK_FALSE( tree.contains( f(9) ) );
+  ECE2400_CHECK_FALSE( tree.contains( f(13) ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_build_empty
+//------------------------------------------------------------------------
+// A simple test case that tests an empty tree.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_build_empty( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 4, dist );
+  tree.build( Vector<T>() );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 0 );
+
+  for ( int i = 0; i < 10; i++ )
+    ECE2400_CHECK_FALSE( tree.contains( f(i) ) );
+
+  bool flag = false;
+  try {
+    tree.find_closest( f(0) );
+  }
+  catch ( ece2400::OutOfRange e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_invalid_leaf_size
+//------------------------------------------------------------------------
+// Leaf buckets must be able to hold at least one value.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_invalid_leaf_size( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  bool flag = false;
+  try {
+    VPTree<T,DistFunc> tree( 0, dist );
+  }
+  catch ( ece2400::InvalidArgument e ) {
+    flag = true;
+  }
+  ECE2400_CHECK_TRUE( flag );
+}
+
+//------------------------------------------------------------------------
+// test_case_find_closest_leaf_size
+//------------------------------------------------------------------------
+// Builds a tree with 15 values using the given leaf size. Since the
+// search is exact, every query must return the true nearest neighbor no
+// matter how the values are distributed among the leaves.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_find_closest_leaf_size( int test_case_num, Func f, DistFunc dist,
+                                       int leaf_size )
+{
+  std::printf( "\n%d: %s (leaf_size = %d)\n", test_case_num, __func__,
+               leaf_size );
+
+  VPTree<T,DistFunc> tree( leaf_size, dist );
+
+  Vector<T> vec;
+  T data[] = { f(80), f(40), f(120), f(20), f(60), f(100), f(140),
+               f(10), f(30), f(50),  f(70), f(90), f(110), f(130), f(150) };
+  for ( T v : data )
+    vec.push_back( v );
+
+  tree.build( vec );
+  ECE2400_CHECK_INT_EQ( tree.size(), 15 );
+
+  // First find exact matches
+
+  for ( int i = 1; i <= 15; i++ )
+    ECE2400_CHECK_TRUE( tree.find_closest( f(10*i) ) == f(10*i) );
+
+  // Find near matches
+
+  for ( int i = 1; i <= 15; i++ ) {
+    ECE2400_CHECK_TRUE( tree.find_closest( f(10*i-1) ) == f(10*i) );
+    ECE2400_CHECK_TRUE( tree.find_closest( f(10*i+1) ) == f(10*i) );
+    ECE2400_CHECK_TRUE( tree.find_closest( f(10*i+4) ) == f(10*i) );
+  }
+
+  // Find matches outside of the range of the tree
+
+  ECE2400_CHECK_TRUE( tree.find_closest( f(0) )   == f(10)  );
+  ECE2400_CHECK_TRUE( tree.find_closest( f(500) ) == f(150) );
+}
+
+//------------------------------------------------------------------------
+// test_case_duplicates
+//------------------------------------------------------------------------
+// Unlike Tree, a VPTree keeps every value it is built from.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_duplicates( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 1, dist );
+
+  Vector<T> vec;
+  T data[] = { f(1), f(1), f(2), f(2), f(1), f(1), f(2), f(2) };
+  for ( T v : data )
+    vec.push_back( v );
+
+  tree.build( vec );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), 8 );
+  ECE2400_CHECK_INT_EQ( tree.to_vector().size(), 8 );
+  ECE2400_CHECK_TRUE( tree.contains( f(1) ) );
+  ECE2400_CHECK_TRUE( tree.contains( f(2) ) );
+  ECE2400_CHECK_TRUE( tree.find_closest( f(0) ) == f(1) );
+  ECE2400_CHECK_TRUE( tree.find_closest( f(5) ) == f(2) );
+}
+
+//------------------------------------------------------------------------
+// test_case_rebuild
+//------------------------------------------------------------------------
+// Building a tree again replaces all of its values.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_rebuild( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 2, dist );
+
+  Vector<T> vec0;
+  for ( int i = 0; i < 10; i++ )
+    vec0.push_back( f(i) );
+
+  Vector<T> vec1;
+  for ( int i = 100; i < 105; i++ )
+    vec1.push_back( f(i) );
+
+  tree.build( vec0 );
+  ECE2400_CHECK_INT_EQ( tree.size(), 10 );
+
+  tree.build( vec1 );
+  ECE2400_CHECK_INT_EQ( tree.size(), 5 );
+
+  for ( int i = 0; i < 10; i++ )
+    ECE2400_CHECK_FALSE( tree.contains( f(i) ) );
+
+  for ( int i = 100; i < 105; i++ )
+    ECE2400_CHECK_TRUE( tree.contains( f(i) ) );
+
+  ECE2400_CHECK_TRUE( tree.find_closest( f(0) ) == f(100) );
+}
+
+//------------------------------------------------------------------------
+// test_case_to_vector
+//------------------------------------------------------------------------
+// to_vector returns every value, in no particular order.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_to_vector( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 3, dist );
+
+  Vector<T> vec;
+  for ( int i = 0; i < 20; i++ )
+    vec.push_back( f(i*7 % 20) );
+
+  tree.build( vec );
+
+  Vector<T> out = tree.to_vector();
+  ECE2400_CHECK_INT_EQ( out.size(), 20 );
+
+  for ( int i = 0; i < 20; i++ )
+    ECE2400_CHECK_TRUE( out.contains( f(i) ) );
+}
+
+//------------------------------------------------------------------------
+// test_case_copy
+//------------------------------------------------------------------------
+// Tests that the copy constructor and assignment operator make deep
+// copies.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_copy( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree0( 2, dist );
+
+  Vector<T> vec;
+  for ( int i = 0; i < 10; i++ )
+    vec.push_back( f(10*i) );
+
+  tree0.build( vec );
+
+  // Copy constructor
+
+  VPTree<T,DistFunc> tree1( tree0 );
+
+  // Assignment operator
+
+  VPTree<T,DistFunc> tree2( 5, dist );
+  tree2 = tree0;
+
+  // Self assignment
+
+  tree2 = tree2;
+
+  // Rebuild the original tree
+
+  tree0.build( Vector<T>() );
+  ECE2400_CHECK_INT_EQ( tree0.size(), 0 );
+
+  // Check that the copies still have the values
+
+  ECE2400_CHECK_INT_EQ( tree1.size(), 10 );
+  ECE2400_CHECK_INT_EQ( tree2.size(), 10 );
+
+  for ( int i = 0; i < 10; i++ ) {
+    ECE2400_CHECK_TRUE( tree1.contains( f(10*i) ) );
+    ECE2400_CHECK_TRUE( tree2.contains( f(10*i) ) );
+    ECE2400_CHECK_TRUE( tree1.find_closest( f(10*i+2) ) == f(10*i) );
+    ECE2400_CHECK_TRUE( tree2.find_closest( f(10*i+2) ) == f(10*i) );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_add_sorted
+//------------------------------------------------------------------------
+// Adding values in sorted order keeps landing in the same leaf. The tree
+// still has to stay logarithmically deep and exact.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_add_sorted( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+
+  VPTree<T,DistFunc> tree( 2, dist );
+
+  const int size = 2000;
+  for ( int i = 0; i < size; i++ )
+    tree.add( f(i) );
+
+  ECE2400_CHECK_INT_EQ( tree.size(), size );
+
+  int max_depth = (int) ( std::log( (double) size ) / std::log( 4.0 / 3.0 ) );
+  ECE2400_CHECK_TRUE( tree.depth() <= max_depth );
+
+  for ( int i = 0; i < size; i += 97 ) {
+    ECE2400_CHECK_TRUE( tree.contains( f(i) ) );
+    ECE2400_CHECK_TRUE( tree.find_closest( f(i) ) == f(i) );
+  }
+  ECE2400_CHECK_TRUE( tree.find_closest( f(size + 5) ) == f(size - 1) );
+  ECE2400_CHECK_INT_EQ( tree.to_vector().size(), size );
+}
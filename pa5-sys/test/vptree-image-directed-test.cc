@@ -0,0 +1,103 @@
+//========================================================================
+// vptree-image-directed-test.cc
+//========================================================================
+// This file contains directed tests for VPTree<Image>
+
+#include "Image.h"
+#include "VPTree.h"
+#include "vptree-directed-test.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// Object Creation Functions
+//------------------------------------------------------------------------
+// All of the generic test functions are templated by an "object
+// creation" function which should take as a parameter an integer and
+// return a newly created object. For an Image, the object creation
+// function can set each pixel value based on the given integer.
+
+Image mk_1x1( int value )
+{
+  int         data[] = {value};
+  Vector<int> vec( data, 1 );
+  return Image( vec, 1, 1 );
+}
+
+Image mk_3x3( int value )
+{
+  int data[] = {value + 2, value + 1, value + 2, value + 1, value,
+                value + 1, value + 2, value + 1, value + 2};
+
+  Vector<int> vec( data, 9 );
+  return Image( vec, 3, 3 );
+}
+
+//------------------------------------------------------------------------
+// Image distance free function
+//------------------------------------------------------------------------
+// Image::distance is the squared euclidean distance, which is not a
+// metric, so the tree needs its square root.
+
+double distance_euclidean( const Image& a, const Image& b )
+{
+  return std::sqrt( (double) a.distance( b ) );
+}
+
+//------------------------------------------------------------------------
+// Image distance functor
+//------------------------------------------------------------------------
+class DistanceEuclidean {
+ public:
+  double operator()( const Image& a, const Image& b ) const
+  {
+    return std::sqrt( (double) a.distance( b ) );
+  }
+};
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  typedef Image (ImgFunc)(int);
+  typedef double (*ImgDist)( const Image&, const Image& );
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  std::printf("\n Testing with 1x1 images \n");
+
+  if ( !__n || ( __n ==  1 ) ) test_case_build_simple<Image,ImgFunc,ImgDist>(1,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  2 ) ) test_case_build_empty<Image,ImgFunc,ImgDist>(2,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  3 ) ) test_case_invalid_leaf_size<Image,ImgFunc,ImgDist>(3,&mk_1x1,distance_euclidean);
+  // two different ways to pass in the callables: free funtion and functor
+  if ( !__n || ( __n ==  4 ) ) test_case_find_closest_leaf_size<Image,ImgFunc,ImgDist>(4,&mk_1x1,distance_euclidean,1);
+  if ( !__n || ( __n ==  5 ) ) test_case_find_closest_leaf_size<Image,ImgFunc,DistanceEuclidean>(5,&mk_1x1,DistanceEuclidean(),4);
+  if ( !__n || ( __n ==  6 ) ) test_case_duplicates<Image,ImgFunc,ImgDist>(6,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  7 ) ) test_case_rebuild<Image,ImgFunc,ImgDist>(7,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  8 ) ) test_case_to_vector<Image,ImgFunc,ImgDist>(8,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  9 ) ) test_case_copy<Image,ImgFunc,ImgDist>(9,&mk_1x1,distance_euclidean);
+
+  std::printf("\n\n Testing with 3x3 images \n");
+
+  if ( !__n || ( __n == 10 ) ) test_case_build_simple<Image,ImgFunc,ImgDist>(10,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 11 ) ) test_case_build_empty<Image,ImgFunc,ImgDist>(11,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 12 ) ) test_case_find_closest_leaf_size<Image,ImgFunc,ImgDist>(12,&mk_3x3,distance_euclidean,1);
+  if ( !__n || ( __n == 13 ) ) test_case_find_closest_leaf_size<Image,ImgFunc,ImgDist>(13,&mk_3x3,distance_euclidean,2);
+  if ( !__n || ( __n == 14 ) ) test_case_find_closest_leaf_size<Image,ImgFunc,ImgDist>(14,&mk_3x3,distance_euclidean,64);
+  if ( !__n || ( __n == 15 ) ) test_case_duplicates<Image,ImgFunc,ImgDist>(15,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 16 ) ) test_case_rebuild<Image,ImgFunc,ImgDist>(16,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 17 ) ) test_case_to_vector<Image,ImgFunc,ImgDist>(17,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 18 ) ) test_case_copy<Image,ImgFunc,ImgDist>(18,&mk_3x3,distance_euclidean);
+  if ( !__n || ( __n == 19 ) ) test_case_add_sorted<Image,ImgFunc,ImgDist>(19,&mk_3x3,distance_euclidean);
+
+  std::printf("\n");
+  return __failed;
+}
+// clang-format on
@@ -0,0 +1,82 @@
+//========================================================================
+// vptree-image-random-test.cc
+//========================================================================
+// This file contains random tests for VPTree<Image>
+
+#include "Image.h"
+#include "VPTree.h"
+#include "vptree-random-test.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// Object Creation Functions
+//------------------------------------------------------------------------
+// All of the generic test functions are templated by an "object
+// creation" function which should take as a parameter an integer and
+// return a newly created object. For an Image, the object creation
+// function can set each pixel value based on the given integer.
+
+Image mk_1x1( int value )
+{
+  int         data[] = {value};
+  Vector<int> vec( data, 1 );
+  return Image( vec, 1, 1 );
+}
+
+// Scatters the given integer over 16 pixels with a small linear
+// congruential generator so that the images are spread out in all
+// dimensions rather than along a single line.
+
+Image mk_4x4( int value )
+{
+  int      data[16];
+  unsigned state = (unsigned) value;
+  for ( int i = 0; i < 16; i++ ) {
+    state   = state * 1103515245u + 12345u;
+    data[i] = (int) ( ( state >> 16 ) & 0xff );
+  }
+
+  Vector<int> vec( data, 16 );
+  return Image( vec, 4, 4 );
+}
+
+//------------------------------------------------------------------------
+// Image distance free function
+//------------------------------------------------------------------------
+double distance_euclidean( const Image& a, const Image& b )
+{
+  return std::sqrt( (double) a.distance( b ) );
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  typedef Image (ImgFunc)(int);
+  typedef double (*ImgDist)( const Image&, const Image& );
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  std::printf("\n Testing with 1x1 images \n");
+
+  if ( !__n || ( __n ==  1 ) ) test_case_find_closest_random<Image,ImgFunc,ImgDist>(1,&mk_1x1,distance_euclidean);
+  if ( !__n || ( __n ==  2 ) ) test_case_copy_random<Image,ImgFunc,ImgDist>(2,&mk_1x1,distance_euclidean);
+
+  std::printf("\n Testing with 4x4 images \n");
+
+  if ( !__n || ( __n ==  3 ) ) test_case_find_closest_random<Image,ImgFunc,ImgDist>(3,&mk_4x4,distance_euclidean);
+  if ( !__n || ( __n ==  4 ) ) test_case_copy_random<Image,ImgFunc,ImgDist>(4,&mk_4x4,distance_euclidean);
+  if ( !__n || ( __n ==  5 ) ) test_case_add_random<Image,ImgFunc,ImgDist>(5,&mk_4x4,distance_euclidean);
+
+  std::printf("\n");
+  return __failed;
+}
+// clang-format on
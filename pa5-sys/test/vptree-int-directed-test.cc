@@ -0,0 +1,68 @@
+//========================================================================
+// vptree-int-directed-test.cc
+//========================================================================
+// This file contains directed tests for VPTree<int>
+
+#include "VPTree.h"
+#include "vptree-directed-test.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// Object Creation Function
+//------------------------------------------------------------------------
+// All of the generic test functions are templated by an "object
+// creation" function which should take as a parameter an integer and
+// return a newly created object. For integers, the object creation
+// function can just be the identity function.
+
+int mk_int( int x )
+{
+  return x;
+}
+
+//------------------------------------------------------------------------
+// Distance free function
+//------------------------------------------------------------------------
+int int_dist( int a, int b )
+{
+  if ( a < b ) {
+    return b - a;
+  }
+  else {
+    return a - b;
+  }
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  typedef int (IntFunc)(int);
+  typedef int (*IntDist)( int, int );
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( !__n || ( __n ==  1 ) ) test_case_build_simple<int,IntFunc,IntDist>(1,&mk_int,int_dist);
+  if ( !__n || ( __n ==  2 ) ) test_case_build_empty<int,IntFunc,IntDist>(2,&mk_int,int_dist);
+  if ( !__n || ( __n ==  3 ) ) test_case_invalid_leaf_size<int,IntFunc,IntDist>(3,&mk_int,int_dist);
+  if ( !__n || ( __n ==  4 ) ) test_case_find_closest_leaf_size<int,IntFunc,IntDist>(4,&mk_int,int_dist,1);
+  if ( !__n || ( __n ==  5 ) ) test_case_find_closest_leaf_size<int,IntFunc,IntDist>(5,&mk_int,int_dist,2);
+  if ( !__n || ( __n ==  6 ) ) test_case_find_closest_leaf_size<int,IntFunc,IntDist>(6,&mk_int,int_dist,4);
+  if ( !__n || ( __n ==  7 ) ) test_case_find_closest_leaf_size<int,IntFunc,IntDist>(7,&mk_int,int_dist,64);
+  if ( !__n || ( __n ==  8 ) ) test_case_duplicates<int,IntFunc,IntDist>(8,&mk_int,int_dist);
+  if ( !__n || ( __n ==  9 ) ) test_case_rebuild<int,IntFunc,IntDist>(9,&mk_int,int_dist);
+  if ( !__n || ( __n == 10 ) ) test_case_to_vector<int,IntFunc,IntDist>(10,&mk_int,int_dist);
+  if ( !__n || ( __n == 11 ) ) test_case_copy<int,IntFunc,IntDist>(11,&mk_int,int_dist);
+  if ( !__n || ( __n == 12 ) ) test_case_add_sorted<int,IntFunc,IntDist>(12,&mk_int,int_dist);
+
+  std::printf("\n");
+  return __failed;
+}
+// clang-format on
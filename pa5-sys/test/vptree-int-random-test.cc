@@ -0,0 +1,59 @@
+//========================================================================
+// vptree-int-random-test.cc
+//========================================================================
+// This file contains random tests for VPTree<int>
+
+#include "VPTree.h"
+#include "vptree-random-test.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// Object Creation Function
+//------------------------------------------------------------------------
+// All of the generic test functions are templated by an "object
+// creation" function which should take as a parameter an integer and
+// return a newly created object. For integers, the object creation
+// function can just be the identity function.
+
+int mk_int( int x )
+{
+  return x;
+}
+
+//------------------------------------------------------------------------
+// Distance free function
+//------------------------------------------------------------------------
+int int_dist( int a, int b )
+{
+  if ( a < b ) {
+    return b - a;
+  }
+  else {
+    return a - b;
+  }
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+
+// clang-format off
+int main( int argc, char** argv )
+{
+  using namespace ece2400;
+
+  typedef int (IntFunc)(int);
+  typedef int (*IntDist)( int, int );
+
+  __n = ( argc == 1 ) ? 0 : std::atoi( argv[1] );
+
+  if ( !__n || ( __n ==  1 ) ) test_case_find_closest_random<int,IntFunc,IntDist>(1,&mk_int,int_dist);
+  if ( !__n || ( __n ==  2 ) ) test_case_copy_random<int,IntFunc,IntDist>(2,&mk_int,int_dist);
+  if ( !__n || ( __n ==  3 ) ) test_case_add_random<int,IntFunc,IntDist>(3,&mk_int,int_dist);
+
+  std::printf("\n");
+  return __failed;
+}
+// clang-format on
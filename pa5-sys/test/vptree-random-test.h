@@ -0,0 +1,174 @@
+//========================================================================
+// vptree-random-test.h
+//========================================================================
+// This file contains generic random tests for vantage-point trees. All
+// of the generic test functions are templated by an "object creation"
+// function which should take as a parameter an integer and return a
+// newly created object. For integers, the object creation function can
+// just be the identity function. For images, the object creation
+// function can create a small image and initialize the pixels based on
+// the given integer.
+
+#include "VPTree.h"
+#include "Vector.h"
+#include "ece2400-stdlib.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------
+// find_closest_ref
+//------------------------------------------------------------------------
+// Reference exhaustive search. We cannot use Vector::find_closest_linear
+// here since it truncates distances to integers.
+
+template < typename T, typename DistFunc >
+T find_closest_ref( const Vector<T>& vec, const T& value, DistFunc dist )
+{
+  int sdidx = 0;
+  for ( int i = 1; i < vec.size(); i++ ) {
+    if ( dist( value, vec[i] ) < dist( value, vec[sdidx] ) )
+      sdidx = i;
+  }
+  return vec[sdidx];
+}
+
+//------------------------------------------------------------------------
+// test_case_find_closest_random
+//------------------------------------------------------------------------
+// A random test case that checks find_closest against an exhaustive
+// linear search. Ties may be broken differently, so we compare the
+// distance to the returned value rather than the value itself.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_find_closest_random( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+  std::srand( 0xdeadbeef );
+
+  for ( int i = 0; i < 50; i++ ) {
+
+    int leaf_size = 1 + std::rand() % 8;
+    int size      = 1 + std::rand() % 200;
+
+    ECE2400_DEBUG( "size = %d, leaf_size = %d\n", size, leaf_size );
+
+    Vector<T> vec;
+    for ( int j = 0; j < size; j++ )
+      vec.push_back( f( std::rand() % 1000 ) );
+
+    VPTree<T,DistFunc> tree( leaf_size, dist );
+    tree.build( vec );
+
+    ECE2400_CHECK_INT_EQ( tree.size(), size );
+
+    for ( int j = 0; j < 20; j++ ) {
+      T value = f( std::rand() % 1000 );
+      T ref   = find_closest_ref( vec, value, dist );
+      T dut   = tree.find_closest( value );
+      ECE2400_CHECK_TRUE( dist( value, dut ) == dist( value, ref ) );
+    }
+
+    // Every value is still in the tree
+
+    for ( int j = 0; j < size; j++ )
+      ECE2400_CHECK_TRUE( tree.contains( vec[j] ) );
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_copy_random
+//------------------------------------------------------------------------
+// A random test case that tests copy constructor and assignment operator.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_copy_random( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+  std::srand( 0xdeadbeef );
+
+  for ( int i = 0; i < 50; i++ ) {
+
+    int size = std::rand() % 100;
+
+    Vector<T> vec;
+    for ( int j = 0; j < size; j++ )
+      vec.push_back( f( std::rand() % 1000 ) );
+
+    VPTree<T,DistFunc> tree0( 4, dist );
+    tree0.build( vec );
+
+    // Copy constructor and assignment operator
+
+    VPTree<T,DistFunc> tree1( tree0 );
+    VPTree<T,DistFunc> tree2( 1, dist );
+    tree2 = tree1;
+
+    // Throw away the original values
+
+    tree0.build( Vector<T>() );
+
+    ECE2400_CHECK_INT_EQ( tree1.size(), size );
+    ECE2400_CHECK_INT_EQ( tree2.size(), size );
+
+    for ( int j = 0; j < size; j++ ) {
+      ECE2400_CHECK_TRUE( tree1.contains( vec[j] ) );
+      ECE2400_CHECK_TRUE( tree2.contains( vec[j] ) );
+    }
+
+    if ( size > 0 ) {
+      T value = f( std::rand() % 1000 );
+      T ref   = find_closest_ref( vec, value, dist );
+      ECE2400_CHECK_TRUE( dist( value, tree2.find_closest( value ) ) ==
+                          dist( value, ref ) );
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// test_case_add_random
+//------------------------------------------------------------------------
+// A random test case that builds a tree from part of the values and adds
+// the rest one at a time. find_closest must stay exact after every
+// batch, including for trees that start out empty.
+
+template < typename T, typename Func, typename DistFunc >
+void test_case_add_random( int test_case_num, Func f, DistFunc dist )
+{
+  std::printf( "\n%d: %s\n", test_case_num, __func__ );
+  std::srand( 0xdeadbeef );
+
+  for ( int i = 0; i < 50; i++ ) {
+
+    int leaf_size = 1 + std::rand() % 8;
+    int size      = std::rand() % 100;
+
+    Vector<T> vec;
+    for ( int j = 0; j < size; j++ )
+      vec.push_back( f( std::rand() % 1000 ) );
+
+    VPTree<T,DistFunc> tree( leaf_size, dist );
+    tree.build( vec );
+
+    for ( int batch = 0; batch < 4; batch++ ) {
+
+      for ( int j = 0; j < 25; j++ ) {
+        T value = f( std::rand() % 1000 );
+        vec.push_back( value );
+        tree.add( value );
+      }
+
+      ECE2400_CHECK_INT_EQ( tree.size(), vec.size() );
+
+      for ( int j = 0; j < 10; j++ ) {
+        T value = f( std::rand() % 1000 );
+        T ref   = find_closest_ref( vec, value, dist );
+        T dut   = tree.find_closest( value );
+        ECE2400_CHECK_TRUE( dist( value, dut ) == dist( value, ref ) );
+      }
+    }
+
+    for ( int j = 0; j < vec.size(); j++ )
+      ECE2400_CHECK_TRUE( tree.contains( vec[j] ) );
+  }
+}